@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------
+// Additive oscillator benchmark: partials per microsecond
+//
+// Kernel: renderAdditive () alone at 8 to 256 partials, on 32-sample
+// segments (the realtime sub-block) and 256-sample segments (offline), at
+// a low note so nothing is culled. Reports partial-samples per µs and ns
+// per output sample.
+//
+// Processor: 8 held notes in Additive mode, realtime profile, ns per
+// voice-sample against the classic saw, and the same 256-partial patch
+// played from C5 up, where culling above Nyquist drops most partials.
+//
+//   winesynth_additive_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "additive.h"
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kPartialCounts[] = {8, 16, 64, 128, 256};
+
+void benchKernel (int32 partials, int32 segment, double seconds)
+{
+    static AdditiveState state;
+    state.reset ();
+    const AdditiveProfile profile = AdditiveProfile::make (partials, 1.0, 1.0);
+    const double inc = 30.0 / kSampleRate;      // 256 partials stay below Nyquist
+
+    alignas (32) float out[256];
+    const int64 segments = std::max<int64> (1, (int64)(seconds * kSampleRate / segment));
+
+    const auto start = Clock::now ();
+    for (int64 i = 0; i < segments; i++)
+    {
+        renderAdditive (state, profile, AdditiveState::kMaxPartials, inc, inc, out, segment);
+        sink = out[i & (segment - 1)];
+    }
+    const double us = secondsSince (start) * 1e6;
+    const double samples = (double)(segments * segment);
+
+    printf ("  %3d partials  %3d-sample segments  %7.0f partials/us  %7.1f ns/sample\n", partials, segment,
+            partials * samples / us, us * 1e3 / samples);
+}
+
+double benchProcessor (bool additive, int32 partials, int16 lowestPitch, double seconds)
+{
+    constexpr int32 kNotes = 8;
+    OfflineHost host (kSampleRate, 128, kRealtime);
+    host.setParam (kWaveformId, plainStep (kWaveformId, kWaveSaw));
+    host.setParam (kOscModeId, plainStep (kOscModeId, additive ? kOscModeAdditive : kOscModeClassic));
+    host.setParam (kPartialsId, plainStep (kPartialsId, partials));
+    for (int32 i = 0; i < kNotes; i++)
+        host.noteOn (0, (int16)(lowestPitch + 3 * i));
+    host.render (4096, nullptr, nullptr);
+
+    const int64 frames = (int64)(seconds * kSampleRate);
+    const auto start = Clock::now ();
+    host.render (frames, nullptr, nullptr);
+    return secondsSince (start) / (double)(frames * kNotes) * 1e9;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.2) : 4.0;
+
+    printf ("renderAdditive\n");
+    for (int32 segment : {32, 256})
+        for (int32 partials : kPartialCounts)
+            benchKernel (partials, segment, seconds);
+
+    printf ("\nprocess (), 8 voices, realtime profile, ns per voice-sample\n");
+    printf ("  %-32s %7.1f\n", "classic saw", benchProcessor (false, 0, 36, seconds));
+    for (int32 partials : kPartialCounts)
+    {
+        char name[32];
+        snprintf (name, sizeof (name), "additive, %d partials", partials);
+        printf ("  %-32s %7.1f\n", name, benchProcessor (true, partials, 36, seconds));
+    }
+    printf ("  %-32s %7.1f\n", "additive, 256 from C5 (culled)", benchProcessor (true, 256, 72, seconds));
+    return 0;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "fft.h"
+#include "params.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace WineSynth {
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince (Clock::time_point start)
+{
+    return std::chrono::duration<double> (Clock::now () - start).count ();
+}
+
+// Kernel benchmarks store a sample of their output here, so the compiler
+// cannot drop the work
+inline volatile float sink = 0.f;
+
+// Normalized value of an integer or list parameter's plain value
+inline double plainStep (Steinberg::Vst::ParamID id, int32_t plain)
+{
+    const ParamDesc& p = kParamTable[id];
+    return fromIndex (p, plain - (int32_t)p.minPlain);
+}
+
+//------------------------------------------------------------------------
+// Timings — collects one duration per block (or per run) and reports
+// order statistics
+//------------------------------------------------------------------------
+class Timings
+{
+public:
+    void reserve (size_t n) { samples.reserve (n); }
+    void add (double seconds) { samples.push_back (seconds); sorted = false; }
+    size_t size () const { return samples.size (); }
+
+    double percentile (double p)
+    {
+        if (samples.empty ())
+            return 0.0;
+        sort ();
+        const size_t i = std::min (samples.size () - 1, (size_t)(p / 100.0 * (double)samples.size ()));
+        return samples[i];
+    }
+
+    double median () { return percentile (50.0); }
+    double max () { return percentile (100.0); }
+
+    double mean () const
+    {
+        double sum = 0.0;
+        for (double s : samples)
+            sum += s;
+        return samples.empty () ? 0.0 : sum / (double)samples.size ();
+    }
+
+private:
+    void sort ()
+    {
+        if (!sorted)
+            std::sort (samples.begin (), samples.end ());
+        sorted = true;
+    }
+
+    std::vector<double> samples;
+    bool sorted = true;
+};
+
+// Small deterministic generator, so every run plays the same notes
+class Random
+{
+public:
+    explicit Random (uint32_t seed = 1) : state (seed) {}
+
+    uint32_t next ()
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    // Uniform in [lo, hi]
+    int32_t range (int32_t lo, int32_t hi) { return lo + (int32_t)(next () % (uint32_t)(hi - lo + 1)); }
+
+private:
+    uint32_t state;
+};
+
+//------------------------------------------------------------------------
+// Energy away from the harmonics of f0 relative to the energy on them, in
+// dB, from one Blackman-Harris windowed FFT over the first power-of-two
+// frames of signal. Aliases of a periodic tone land between its
+// harmonics, so this rises with aliasing. Bins below 20 Hz are ignored.
+//------------------------------------------------------------------------
+inline double inharmonicDb (const std::vector<float>& signal, double sampleRate, double f0)
+{
+    int32_t n = 1;
+    while (2 * n <= (int32_t)signal.size () && 2 * n <= 65536)
+        n *= 2;
+
+    std::vector<float> windowed (n);
+    for (int32_t i = 0; i < n; i++)
+    {
+        const double x = 2.0 * M_PI * i / n;
+        const double w = 0.35875 - 0.48829 * cos (x) + 0.14128 * cos (2.0 * x) - 0.01168 * cos (3.0 * x);
+        windowed[i] = (float)(w * signal[i]);
+    }
+
+    RealFft fft;
+    fft.init (n);
+    std::vector<RealFft::Complex> spectrum (n / 2 + 1);
+    fft.forward (windowed.data (), spectrum.data ());
+
+    const double binHz = sampleRate / n;
+    const double halfWidth = 6.0;      // bins each side of a harmonic (window main lobe)
+    double harmonic = 0.0, other = 0.0;
+    for (int32_t k = (int32_t)(20.0 / binHz) + 1; k <= n / 2; k++)
+    {
+        const double f = k * binHz;
+        const double nearest = std::max (1.0, std::round (f / f0)) * f0;
+        const double power = std::norm (spectrum[k]);
+        if (std::fabs (f - nearest) <= halfWidth * binHz)
+            harmonic += power;
+        else
+            other += power;
+    }
+    return 10.0 * log10 ((other + 1e-30) / (harmonic + 1e-30));
+}
+
+} // namespace Bench
+} // namespace WineSynth
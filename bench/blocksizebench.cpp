@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------
+// Host block size benchmark
+//
+// The engine renders in fixed sub-blocks whatever the host block size,
+// so the cost per sample should be flat from 16 to 4096-sample host
+// blocks. Renders the same held chord at each size, with and without
+// unison and the effects bus, and reports ns per output sample (best of
+// several runs) and the 99th percentile block time per sample.
+//
+//   winesynth_blocksize_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int kRuns = 3;
+constexpr int16 kChord[] = {48, 52, 55, 60, 64, 67, 71, 72};
+
+struct Patch
+{
+    const char* name;
+    bool rich;      // unison 4, drive, chorus, delay
+};
+
+struct Result
+{
+    double nsPerSample;
+    double p99PerSample;
+};
+
+Result run (const Patch& patch, int32 blockSize, double seconds)
+{
+    Result best {1e30, 1e30};
+    for (int r = 0; r < kRuns; r++)
+    {
+        OfflineHost host (kSampleRate, blockSize, kRealtime);
+        host.setParam (kWaveformId, plainStep (kWaveformId, kWaveSaw));
+        host.setParam (kCutoffId, 0.6);
+        if (patch.rich)
+        {
+            host.setParam (kUnisonVoicesId, plainStep (kUnisonVoicesId, 4));
+            host.setParam (kUnisonDetuneId, 0.3);
+            host.setParam (kDriveId, 0.25);
+            host.setParam (kChorusMixId, 0.5);
+            host.setParam (kDelayMixId, 0.3);
+        }
+        for (int16 pitch : kChord)
+            host.noteOn (0, pitch);
+        host.render (4096, nullptr, nullptr);       // past the attack
+
+        const int64 numBlocks = std::max<int64> (1, (int64)(seconds * kSampleRate) / blockSize);
+        Timings timings;
+        timings.reserve ((size_t)numBlocks);
+        const auto start = Clock::now ();
+        for (int64 b = 0; b < numBlocks; b++)
+        {
+            const auto blockStart = Clock::now ();
+            host.render (blockSize, nullptr, nullptr);
+            timings.add (secondsSince (blockStart));
+        }
+        const double total = secondsSince (start);
+
+        best.nsPerSample = std::min (best.nsPerSample, total / (double)(numBlocks * blockSize) * 1e9);
+        best.p99PerSample = std::min (best.p99PerSample, timings.percentile (99.0) / blockSize * 1e9);
+    }
+    return best;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.1) : 4.0;
+    const Patch patches[] = {{"8 voices", false}, {"8 voices, unison 4 + fx", true}};
+
+    printf ("ns per sample (best of %d), realtime profile, %.0f Hz\n\n", kRuns, kSampleRate);
+    printf ("%6s", "block");
+    for (const Patch& p : patches)
+        printf ("  %28s", p.name);
+    printf ("\n%6s", "");
+    for (size_t i = 0; i < sizeof (patches) / sizeof (patches[0]); i++)
+        printf ("  %13s %14s", "mean", "p99 block");
+    printf ("\n");
+
+    for (int32 blockSize : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096})
+    {
+        printf ("%6d", blockSize);
+        for (const Patch& p : patches)
+        {
+            const Result r = run (p, blockSize, seconds);
+            printf ("  %13.1f %14.1f", r.nsPerSample, r.p99PerSample);
+        }
+        printf ("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------
+// Headless GUI draw benchmark (Linux, VSTGUI Cairo backend)
+//
+// Builds each custom control of controls.h on its own, without a frame
+// or editor, and draws it repeatedly into a COffscreenContext of the
+// view's size at several sizes and scale factors. Reports µs per draw
+// (median and 95th percentile). A draw includes beginDraw () and
+// endDraw (), which flushes the Cairo surface, so lazily batched work
+// is counted.
+//
+//   winesynth_gui_bench [draws per case]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "controls.h"
+
+#include "vstgui/lib/vstguiinit.h"
+
+#include <dlfcn.h>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+
+namespace {
+
+constexpr int kWarmupDraws = 20;
+constexpr double kScaleFactors[] = {1.0, 1.5, 2.0};
+
+struct ViewCase
+{
+    const char* name;
+    CPoint size;
+    std::function<SharedPointer<CView> (const CRect&)> make;
+    std::function<void (CView*, int)> step;     // changes state between draws, may be empty
+};
+
+void run (const ViewCase& c, double scale, int draws)
+{
+    const CRect bounds (0, 0, c.size.x, c.size.y);
+    SharedPointer<CView> view = c.make (bounds);
+    auto context = COffscreenContext::create (c.size, scale);
+    if (!view || !context)
+    {
+        printf ("%-22s %4.0fx%-4.0f %.1fx  no offscreen context\n", c.name, c.size.x, c.size.y, scale);
+        return;
+    }
+
+    Timings timings;
+    timings.reserve ((size_t)draws);
+    for (int i = -kWarmupDraws; i < draws; i++)
+    {
+        if (c.step)
+            c.step (view, i);
+        const auto start = Clock::now ();
+        context->beginDraw ();
+        view->draw (context);
+        context->endDraw ();
+        if (i >= 0)
+            timings.add (secondsSince (start));
+    }
+
+    printf ("%-22s %4.0fx%-4.0f %.1fx  %8.1f us  p95 %8.1f us\n", c.name, c.size.x, c.size.y, scale,
+            timings.median () * 1e6, timings.percentile (95.0) * 1e6);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const int draws = argc > 1 ? std::max (atoi (argv[1]), 1) : 500;
+
+    // The Linux factory locates resources through the module handle; the
+    // controls draw only vectors and their own offscreen bitmaps
+    VSTGUI::init (dlopen (nullptr, RTLD_LAZY));
+
+    const auto knob = [] (const CRect& r) -> SharedPointer<CView> {
+        return makeOwned<SynthKnobView> (r, nullptr, 0, 0.3f);
+    };
+    const auto turnKnob = [] (CView* v, int i) {
+        static_cast<CControl*> (v)->setValue ((float)((i + kWarmupDraws) % 100) / 99.f);
+    };
+    const auto waveButton = [] (const CRect& r) -> SharedPointer<CView> {
+        return makeOwned<WaveformButton> (r, nullptr, kWavePreviewAdditive);
+    };
+    const auto waveDisplay = [] (const CRect& r) -> SharedPointer<CView> {
+        auto display = makeOwned<WaveformDisplay> (r);
+        display->setWaveform (kWaveSaw);
+        display->setResonance (0.7f);
+        return display;
+    };
+    const auto sweepCutoff = [] (CView* v, int i) {
+        static_cast<WaveformDisplay*> (v)->setCutoff (0.3f + 0.6f * (float)((i + kWarmupDraws) % 50) / 49.f);
+    };
+    const auto oscilloscope = [] (const CRect& r) -> SharedPointer<CView> {
+        auto scope = makeOwned<LiveOscilloscopeView> (r);
+        scope->setWaveform (kWaveSquare);
+        return scope;
+    };
+    const auto keyboard = [] (const CRect& r) -> SharedPointer<CView> {
+        return makeOwned<PianoKeyboardView> (r, nullptr, 0);
+    };
+    const auto playKeys = [] (CView* v, int i) {
+        auto* keys = static_cast<PianoKeyboardView*> (v);
+        const int note = PianoKeyboardView::kBaseNote + (i + kWarmupDraws) % PianoKeyboardView::kNumKeys;
+        keys->setNoteState (note, true);
+        keys->setNoteState (note == PianoKeyboardView::kBaseNote ? note + 11 : note - 1, false);
+    };
+
+    const ViewCase cases[] = {
+        {"SynthKnobView", CPoint (40, 40), knob, turnKnob},
+        {"SynthKnobView", CPoint (60, 60), knob, turnKnob},
+        {"SynthKnobView", CPoint (120, 120), knob, turnKnob},
+        {"WaveformButton", CPoint (40, 30), waveButton, nullptr},
+        {"WaveformButton", CPoint (80, 60), waveButton, nullptr},
+        {"WaveformDisplay", CPoint (300, 120), waveDisplay, sweepCutoff},
+        {"WaveformDisplay", CPoint (600, 240), waveDisplay, sweepCutoff},
+        {"LiveOscilloscopeView", CPoint (300, 120), oscilloscope, nullptr},
+        {"LiveOscilloscopeView", CPoint (600, 240), oscilloscope, nullptr},
+        {"PianoKeyboardView", CPoint (280, 60), keyboard, playKeys},
+        {"PianoKeyboardView", CPoint (560, 120), keyboard, playKeys},
+    };
+
+    printf ("median us per draw over %d draws\n", draws);
+    for (const ViewCase& c : cases)
+        for (double scale : kScaleFactors)
+            run (c, scale, draws);
+
+    VSTGUI::exit ();
+    return 0;
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------
+// Idle instance benchmark
+//
+// A project with many WineSynth tracks that are not playing should cost
+// next to nothing. Runs 40 instances round-robin, one 128-sample block
+// each per step like a host's callback, and reports ns per process ()
+// call:
+//   - never played
+//   - after a note has been released and its tail has died away, with
+//     the effects bus off and with delay and reverb on
+//   - during a long release tail, where denormals would show up
+//   - one sounding voice per instance, for comparison
+//
+//   winesynth_idle_bench [steps]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kBlockSize = 128;
+constexpr int kNumInstances = 40;
+
+enum State
+{
+    kNeverPlayed,
+    kReleased,
+    kReleasedEffects,
+    kInReleaseTail,
+    kSounding
+};
+
+const char* const kStateNames[] = {
+    "never played", "released, tail over", "released, delay + reverb over", "in a 3 s release tail",
+    "one voice sounding",
+};
+
+double nsPerCall (State state, int steps)
+{
+    std::vector<std::unique_ptr<OfflineHost>> hosts;
+    for (int i = 0; i < kNumInstances; i++)
+    {
+        hosts.emplace_back (new OfflineHost (kSampleRate, kBlockSize, kRealtime));
+        OfflineHost& host = *hosts.back ();
+        host.setParam (kWaveformId, plainStep (kWaveformId, kWaveSaw));
+        if (state == kReleasedEffects)
+        {
+            host.setParam (kDelayMixId, 0.3);
+            host.setParam (kDelayFeedbackId, 0.5);
+            host.setParam (kReverbMixId, 0.3);
+        }
+        if (state == kInReleaseTail)
+            host.setParam (kReleaseId, 1.0);
+
+        switch (state)
+        {
+            case kNeverPlayed:
+                host.render (kBlockSize, nullptr, nullptr);
+                break;
+            case kReleased:
+            case kReleasedEffects:
+                // Long enough for the release and the effect tails to end
+                host.noteOn (0, (int16)(48 + i % 24));
+                host.noteOff (4800, (int16)(48 + i % 24));
+                host.render ((int64)(30.0 * kSampleRate), nullptr, nullptr);
+                break;
+            case kInReleaseTail:
+                host.noteOn (0, (int16)(48 + i % 24));
+                host.noteOff (4800, (int16)(48 + i % 24));
+                host.render (4800 + kBlockSize, nullptr, nullptr);
+                break;
+            case kSounding:
+                host.noteOn (0, (int16)(48 + i % 24));
+                host.render (kBlockSize, nullptr, nullptr);
+                break;
+        }
+    }
+
+    const auto start = Clock::now ();
+    for (int step = 0; step < steps; step++)
+        for (auto& host : hosts)
+            host->render (kBlockSize, nullptr, nullptr);
+    return secondsSince (start) / ((double)steps * kNumInstances) * 1e9;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    // The release tail (3 s) must not end inside the measurement
+    const int maxSteps = (int)(2.5 * kSampleRate / kBlockSize);
+    const int steps = argc > 1 ? std::max (1, std::min (atoi (argv[1]), maxSteps)) : maxSteps;
+
+    printf ("%d instances, %d-sample blocks, %d steps, ns per process () call\n\n", kNumInstances, kBlockSize,
+            steps);
+    for (State state : {kNeverPlayed, kReleased, kReleasedEffects, kInReleaseTail, kSounding})
+        printf ("%-32s %10.0f ns\n", kStateNames[state], nsPerCall (state, steps));
+    return 0;
+}
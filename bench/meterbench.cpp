@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------
+// Output metering benchmark
+//
+// The output stage of the render loop on its own: stereo host blocks
+// written 32 samples (one realtime sub-block) at a time from the mix.
+// Reports ns per host block for the plain copy, and what each way of
+// metering adds to it:
+//   - fused: copyAndMeasure () writes and measures in one go
+//   - separate SIMD pass: the copy, then measureLevel () over the block
+//   - separate scalar pass: the copy, then a plain loop over the block
+// "hot" reuses one pair of host buffers; "cold" rotates through 512
+// pairs, like a host whose buffers have left the cache by the next call.
+//
+//   winesynth_meter_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "meter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+
+namespace {
+
+constexpr int32_t kSubBlock = 32;
+constexpr int32_t kBlockSizes[] = {64, 256, 1024};
+constexpr int32_t kNumColdBuffers = 512;
+constexpr int kRuns = 7;
+
+enum Method
+{
+    kPlainCopy,
+    kFused,
+    kSeparateSimd,
+    kSeparateScalar,
+    kNumMethods
+};
+
+struct Stage
+{
+    Stage (int32_t blockSize, int32_t numBuffers)
+    : blockSize (blockSize), numBuffers (numBuffers), mix (2 * kSubBlock),
+      buffers ((size_t)(2 * numBuffers), std::vector<float> (blockSize))
+    {
+        for (int32_t s = 0; s < 2 * kSubBlock; s++)
+            mix[s] = 0.5f * sinf (0.3f * s);
+    }
+
+    void run (Method method, int64_t i)
+    {
+        float* out[2] = {buffers[2 * (i % numBuffers)].data (), buffers[2 * (i % numBuffers) + 1].data ()};
+        for (int32_t pos = 0; pos < blockSize; pos += kSubBlock)
+        {
+            for (int32_t c = 0; c < 2; c++)
+            {
+                const float* src = mix.data () + c * kSubBlock;
+                if (method == kFused)
+                    copyAndMeasure (out[c] + pos, src, kSubBlock, level[c]);
+                else
+                    memcpy (out[c] + pos, src, kSubBlock * sizeof (float));
+            }
+        }
+        for (int32_t c = 0; c < 2; c++)
+        {
+            if (method == kSeparateSimd)
+            {
+                measureLevel (out[c], blockSize, level[c]);
+            }
+            else if (method == kSeparateScalar)
+            {
+                for (int32_t s = 0; s < blockSize; s++)
+                {
+                    const float x = out[c][s];
+                    level[c].tailPeak = std::max (level[c].tailPeak, fabsf (x));
+                    level[c].tailSquares += x * x;
+                }
+            }
+        }
+        sink = out[1][i & (blockSize - 1)] + level[0].getPeak () + level[1].getSumSquares ();
+    }
+
+    const int32_t blockSize;
+    const int32_t numBuffers;
+    std::vector<float> mix;
+    std::vector<std::vector<float>> buffers;
+    ChannelLevel level[2];
+};
+
+// Best of kRuns, ns per host block
+double nsPerBlock (Stage& stage, Method method, double seconds)
+{
+    const int64_t reps = std::max<int64_t> (1, (int64_t)(seconds / kRuns * 1e9 / (8.0 * stage.blockSize)));
+    double best = 1e30;
+    for (int run = 0; run < kRuns; run++)
+    {
+        const auto start = Clock::now ();
+        for (int64_t i = 0; i < reps; i++)
+            stage.run (method, i);
+        best = std::min (best, secondsSince (start) / (double)reps * 1e9);
+    }
+    return best;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.1) : 1.0;
+    const double perCase = seconds / (2 * kNumMethods);
+
+    printf ("ns per stereo host block, %d-sample sub-blocks; metering cost over the copy in parentheses\n\n",
+            kSubBlock);
+    printf ("%-12s %8s %16s %18s %20s\n", "block", "copy", "fused", "separate SIMD", "separate scalar");
+    for (int32_t blockSize : kBlockSizes)
+    {
+        for (int32_t numBuffers : {1, kNumColdBuffers})
+        {
+            Stage stage (blockSize, numBuffers);
+            double ns[kNumMethods];
+            for (int m = 0; m < kNumMethods; m++)
+                ns[m] = nsPerBlock (stage, (Method)m, perCase);
+            printf ("%5d, %-5s %8.0f %8.0f (%+5.0f) %10.0f (%+5.0f) %12.0f (%+5.0f)\n", blockSize,
+                    numBuffers == 1 ? "hot" : "cold", ns[kPlainCopy], ns[kFused], ns[kFused] - ns[kPlainCopy],
+                    ns[kSeparateSimd], ns[kSeparateSimd] - ns[kPlainCopy], ns[kSeparateScalar],
+                    ns[kSeparateScalar] - ns[kPlainCopy]);
+        }
+    }
+    return 0;
+}
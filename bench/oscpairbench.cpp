@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------
+// Oscillator pair benchmark: cost of the second oscillator and aliasing
+// of the band-limited sync
+//
+// Cost: 8 held notes with a single oscillator, with the pair (Osc 2
+// level, FM and sync all on) and, for comparison, 16 single-oscillator
+// notes, in both quality profiles. ns per output sample of process ()
+// for all notes together: the pair should cost far less than doubling
+// the voices.
+//
+// Aliasing: one note through the open filter, in the realtime profile
+// (BLEP at the sample rate) and the offline one (4x oversampled, the
+// reference). Energy between the harmonics of the output fundamental
+// relative to the energy on them.
+//
+//   winesynth_oscpair_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kBlockSize = 128;
+const char* const kWaveNames[kNumWaveforms] = {"sine", "saw", "square", "triangle"};
+
+enum Setup
+{
+    kSingle,
+    kPair,
+    kDoubleVoices
+};
+
+double costPerSample (int32 waveform, Setup setup, int32 processMode, double seconds)
+{
+    const int32 notes = setup == kDoubleVoices ? 16 : 8;
+    OfflineHost host (kSampleRate, kBlockSize, processMode);
+    host.setParam (kWaveformId, plainStep (kWaveformId, waveform));
+    host.setParam (kPolyphonyId, plainStep (kPolyphonyId, 16));
+    if (setup == kPair)
+    {
+        host.setParam (kOsc2WaveformId, plainStep (kOsc2WaveformId, waveform));
+        host.setParam (kOsc2PitchId, plainStep (kOsc2PitchId, -7));
+        host.setParam (kOsc2LevelId, 0.5);
+        host.setParam (kFmDepthId, 0.3);
+        host.setParam (kSyncId, plainStep (kSyncId, 1));
+    }
+    for (int32 i = 0; i < notes; i++)
+        host.noteOn (0, (int16)(48 + 2 * i));
+    host.render (4096, nullptr, nullptr);
+
+    const int64 frames = (int64)(seconds * kSampleRate);
+    const auto start = Clock::now ();
+    host.render (frames, nullptr, nullptr);
+    return secondsSince (start) / (double)frames * 1e9;
+}
+
+struct AliasCase
+{
+    const char* name;
+    int32 waveform;
+    int16 pitch;
+    bool sync;
+    int32 osc2Semitones;       // master (Osc 2) relative to the note
+    double osc2Cents;
+};
+
+void aliasing (const AliasCase& c, double seconds)
+{
+    double inharmonic[2];
+    const int32 modes[2] = {kRealtime, kOffline};
+    for (int m = 0; m < 2; m++)
+    {
+        OfflineHost host (kSampleRate, kBlockSize, modes[m]);
+        host.setParam (kWaveformId, plainStep (kWaveformId, c.waveform));
+        host.setParam (kCutoffId, 1.0);
+        host.setParam (kResonanceId, 0.0);
+        if (c.sync)
+        {
+            host.setParam (kSyncId, plainStep (kSyncId, 1));
+            host.setParam (kOsc2PitchId, plainStep (kOsc2PitchId, c.osc2Semitones));
+            host.setParam (kOsc2FineId, (c.osc2Cents + 100.0) / 200.0);
+        }
+        host.noteOn (0, c.pitch);
+        host.render ((int64)(0.25 * kSampleRate), nullptr, nullptr);
+
+        std::vector<float> left;
+        host.render ((int64)(seconds * kSampleRate), &left, nullptr);
+
+        // With sync the output repeats at the master's frequency
+        const double semitones = c.pitch - 69 + (c.sync ? c.osc2Semitones + 0.01 * c.osc2Cents : 0.0);
+        inharmonic[m] = inharmonicDb (left, kSampleRate, 440.0 * pow (2.0, semitones / 12.0));
+    }
+    printf ("  %-34s %8.1f dB %8.1f dB\n", c.name, inharmonic[0], inharmonic[1]);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 1.0) : 4.0;
+
+    printf ("%-16s %9s %8s %9s\n", "ns per sample", "8 single", "8 pair", "16 single");
+    for (int32 processMode : {(int32)kRealtime, (int32)kOffline})
+    {
+        for (int32 waveform : {(int32)kWaveSaw, (int32)kWaveSine})
+        {
+            printf ("  %-8s %-5s %9.1f %8.1f %9.1f\n", processMode == kOffline ? "offline" : "realtime",
+                    kWaveNames[waveform], costPerSample (waveform, kSingle, processMode, seconds),
+                    costPerSample (waveform, kPair, processMode, seconds),
+                    costPerSample (waveform, kDoubleVoices, processMode, seconds));
+        }
+    }
+
+    // Note 84 is 1046.5 Hz. Synced to a master at the same pitch, the pair
+    // plays a plain BLEP saw; -15 st +5 ct and -22 st +31 ct put the
+    // master near 440 and 294 Hz, slave ratios of 2.37 and 3.50
+    const AliasCase cases[] = {
+        {"saw 1046 Hz, single (naive)", kWaveSaw, 84, false, 0, 0.0},
+        {"saw 1046 Hz, pair synced at 1x", kWaveSaw, 84, true, 0, 0.0},
+        {"sync saw, slave 2.37x 440 Hz", kWaveSaw, 84, true, -15, 5.0},
+        {"sync saw, slave 3.50x 294 Hz", kWaveSaw, 84, true, -22, 31.0},
+        {"sync sine, slave 3.50x 294 Hz", kWaveSine, 84, true, -22, 31.0},
+    };
+    printf ("\n%-36s %11s %11s\n", "inharmonic energy", "realtime", "offline 4x");
+    for (const AliasCase& c : cases)
+        aliasing (c, seconds);
+    return 0;
+}
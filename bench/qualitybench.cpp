@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------
+// Render quality profile benchmark
+//
+// Realtime factor (seconds of audio per second of wall time) of the
+// realtime and offline profiles for a few voice counts and patches, with
+// the block size each kind of host typically uses: 128 samples live,
+// 1024 when bouncing. Higher is faster; below 1 a live host would drop
+// out, and the offline row is what an export farm pays per stem.
+//
+//   winesynth_quality_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+
+struct Patch
+{
+    const char* name;
+    int32 voices;
+    int32 unison;
+    bool effects;
+};
+
+double realtimeFactor (const Patch& patch, int32 processMode, double seconds)
+{
+    const int32 blockSize = processMode == kOffline ? 1024 : 128;
+    OfflineHost host (kSampleRate, blockSize, processMode);
+    host.setParam (kWaveformId, plainStep (kWaveformId, kWaveSaw));
+    host.setParam (kCutoffId, 0.6);
+    host.setParam (kResonanceId, 0.4);
+    host.setParam (kPolyphonyId, plainStep (kPolyphonyId, std::max (patch.voices, 8)));
+    host.setParam (kUnisonVoicesId, plainStep (kUnisonVoicesId, patch.unison));
+    host.setParam (kUnisonDetuneId, 0.3);
+    if (patch.effects)
+    {
+        host.setParam (kDriveId, 0.25);
+        host.setParam (kChorusMixId, 0.4);
+        host.setParam (kDelayMixId, 0.3);
+        host.setParam (kReverbMixId, 0.2);
+    }
+    for (int32 i = 0; i < patch.voices; i++)
+        host.noteOn (0, (int16)(48 + 3 * i));
+
+    const int64 frames = (int64)(seconds * kSampleRate);
+    const auto start = Clock::now ();
+    host.render (frames, nullptr, nullptr);
+    return seconds / secondsSince (start);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.5) : 10.0;
+
+    const Patch patches[] = {
+        {"1 voice", 1, 1, false},
+        {"8 voices", 8, 1, false},
+        {"16 voices", 16, 1, false},
+        {"8 voices, unison 4", 8, 4, false},
+        {"8 voices, unison 4 + fx", 8, 4, true},
+    };
+
+    printf ("realtime factor, saw, %.0f s at %.0f Hz\n\n", seconds, kSampleRate);
+    printf ("%-26s %12s %12s\n", "", "realtime", "offline");
+    for (const Patch& p : patches)
+    {
+        const double live = realtimeFactor (p, kRealtime, seconds);
+        const double bounce = realtimeFactor (p, kOffline, seconds);
+        printf ("%-26s %11.1fx %11.1fx\n", p.name, live, bounce);
+    }
+    return 0;
+}
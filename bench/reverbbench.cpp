@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------
+// Convolution reverb benchmark
+//
+// ConvolutionReverb::process () alone on stereo noise with 1, 3 and 6 s
+// impulses (decaying noise, at the processing rate so nothing is
+// resampled), fed in 32-sample sub-blocks like the realtime render loop.
+// Reports mean, 99th percentile and worst time per host block at several
+// host block sizes, and the mean as a share of the block's duration. The
+// partition work is spread over the sub-blocks, so p99 should stay close
+// to the mean even for blocks shorter than a partition.
+//
+//   winesynth_reverb_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "arena.h"
+#include "benchutil.h"
+#include "reverb.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32_t kSubBlock = 32;
+constexpr double kImpulseSeconds[] = {1.0, 3.0, 6.0};
+constexpr int32_t kBlockSizes[] = {64, 256, 1024};
+
+AudioFile makeImpulse (double seconds)
+{
+    AudioFile file;
+    file.sampleRate = kSampleRate;
+    const int32_t frames = (int32_t)(seconds * kSampleRate);
+    Random random;
+    for (int32_t c = 0; c < 2; c++)
+    {
+        std::vector<float> channel (frames);
+        for (int32_t i = 0; i < frames; i++)
+        {
+            const double decay = exp (-6.9 * i / frames);     // -60 dB at the end
+            channel[i] = (float)(decay * (random.range (-32768, 32767) / 32768.0));
+        }
+        file.channels.push_back (std::move (channel));
+    }
+    return file;
+}
+
+void bench (const AudioFile& file, double impulseSeconds, int32_t blockSize, double seconds)
+{
+    Arena arena;
+    arena.reserve (ConvolutionReverb::getArenaBytes ());
+    ConvolutionReverb reverb;
+    reverb.prepare (arena);
+    reverb.publish (reverb.makeImpulse (file, kSampleRate));
+    reverb.setMix (0.3);
+
+    std::vector<float> left (blockSize), right (blockSize);
+    Random random (7);
+    auto fillInput = [&] () {
+        for (int32_t s = 0; s < blockSize; s++)
+        {
+            left[s] = random.range (-8192, 8192) / 32768.f;
+            right[s] = random.range (-8192, 8192) / 32768.f;
+        }
+    };
+    auto processBlock = [&] () {
+        reverb.update ();
+        for (int32_t pos = 0; pos < blockSize; pos += kSubBlock)
+            reverb.process (left.data () + pos, right.data () + pos, kSubBlock, true);
+        sink = left[blockSize - 1];
+    };
+
+    // One impulse length first, so the delay line is full
+    const int64_t warmUp = (int64_t)(impulseSeconds * kSampleRate) / blockSize + 1;
+    for (int64_t b = 0; b < warmUp; b++)
+    {
+        fillInput ();
+        processBlock ();
+    }
+
+    const int64_t numBlocks = std::max<int64_t> (1, (int64_t)(seconds * kSampleRate / blockSize));
+    Timings timings;
+    timings.reserve ((size_t)numBlocks);
+    for (int64_t b = 0; b < numBlocks; b++)
+    {
+        fillInput ();
+        const auto start = Clock::now ();
+        processBlock ();
+        timings.add (secondsSince (start));
+    }
+
+    const double blockSeconds = blockSize / kSampleRate;
+    printf ("  %3.0f s   %5d %10.1f %10.1f %10.1f %8.1f %%\n", impulseSeconds, blockSize, timings.mean () * 1e6,
+            timings.percentile (99.0) * 1e6, timings.max () * 1e6, 100.0 * timings.mean () / blockSeconds);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.5) : 5.0;
+
+    printf ("ConvolutionReverb::process (), stereo, %.0f kHz, %d-sample sub-blocks, us per host block\n\n",
+            kSampleRate / 1000.0, kSubBlock);
+    printf ("  %-7s %5s %10s %10s %10s %10s\n", "impulse", "block", "mean", "p99", "max", "of block");
+    for (double impulseSeconds : kImpulseSeconds)
+    {
+        const AudioFile file = makeImpulse (impulseSeconds);
+        for (int32_t blockSize : kBlockSizes)
+            bench (file, impulseSeconds, blockSize, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------
+// Spectrum analyzer benchmark
+//
+// Audio thread: ns per SpectrumTap::push () of a 256-frame stereo block
+// with no analyzer listening, listening at 48 kHz, and listening at 96 and
+// 192 kHz, where the feed is decimated first.
+//
+// Worker: µs per RealFft::forward () at each analysis size, the bulk of
+// one analysis frame.
+//
+// Accuracy: -6 dB sines at 60 Hz, 1 kHz and 12 kHz through a running
+// SpectrumAnalyzer at each sample rate; the frequency and level of the
+// highest point, and the highest point more than 4 FFT bins and a third
+// of an octave away (above a few kHz a point spans many bins).
+//
+//   winesynth_spectrum_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "fft.h"
+#include "spectrum.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+
+namespace {
+
+constexpr int32_t kBlockSize = 256;
+constexpr int32_t kFftSize = 4096;
+constexpr double kSampleRates[] = {48000.0, 96000.0, 192000.0};
+
+uint32_t nextInstanceId = 1;
+
+double nsPerPush (double sampleRate, bool listening, double seconds)
+{
+    auto feed = SpectrumFeed::get (nextInstanceId++);
+    SpectrumTap tap;
+    tap.attach (feed);
+    tap.prepare (sampleRate);
+    if (listening)
+        feed->addListener ();
+
+    std::vector<float> left (kBlockSize), right (kBlockSize);
+    for (int32_t s = 0; s < kBlockSize; s++)
+    {
+        left[s] = 0.5f * sinf (0.05f * s);
+        right[s] = 0.5f * sinf (0.07f * s);
+    }
+    float* channels[2] = {left.data (), right.data ()};
+
+    const int64_t blocks = std::max<int64_t> (1, (int64_t)(seconds * 1e6));      // about 1 ns each idle
+    const int64_t reps = listening ? blocks / 1000 : blocks;
+    const auto start = Clock::now ();
+    for (int64_t i = 0; i < reps; i++)
+        tap.push (channels, 2, kBlockSize);
+    const double ns = secondsSince (start) / (double)reps * 1e9;
+
+    if (listening)
+        feed->removeListener ();
+    return ns;
+}
+
+double usPerFft (int32_t size, double seconds)
+{
+    RealFft fft;
+    fft.init (size);
+    std::vector<float> in (size);
+    std::vector<Fft::Complex> out (size / 2 + 1);
+    for (int32_t i = 0; i < size; i++)
+        in[i] = sinf (0.37f * i) + 0.5f * sinf (0.011f * i);
+
+    int64_t reps = 0;
+    const auto start = Clock::now ();
+    while (secondsSince (start) < seconds)
+    {
+        for (int i = 0; i < 16; i++)
+            fft.forward (in.data (), out.data ());
+        sink = out[reps & (size / 2 - 1)].real ();
+        reps += 16;
+    }
+    return secondsSince (start) / (double)reps * 1e6;
+}
+
+double frequencyAt (const SpectrumFrame& frame, int32_t i)
+{
+    return frame.minFrequency * pow (frame.maxFrequency / frame.minFrequency, frame.x[i]);
+}
+
+void accuracy (double sampleRate, double frequency)
+{
+    auto feed = SpectrumFeed::get (nextInstanceId++);
+    SpectrumTap tap;
+    tap.attach (feed);
+    tap.prepare (sampleRate);
+    SpectrumAnalyzer analyzer (feed, kFftSize, 192);
+    analyzer.setInterval (0.005);
+    analyzer.setRunning (true);
+
+    // Fed at about 4x real time, so the worker keeps up with the ring
+    std::vector<float> block (kBlockSize);
+    float* channels[2] = {block.data (), block.data ()};
+    double phase = 0.0;
+    const double inc = 2.0 * M_PI * frequency / sampleRate;
+    const int32_t blocks = (int32_t)(0.4 * sampleRate / kBlockSize);
+    for (int32_t b = 0; b < blocks; b++)
+    {
+        for (auto& x : block)
+        {
+            x = (float)(0.5 * sin (phase));
+            phase += inc;
+        }
+        tap.push (channels, 2, kBlockSize);
+        if (b % 8 == 0)
+            std::this_thread::sleep_for (std::chrono::microseconds (200));
+    }
+    std::this_thread::sleep_for (std::chrono::milliseconds (30));
+
+    const SpectrumFrame& frame = analyzer.read ();
+    const double binWidth = feed->getSampleRate () / kFftSize;
+    int32_t best = 0;
+    float away = 0.f;
+    for (int32_t i = 0; i < frame.numPoints; i++)
+    {
+        if (frame.y[i] > frame.y[best])
+            best = i;
+        const double f = frequencyAt (frame, i);
+        if (fabs (f - frequency) > 4.0 * binWidth && fabs (log2 (f / frequency)) > 1.0 / 3.0)
+            away = std::max (away, frame.y[i]);
+    }
+    const double range = -SpectrumAnalyzer::kFloorDb;
+    printf ("  %6.0f Hz  %5.0f Hz sine   peak %7.1f Hz %6.1f dB   elsewhere %6.1f dB\n", sampleRate, frequency,
+            frequencyAt (frame, best), (frame.y[best] - 1.0) * range, (away - 1.0) * range);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.1) : 1.0;
+
+    printf ("SpectrumTap::push (), %d-frame stereo block\n", kBlockSize);
+    printf ("  %-28s %9.1f ns\n", "not listening", nsPerPush (48000.0, false, seconds));
+    for (double sampleRate : kSampleRates)
+    {
+        char name[40];
+        snprintf (name, sizeof (name), "listening at %.0f kHz", sampleRate / 1000.0);
+        printf ("  %-28s %9.1f ns\n", name, nsPerPush (sampleRate, true, seconds));
+    }
+
+    printf ("\nRealFft::forward (), one analysis frame\n");
+    for (int32_t size = SpectrumAnalyzer::kMinFftSize; size <= SpectrumAnalyzer::kMaxFftSize; size *= 2)
+        printf ("  %4d points %9.1f us\n", size, usPerFft (size, 0.25 * seconds));
+
+    printf ("\n-6 dB sines, %d-point analysis, 192 points\n", kFftSize);
+    for (double sampleRate : kSampleRates)
+        for (double frequency : {60.0, 1000.0, 12000.0})
+            accuracy (sampleRate, frequency);
+    return 0;
+}
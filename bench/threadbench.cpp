@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------
+// Render thread scaling benchmark
+//
+// Renders the same heavy patches with Render Threads at 1 to 16 and
+// reports wall time per second of audio, the speedup over one thread and
+// whether the output is bit-identical to the single-threaded render.
+// Offline profile rows are deterministic and checked; realtime rows are
+// timed only (the governor may step quality down under load) and also
+// report the 99th percentile block time. The processor caps the pool at
+// the number of hardware threads, so settings above it repeat the cap.
+//
+//   winesynth_thread_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kBlockSize = 256;
+constexpr int32 kThreadCounts[] = {1, 2, 3, 4, 6, 8, 12, 16};
+
+struct Patch
+{
+    const char* name;
+    int32 voices;
+    int32 unison;
+    bool effects;
+    bool additive;
+};
+
+struct Result
+{
+    double seconds;
+    double p99Block;
+    std::vector<float> output;
+};
+
+Result render (const Patch& patch, int32 processMode, int32 threads, double seconds)
+{
+    OfflineHost host (kSampleRate, kBlockSize, processMode);
+    host.setInitialParam (kRenderThreadsId, plainStep (kRenderThreadsId, threads));
+    host.setParam (kWaveformId, plainStep (kWaveformId, kWaveSaw));
+    host.setParam (kPolyphonyId, plainStep (kPolyphonyId, patch.voices));
+    host.setParam (kUnisonVoicesId, plainStep (kUnisonVoicesId, patch.unison));
+    host.setParam (kUnisonDetuneId, 0.3);
+    host.setParam (kCutoffId, 0.6);
+    if (patch.additive)
+    {
+        host.setParam (kOscModeId, plainStep (kOscModeId, kOscModeAdditive));
+        host.setParam (kPartialsId, plainStep (kPartialsId, 128));
+    }
+    if (patch.effects)
+    {
+        host.setParam (kDriveId, 0.25);
+        host.setParam (kChorusMixId, 0.4);
+    }
+    for (int32 i = 0; i < patch.voices; i++)
+        host.noteOn (0, (int16)(36 + 3 * i));
+
+    Result result;
+    const int64 numBlocks = (int64)(seconds * kSampleRate / kBlockSize);
+    result.output.reserve ((size_t)(numBlocks * kBlockSize));
+    Timings timings;
+    timings.reserve ((size_t)numBlocks);
+    const auto start = Clock::now ();
+    for (int64 b = 0; b < numBlocks; b++)
+    {
+        const auto blockStart = Clock::now ();
+        host.render (kBlockSize, &result.output, nullptr);
+        timings.add (secondsSince (blockStart));
+    }
+    result.seconds = secondsSince (start) / seconds;
+    result.p99Block = timings.percentile (99.0);
+    return result;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.2) : 2.0;
+
+    const Patch patches[] = {
+        {"16 saw voices", 16, 1, false, false},
+        {"16 voices, unison 8 + drive/chorus", 16, 8, true, false},
+        {"16 voices, additive 128 partials", 16, 1, false, true},
+    };
+
+    const int32 cores = std::max<int32> (1, (int32)std::thread::hardware_concurrency ());
+    printf ("%d hardware threads (* = capped to that), %d-sample blocks, %.1f s of audio per run\n", cores,
+            kBlockSize, seconds);
+    for (const Patch& patch : patches)
+    {
+        for (int32 processMode : {(int32)kOffline, (int32)kRealtime})
+        {
+            const bool offline = processMode == kOffline;
+            printf ("\n%s, %s\n", patch.name, offline ? "offline (checked against 1 thread)" : "realtime");
+            Result single;
+            for (int32 threads : kThreadCounts)
+            {
+                Result r = render (patch, processMode, threads, seconds);
+                if (threads == 1)
+                    single = r;
+                printf ("  %2d threads%s %8.1f ms per s  %5.2fx", threads, threads > cores ? "*" : " ", r.seconds * 1e3,
+                        single.seconds / r.seconds);
+                if (offline)
+                {
+                    const bool same = r.output.size () == single.output.size ()
+                                   && memcmp (r.output.data (), single.output.data (),
+                                              r.output.size () * sizeof (float)) == 0;
+                    printf ("  %s\n", same ? "identical" : "DIFFERS");
+                }
+                else
+                {
+                    printf ("  p99 block %7.1f us\n", r.p99Block * 1e6);
+                }
+            }
+        }
+    }
+    return 0;
+}
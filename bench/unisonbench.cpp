@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------
+// Unison stack benchmark: cost per unison oscillator
+//
+// Kernel: renderUnison () alone on 32-sample segments, ns per output
+// sample and per oscillator-sample, for every waveform and stack size.
+//
+// Processor: 8 held notes in the realtime profile at each Unison setting,
+// ns per voice-sample of process (). The step from 1 to 2 includes the
+// fixed cost of going stereo per voice (a second drive / filter chain);
+// the steps after it are the oscillators themselves.
+//
+//   winesynth_unison_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+#include "unison.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kSegment = 32;
+constexpr int32 kStackSizes[] = {1, 2, 4, 8, 16};
+const char* const kWaveNames[kNumWaveforms] = {"sine", "saw", "square", "triangle"};
+
+void benchKernel (int32 waveform, int32 count, double seconds)
+{
+    UnisonState state;
+    uint32_t seed = 1;
+    state.randomize (seed);
+    const UnisonSetup setup = UnisonSetup::make (count, 25.0, 0.5);
+
+    alignas (32) float left[kSegment];
+    alignas (32) float right[kSegment];
+    const int64 segments = (int64)(seconds * kSampleRate / kSegment);
+
+    const auto start = Clock::now ();
+    dispatchUnisonWave (waveform, [&] (auto wave) {
+        using Wave = decltype (wave);
+        for (int64 i = 0; i < segments; i++)
+        {
+            renderUnison<Wave> (state, setup, 0.01f, left, right, kSegment);
+            sink = left[i & (kSegment - 1)];
+        }
+    });
+    const double ns = secondsSince (start) / (double)(segments * kSegment) * 1e9;
+
+    printf ("  %-9s %2d osc   %6.2f ns/sample   %5.2f ns/osc-sample\n", kWaveNames[waveform], count, ns,
+            ns / count);
+}
+
+double benchProcessor (int32 waveform, int32 count, double seconds)
+{
+    constexpr int32 kNotes = 8;
+    OfflineHost host (kSampleRate, 128, kRealtime);
+    host.setParam (kWaveformId, plainStep (kWaveformId, waveform));
+    host.setParam (kUnisonVoicesId, plainStep (kUnisonVoicesId, count));
+    host.setParam (kUnisonDetuneId, 0.25);
+    host.setParam (kUnisonSpreadId, 0.5);
+    for (int32 i = 0; i < kNotes; i++)
+        host.noteOn (0, (int16)(48 + 3 * i));
+    host.render (4096, nullptr, nullptr);
+
+    const int64 frames = (int64)(seconds * kSampleRate);
+    const auto start = Clock::now ();
+    host.render (frames, nullptr, nullptr);
+    return secondsSince (start) / (double)(frames * kNotes) * 1e9;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.2) : 4.0;
+
+    printf ("renderUnison, %d-sample segments\n", kSegment);
+    for (int32 waveform = 0; waveform < kNumWaveforms; waveform++)
+        for (int32 count : kStackSizes)
+            benchKernel (waveform, count, seconds);
+
+    printf ("\nprocess (), 8 voices, realtime profile, ns per voice-sample\n");
+    for (int32 waveform : {(int32)kWaveSaw, (int32)kWaveSine})
+    {
+        printf ("  %-9s", kWaveNames[waveform]);
+        double previous = 0.0;
+        for (int32 count : kStackSizes)
+        {
+            const double ns = benchProcessor (waveform, count, seconds);
+            if (count == 1)
+                printf ("  1 osc %6.1f", ns);
+            else
+                printf ("  %2d osc %6.1f (%+5.1f)", count, ns, ns - previous);
+            previous = ns;
+        }
+        printf ("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------
+// Voice allocation stress benchmark
+//
+// Plays 1000 notes per second (random pitches, 150 ms each) into the
+// realtime engine for every steal policy and a few Voices settings, so
+// nearly every note-on steals. Reports process () time per 128-sample
+// block: mean, 99th percentile and worst, and the worst as a share of
+// the block's duration. The "held" rows play the same voice count with
+// no note traffic, as the floor the stress rows are compared with.
+//
+//   winesynth_voice_bench [seconds]
+//------------------------------------------------------------------------
+
+#include "benchutil.h"
+#include "offlinehost.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Bench;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int32 kBlockSize = 128;
+constexpr double kNotesPerSecond = 1000.0;
+constexpr int64 kNoteFrames = (int64)(0.150 * kSampleRate);
+
+const char* const kPolicyNames[] = {"oldest", "quietest", "same note"};
+
+void run (int32 voices, int32 policy, bool stress, double seconds)
+{
+    OfflineHost host (kSampleRate, kBlockSize, kRealtime);
+    host.setParam (kWaveformId, plainStep (kWaveformId, 1));
+    host.setParam (kPolyphonyId, plainStep (kPolyphonyId, voices));
+    host.setParam (kStealModeId, plainStep (kStealModeId, policy));
+    host.setParam (kReleaseId, 0.2);
+
+    Random random;
+    const int64 numBlocks = (int64)(seconds * kSampleRate / kBlockSize);
+    const double framesPerNote = kSampleRate / kNotesPerSecond;
+    double nextNote = 0.0;
+
+    if (!stress)
+    {
+        for (int32 i = 0; i < voices; i++)
+            host.noteOn (0, (int16)(36 + i));
+    }
+
+    Timings timings;
+    timings.reserve ((size_t)numBlocks);
+    for (int64 block = 0; block < numBlocks; block++)
+    {
+        const int64 blockEnd = host.getFrame () + kBlockSize;
+        while (stress && nextNote < (double)blockEnd)
+        {
+            const int64 at = (int64)nextNote;
+            const int16 pitch = (int16)random.range (24, 96);
+            host.noteOn (at, pitch, 0.3f + 0.7f * (float)random.range (0, 100) / 100.f);
+            host.noteOff (at + kNoteFrames, pitch);
+            nextNote += framesPerNote;
+        }
+
+        const auto start = Clock::now ();
+        host.render (kBlockSize, nullptr, nullptr);
+        timings.add (secondsSince (start));
+    }
+
+    const double blockSeconds = kBlockSize / kSampleRate;
+    printf ("%-6s %3d voices  %-9s  mean %7.1f us  p99 %7.1f us  max %7.1f us  (%5.1f %% of the block)\n",
+            stress ? "stress" : "held", voices, stress ? kPolicyNames[policy] : "-", timings.mean () * 1e6,
+            timings.percentile (99.0) * 1e6, timings.max () * 1e6, 100.0 * timings.max () / blockSeconds);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const double seconds = argc > 1 ? std::max (atof (argv[1]), 0.1) : 10.0;
+    printf ("%.0f notes/s, %d-sample blocks at %.0f Hz, %.0f s per row\n", kNotesPerSecond, kBlockSize,
+            kSampleRate, seconds);
+
+    for (int32 voices : {8, 16, 64})
+    {
+        run (voices, 0, false, seconds);
+        for (int32 policy = 0; policy < 3; policy++)
+            run (voices, policy, true, seconds);
+    }
+    return 0;
+}
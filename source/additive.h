@@ -0,0 +1,176 @@
+#pragma once
+
+#include "lanes.h"
+
+#include <cmath>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Additive oscillator — up to kMaxPartials harmonics per voice, amplitudes
+// from a spectral profile shared by all voices.
+//
+// Each partial is a unit phasor (re, im) turned by a fixed rotation every
+// sample; the output is the amplitude-weighted sum of the imaginary parts.
+// That is a complex multiply per partial and sample instead of a sin call,
+// and partials are rendered FloatLanes::kSize at a time. Partials at or
+// above Nyquist are dropped, so a high note costs fewer groups than a low
+// one. Amplitudes ramp linearly over each rendered segment (one sub-block
+// or less), so profile edits and culling do not click.
+//------------------------------------------------------------------------
+struct alignas (32) AdditiveState
+{
+    static constexpr int32_t kMaxPartials = 256;
+    static constexpr int32_t kLanes = FloatLanes::kSize;
+    static constexpr int32_t kMaxGroups = kMaxPartials / kLanes;
+
+    float re[kMaxPartials] = {};
+    float im[kMaxPartials] = {};
+    float amp[kMaxPartials] = {};     // amplitude reached at the end of the last segment
+    int32_t activeGroups = 0;         // groups with a partial that may still sound
+
+    // All partials at phase zero (sine phase), silent
+    void reset ()
+    {
+        for (int32_t k = 0; k < kMaxPartials; k++)
+        {
+            re[k] = 1.f;
+            im[k] = 0.f;
+            amp[k] = 0.f;
+        }
+        activeGroups = 0;
+    }
+};
+
+//------------------------------------------------------------------------
+// Partial amplitudes (index 0 = fundamental), rebuilt when the additive
+// parameters change
+//------------------------------------------------------------------------
+struct alignas (32) AdditiveProfile
+{
+    float amp[AdditiveState::kMaxPartials] = {};
+    int32_t partials = 1;
+
+    // Partial n has level n^-tilt (tilt 1 = saw spectrum, 2 = triangle-like),
+    // even partials scaled by evenLevel. Normalized to the power of a full
+    // scale saw, so switching waveforms keeps the level.
+    static AdditiveProfile make (int32_t partials, double tilt, double evenLevel)
+    {
+        AdditiveProfile p;
+        p.partials = partials < 1 ? 1 : (partials > AdditiveState::kMaxPartials ? AdditiveState::kMaxPartials : partials);
+
+        double power = 0.0;
+        for (int32_t k = 0; k < p.partials; k++)
+        {
+            const int32_t n = k + 1;
+            double a = pow ((double)n, -tilt) * ((n & 1) ? 1.0 : evenLevel);
+            p.amp[k] = (float)a;
+            power += 0.5 * a * a;
+        }
+        const double norm = sqrt ((1.0 / 3.0) / power);
+        for (int32_t k = 0; k < p.partials; k++)
+            p.amp[k] = (float)(p.amp[k] * norm);
+        return p;
+    }
+};
+
+//------------------------------------------------------------------------
+// Renders numSamples into out (overwritten). inc is the fundamental's
+// increment in cycles per rendered sample; cullInc the same at the output
+// rate, where Nyquist is decided (oversampled voices would only decimate
+// the partials above it away). At most maxPartials of the profile sound.
+//------------------------------------------------------------------------
+inline void renderAdditive (AdditiveState& state, const AdditiveProfile& profile, int32_t maxPartials, double inc,
+                            double cullInc, float* out, int32_t numSamples)
+{
+    using L = FloatLanes;
+    constexpr int32_t kLanes = AdditiveState::kLanes;
+
+    int32_t count = profile.partials < maxPartials ? profile.partials : maxPartials;
+    if (cullInc > 0.0)
+    {
+        const double belowNyquist = ceil (0.5 / cullInc) - 1.0;
+        if (belowNyquist < count)
+            count = belowNyquist > 0.0 ? (int32_t)belowNyquist : 0;
+    }
+    const int32_t soundingGroups = (count + kLanes - 1) / kLanes;
+    int32_t numGroups = soundingGroups > state.activeGroups ? soundingGroups : state.activeGroups;
+    numGroups += numGroups & 1;   // groups go in pairs; past activeGroups all amplitudes are zero
+
+    for (int32_t s = 0; s < numSamples; s++)
+        out[s] = 0.f;
+    if (numGroups == 0 || numSamples <= 0)
+        return;
+
+    // Rotation per partial: w_k = w_1^k, stepped in double
+    alignas (32) float rotRe[AdditiveState::kMaxPartials];
+    alignas (32) float rotIm[AdditiveState::kMaxPartials];
+    alignas (32) float target[AdditiveState::kMaxPartials];
+    {
+        const double c1 = cos (2.0 * M_PI * inc);
+        const double s1 = sin (2.0 * M_PI * inc);
+        double c = c1, s = s1;
+        for (int32_t k = 0; k < numGroups * kLanes; k++)
+        {
+            rotRe[k] = (float)c;
+            rotIm[k] = (float)s;
+            target[k] = k < count ? profile.amp[k] : 0.f;
+            const double next = c * c1 - s * s1;
+            s = s * c1 + c * s1;
+            c = next;
+        }
+    }
+
+    const float rampScale = 1.f / (float)numSamples;
+    const L half = L::set1 (0.5f);
+    const L threeHalves = L::set1 (1.5f);
+
+    // Two groups per pass: the rotation is a dependency chain from sample
+    // to sample, so a second independent chain fills its latency, and the
+    // two share one reduction per sample
+    for (int32_t g = 0; g < numGroups; g += 2)
+    {
+        const int32_t a = g * kLanes;
+        const int32_t b = a + kLanes;
+        L re0 = L::load (state.re + a), im0 = L::load (state.im + a);
+        L re1 = L::load (state.re + b), im1 = L::load (state.im + b);
+        const L cr0 = L::load (rotRe + a), ci0 = L::load (rotIm + a);
+        const L cr1 = L::load (rotRe + b), ci1 = L::load (rotIm + b);
+        const L goal0 = L::load (target + a), goal1 = L::load (target + b);
+        L amp0 = L::load (state.amp + a), amp1 = L::load (state.amp + b);
+        const L step0 = (goal0 - amp0) * L::set1 (rampScale);
+        const L step1 = (goal1 - amp1) * L::set1 (rampScale);
+
+        for (int32_t s = 0; s < numSamples; s++)
+        {
+            out[s] += L::sum (amp0 * im0 + amp1 * im1);
+
+            const L nextRe0 = re0 * cr0 - im0 * ci0;
+            const L nextRe1 = re1 * cr1 - im1 * ci1;
+            im0 = re0 * ci0 + im0 * cr0;
+            im1 = re1 * ci1 + im1 * cr1;
+            re0 = nextRe0;
+            re1 = nextRe1;
+            amp0 = amp0 + step0;
+            amp1 = amp1 + step1;
+        }
+
+        // One Newton step back to unit length against float drift
+        const L norm0 = threeHalves - half * (re0 * re0 + im0 * im0);
+        const L norm1 = threeHalves - half * (re1 * re1 + im1 * im1);
+        (re0 * norm0).store (state.re + a);
+        (im0 * norm0).store (state.im + a);
+        (re1 * norm1).store (state.re + b);
+        (im1 * norm1).store (state.im + b);
+        goal0.store (state.amp + a);
+        goal1.store (state.amp + b);
+    }
+    state.activeGroups = soundingGroups;
+}
+
+} // namespace WineSynth
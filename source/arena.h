@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Arena — per-instance bump allocator for DSP memory
+//
+// reserve () allocates one block, sized by the caller from the modules'
+// getArenaBytes () functions; allocate () hands out zeroed, cache-line
+// aligned pieces of it. Everything is released together by the next
+// reserve () or the destructor, so both must only be called while the
+// audio thread is stopped (constructor, setupProcessing).
+//------------------------------------------------------------------------
+class Arena
+{
+public:
+    static constexpr size_t kAlignment = 64;
+
+    static constexpr size_t alignUp (size_t bytes) { return (bytes + kAlignment - 1) & ~(kAlignment - 1); }
+
+    template <typename T>
+    static constexpr size_t bytesFor (size_t count)
+    {
+        return alignUp (count * sizeof (T));
+    }
+
+    void reserve (size_t bytes)
+    {
+        storage.reset (new uint8_t[bytes + kAlignment]);
+        uintptr_t base = reinterpret_cast<uintptr_t> (storage.get ());
+        begin = storage.get () + (alignUp (base) - base);
+        capacity = bytes;
+        used = 0;
+    }
+
+    // Zeroed memory for count elements, or nullptr if the reservation was
+    // too small (a sizing bug, not a runtime condition)
+    template <typename T>
+    T* allocate (size_t count)
+    {
+        static_assert (std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                       "arena memory is zero-filled and never destructed");
+        const size_t bytes = bytesFor<T> (count);
+        if (used + bytes > capacity)
+            return nullptr;
+        uint8_t* p = begin + used;
+        used += bytes;
+        memset (p, 0, bytes);
+        return reinterpret_cast<T*> (p);
+    }
+
+    size_t getCapacity () const { return capacity; }
+    size_t getUsed () const { return used; }
+
+private:
+    std::unique_ptr<uint8_t[]> storage;
+    uint8_t* begin = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+} // namespace WineSynth
@@ -1,9 +1,15 @@
 #include "controller.h"
+#include "plugincids.h"
 #include "pluginparamids.h"
+#include "params.h"
 #include "editor.h"
+#include "trace.h"
 
 #include "pluginterfaces/base/ibstream.h"
+#include "pluginterfaces/vst/ivstmessage.h"
+#include "pluginterfaces/vst/ivstmidicontrollers.h"
 #include "base/source/fstreamer.h"
+#include "public.sdk/source/vst/utility/stringconvert.h"
 
 #include <cstring>
 #include <cmath>
@@ -19,82 +25,114 @@ tresult PLUGIN_API Controller::initialize (FUnknown* context)
     if (result != kResultOk)
         return result;
 
-    // Gain (0..1, default 0.5)
-    parameters.addParameter (STR16 ("Gain"), nullptr, 0, 0.5,
-                             ParameterInfo::kCanAutomate, kGainId);
-
-    // Cutoff (0..1 → 20..20000 Hz, default 1.0 = fully open)
-    parameters.addParameter (STR16 ("Cutoff"), STR16 ("Hz"), 0, 1.0,
-                             ParameterInfo::kCanAutomate, kCutoffId);
-
-    // Fine tuning (0..1 → -100..+100 cent, default 0.5 = 0 cent)
-    parameters.addParameter (STR16 ("Fine"), STR16 ("ct"), 0, 0.5,
-                             ParameterInfo::kCanAutomate, kFineId);
-
-    // Resonance (0..1, default 0.0 = no resonance)
-    parameters.addParameter (STR16 ("Resonance"), nullptr, 0, 0.0,
-                             ParameterInfo::kCanAutomate, kResonanceId);
-
-    // Waveform (list: Sine, Saw, Square, Triangle)
-    auto* waveformParam = new StringListParameter (STR16 ("Waveform"), kWaveformId);
-    waveformParam->appendString (STR16 ("Sine"));
-    waveformParam->appendString (STR16 ("Saw"));
-    waveformParam->appendString (STR16 ("Square"));
-    waveformParam->appendString (STR16 ("Triangle"));
-    parameters.addParameter (waveformParam);
-
-    // Attack (0..1, default 0.05)
-    parameters.addParameter (STR16 ("Attack"), STR16 ("ms"), 0, 0.05,
-                             ParameterInfo::kCanAutomate, kAttackId);
-
-    // Release (0..1, default 0.3)
-    parameters.addParameter (STR16 ("Release"), STR16 ("ms"), 0, 0.3,
-                             ParameterInfo::kCanAutomate, kReleaseId);
-
-    // Bypass
-    parameters.addParameter (STR16 ("Bypass"), nullptr, 1, 0,
-                             ParameterInfo::kCanAutomate | ParameterInfo::kIsBypass, kBypassId);
-
-    // GUI Keyboard note (0=off, 1-12 = C4-B4) — not automatable, GUI-only
-    parameters.addParameter (STR16 ("KeyboardNote"), nullptr, 12, 0,
-                             0, kKeyboardNoteId);
-
+    // Register every parameter from the descriptor table (see params.h)
+    for (const auto& p : kParamTable)
+    {
+        if (p.listNames)
+        {
+            auto* listParam = new StringListParameter (p.title, p.id, p.units, p.flags);
+            for (int32 i = 0; i <= p.stepCount; i++)
+                listParam->appendString (p.listNames[i]);
+            parameters.addParameter (listParam);
+        }
+        else if (p.scale == ParamScale::kInteger)
+        {
+            parameters.addParameter (new RangeParameter (p.title, p.id, p.units, p.minPlain, p.maxPlain,
+                                                         toPlain (p, p.defaultNormalized),
+                                                         p.stepCount, p.flags));
+        }
+        else
+        {
+            parameters.addParameter (p.title, p.units, p.stepCount, p.defaultNormalized,
+                                     p.flags, p.id);
+        }
+    }
+
+    WINESYNTH_TRACE_ACQUIRE ();
     return result;
 }
 
+tresult PLUGIN_API Controller::terminate ()
+{
+    WINESYNTH_TRACE_RELEASE ();
+    return EditControllerEx1::terminate ();
+}
+
 tresult PLUGIN_API Controller::setComponentState (IBStream* state)
 {
     if (!state)
         return kResultFalse;
 
     IBStreamer streamer (state, kLittleEndian);
-    float f; int32 i;
+    bool ok = readParamState (streamer, [this] (ParamID id, double value) {
+        setParamNormalized (id, value);
+    });
+    if (!ok)
+        return kResultFalse;
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kGainId, f);
+    return kResultOk;
+}
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kCutoffId, f);
+tresult PLUGIN_API Controller::getMidiControllerAssignment (int32 busIndex, int16 /*channel*/,
+                                                            CtrlNumber midiControllerNumber, ParamID& id)
+{
+    if (busIndex == 0 && midiControllerNumber == kPitchBend)
+    {
+        id = kPitchBendId;
+        return kResultTrue;
+    }
+    return kResultFalse;
+}
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kFineId, f);
+bool Controller::loadTuning (const std::string& scl, const std::string& kbm)
+{
+    auto message = owned (allocateMessage ());
+    if (!message)
+        return false;
+
+    message->setMessageID (kMsgLoadTuning);
+    message->getAttributes ()->setBinary ("scl", scl.data (), (uint32)scl.size ());
+    message->getAttributes ()->setBinary ("kbm", kbm.data (), (uint32)kbm.size ());
+    return sendMessage (message) == kResultOk;
+}
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kResonanceId, f);
+bool Controller::loadImpulse (const std::string& path)
+{
+    auto message = owned (allocateMessage ());
+    if (!message)
+        return false;
 
-    if (!streamer.readInt32 (i)) return kResultFalse;
-    setParamNormalized (kWaveformId, (float)i / (float)(kNumWaveforms - 1));
+    message->setMessageID (kMsgLoadImpulse);
+    message->getAttributes ()->setBinary ("path", path.data (), (uint32)path.size ());
+    return sendMessage (message) == kResultOk;
+}
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kAttackId, f);
+tresult PLUGIN_API Controller::setChannelContextInfos (IAttributeList* list)
+{
+    String128 name {};
+    if (!list || list->getString (ChannelContext::kChannelNameKey, name, sizeof (name)) != kResultOk)
+        return kResultFalse;
 
-    if (!streamer.readFloat (f)) return kResultFalse;
-    setParamNormalized (kReleaseId, f);
+    auto message = owned (allocateMessage ());
+    if (!message)
+        return kResultFalse;
 
-    if (!streamer.readInt32 (i)) return kResultFalse;
-    setParamNormalized (kBypassId, i > 0 ? 1.0 : 0.0);
+    const std::string utf8 = VST3::StringConvert::convert (name);
+    message->setMessageID (kMsgChannelName);
+    message->getAttributes ()->setBinary ("name", utf8.data (), (uint32)utf8.size ());
+    return sendMessage (message);
+}
 
-    return kResultOk;
+tresult PLUGIN_API Controller::notify (IMessage* message)
+{
+    if (message && strcmp (message->getMessageID (), kMsgInstanceId) == 0)
+    {
+        int64 id = 0;
+        if (message->getAttributes ()->getInt ("id", id) == kResultOk)
+            instanceId = (uint32_t)id;
+        return kResultOk;
+    }
+    return EditControllerEx1::notify (message);
 }
 
 IPlugView* PLUGIN_API Controller::createView (const char* name)
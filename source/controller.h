@@ -2,10 +2,16 @@
 
 #include "public.sdk/source/vst/vsteditcontroller.h"
 #include "pluginterfaces/gui/iplugview.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "pluginterfaces/vst/ivstchannelcontextinfo.h"
+
+#include <string>
 
 namespace WineSynth {
 
-class Controller : public Steinberg::Vst::EditControllerEx1
+class Controller : public Steinberg::Vst::EditControllerEx1,
+                   public Steinberg::Vst::IMidiMapping,
+                   public Steinberg::Vst::ChannelContext::IInfoListener
 {
 public:
     static Steinberg::FUnknown* createInstance (void*)
@@ -14,8 +20,41 @@ public:
     }
 
     Steinberg::tresult PLUGIN_API initialize (Steinberg::FUnknown* context) SMTG_OVERRIDE;
+    Steinberg::tresult PLUGIN_API terminate () SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API setComponentState (Steinberg::IBStream* state) SMTG_OVERRIDE;
     Steinberg::IPlugView* PLUGIN_API createView (const char* name) SMTG_OVERRIDE;
+    Steinberg::tresult PLUGIN_API notify (Steinberg::Vst::IMessage* message) SMTG_OVERRIDE;
+
+    // IMidiMapping — routes MIDI pitch bend to kPitchBendId
+    Steinberg::tresult PLUGIN_API getMidiControllerAssignment (Steinberg::int32 busIndex,
+                                                               Steinberg::int16 channel,
+                                                               Steinberg::Vst::CtrlNumber midiControllerNumber,
+                                                               Steinberg::Vst::ParamID& id) SMTG_OVERRIDE;
+
+    // IInfoListener — passes the host's track name on to the processor,
+    // which shows it in the instance statistics
+    Steinberg::tresult PLUGIN_API setChannelContextInfos (Steinberg::Vst::IAttributeList* list) SMTG_OVERRIDE;
+
+    // Sends Scala scale / keyboard mapping file contents to the processor
+    // (empty strings restore 12-TET with A4 = 440 Hz)
+    bool loadTuning (const std::string& scl, const std::string& kbm);
+
+    // Asks the processor to load a reverb impulse (WAV) in the background
+    // (an empty path removes it)
+    bool loadImpulse (const std::string& path);
+
+    // The processor's instance ID in the statistics table, 0 until it is known
+    uint32_t getInstanceId () const { return instanceId; }
+
+    OBJ_METHODS (Controller, EditControllerEx1)
+    DEFINE_INTERFACES
+        DEF_INTERFACE (IMidiMapping)
+        DEF_INTERFACE (ChannelContext::IInfoListener)
+    END_DEFINE_INTERFACES (EditControllerEx1)
+    REFCOUNT_METHODS (EditControllerEx1)
+
+private:
+    uint32_t instanceId = 0;
 };
 
 } // namespace WineSynth
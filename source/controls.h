@@ -1,6 +1,12 @@
 #pragma once
 
 #include "pluginparamids.h"
+#include "params.h"
+#include "filter.h"
+#include "paintprofiler.h"
+#include "instancestats.h"
+#include "spectrum.h"
+#include "trace.h"
 #include "vstgui/lib/cview.h"
 #include "vstgui/lib/controls/ccontrol.h"
 #include "vstgui/lib/cdrawcontext.h"
@@ -9,8 +15,13 @@
 #include "vstgui/lib/cvstguitimer.h"
 #include "vstgui/lib/cbitmap.h"
 #include "vstgui/lib/coffscreencontext.h"
+#include "vstgui/lib/cfont.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <memory>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -32,6 +43,20 @@ static const CColor kButtonBg       (50, 50, 50, 255);
 static const CColor kButtonStroke   (100, 100, 100, 255);
 static const CColor kActiveStroke   (100, 255, 100, 255);
 
+// Wave type of the previews for the additive oscillator mode (kOscModeId),
+// which gets a button after the waveforms
+enum { kWavePreviewAdditive = kNumWaveforms, kNumWavePreviews };
+
+// Additive oscillator as drawn in the previews: the first partials of the
+// default (saw) profile, phase in radians
+inline double additivePreview (double phase)
+{
+    double sum = 0.0;
+    for (int n = 1; n <= 8; n++)
+        sum += sin (n * phase) / n;
+    return sum * (2.0 / M_PI);
+}
+
 //------------------------------------------------------------------------
 // SynthKnobView — vector-drawn knob with arc value indicator
 //------------------------------------------------------------------------
@@ -50,6 +75,9 @@ public:
 
     void draw (CDrawContext* context) override
     {
+        WINESYNTH_TRACE_SCOPE ("SynthKnobView::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kKnobs);
+
         context->setDrawMode (kAntiAliasing);
         auto r = getViewSize ();
 
@@ -154,7 +182,7 @@ private:
 // Each button has a unique tag (kWaveBtnTagBase + waveType).
 // Selection state is managed entirely by the Editor.
 //------------------------------------------------------------------------
-enum { kWaveBtnTagBase = 1000 };
+enum { kWaveBtnTagBase = 1000, kFilterBtnTagBase = 1100 };
 
 class WaveformButton : public CControl
 {
@@ -169,6 +197,9 @@ public:
 
     void draw (CDrawContext* context) override
     {
+        WINESYNTH_TRACE_SCOPE ("WaveformButton::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kWaveButtons);
+
         context->setDrawMode (kAntiAliasing);
         auto r = getViewSize ();
 
@@ -205,6 +236,7 @@ public:
                     case kWaveSaw:     sample = 2.0 * (t - 0.5); break;
                     case kWaveSquare:  sample = t < 0.5 ? 1.0 : -1.0; break;
                     case kWaveTriangle: sample = 4.0 * fabs (t - 0.5) - 1.0; break;
+                    case kWavePreviewAdditive: sample = additivePreview (phase); break;
                 }
 
                 path->addLine (CPoint (left + t * w, cy - sample * amp));
@@ -237,6 +269,73 @@ private:
     int waveType;
 };
 
+//------------------------------------------------------------------------
+// TextButton — momentary push button with a text label.
+// Fires valueChanged () with 1 on press; drawn like WaveformButton.
+//------------------------------------------------------------------------
+class TextButton : public CControl
+{
+public:
+    TextButton (const CRect& r, IControlListener* listener, int32_t tag, const char* title)
+        : CControl (r, listener, tag)
+        , title (title)
+    {
+    }
+
+    void draw (CDrawContext* context) override
+    {
+        WINESYNTH_TRACE_SCOPE ("TextButton::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kTextButtons);
+
+        context->setDrawMode (kAntiAliasing);
+        auto r = getViewSize ();
+
+        context->setFillColor (kButtonBg);
+        context->drawRect (r, kDrawFilled);
+        context->setFrameColor ((selected || getValue () > 0.5f) ? kActiveStroke : kButtonStroke);
+        context->setLineWidth (1.0);
+        context->drawRect (r, kDrawStroked);
+
+        context->setFont (kNormalFontSmall);
+        context->setFontColor (kLabelColor);
+        context->drawString (title, r, kCenterText);
+
+        setDirty (false);
+    }
+
+    CMouseEventResult onMouseDown (CPoint& where, const CButtonState& buttons) override
+    {
+        if (buttons.isLeftButton ())
+        {
+            beginEdit ();
+            setValue (1.f);
+            valueChanged ();
+            invalid ();
+            return kMouseEventHandled;
+        }
+        return kMouseEventNotHandled;
+    }
+
+    CMouseEventResult onMouseUp (CPoint& where, const CButtonState& buttons) override
+    {
+        setValue (0.f);
+        endEdit ();
+        invalid ();
+        return kMouseEventHandled;
+    }
+
+    // Latched highlight, e.g. for the selected entry of a button group
+    void setSelected (bool state)
+    {
+        if (selected != state) { selected = state; invalid (); }
+    }
+
+    CLASS_METHODS (TextButton, CControl)
+private:
+    const char* title;
+    bool selected = false;
+};
+
 //------------------------------------------------------------------------
 // WaveformDisplay — live waveform visualization
 //------------------------------------------------------------------------
@@ -265,8 +364,16 @@ public:
         if (resonance != val) { resonance = val; invalid (); }
     }
 
+    void setFilterMode (int mode)
+    {
+        if (filterMode != mode) { filterMode = mode; invalid (); }
+    }
+
     void draw (CDrawContext* context) override
     {
+        WINESYNTH_TRACE_SCOPE ("WaveformDisplay::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kWaveDisplay);
+
         context->setDrawMode (kAntiAliasing);
         auto r = getViewSize ();
 
@@ -283,15 +390,10 @@ public:
         context->setLineWidth (0.5);
         context->drawLine (CPoint (r.left + 5, cy), CPoint (r.right - 5, cy));
 
-        // SVF filter coefficients (same as processor, using 44100 as reference rate)
+        // Filter coefficients (same code as the processor, using 44100 as reference rate)
         double sampleRate = 44100.0;
-        double cutoffHz = 20.0 * pow (1000.0, (double)cutoff);
-        cutoffHz = std::min (cutoffHz, sampleRate * 0.49);
-        double g = tan (M_PI * cutoffHz / sampleRate);
-        double k = 2.0 - 2.0 * (double)resonance * 0.95;
-        double a1 = 1.0 / (1.0 + g * (g + k));
-        double a2 = g * a1;
-        double ic1eq = 0.0, ic2eq = 0.0;
+        FilterCoeffs coeffs = FilterCoeffs::make (toPlain (kCutoffId, cutoff), resonance, sampleRate);
+        FilterState filterState;
 
         // Generate raw waveform, then filter
         auto inset = 10.0;
@@ -324,6 +426,7 @@ public:
                     case kWaveSaw:     sample = 2.0 * tmod - 1.0; break;
                     case kWaveSquare:  sample = tmod < 0.5 ? 1.0 : -1.0; break;
                     case kWaveTriangle: sample = 4.0 * fabs (tmod - 0.5) - 1.0; break;
+                    case kWavePreviewAdditive: sample = additivePreview (phase); break;
                 }
 
                 path->addLine (CPoint (left + t * w, cy - sample * amp));
@@ -339,10 +442,7 @@ public:
             double phaseInc = 2.0 * M_PI * previewFreq / sampleRate;
             double ph = 0.0;
 
-            // Pre-run filter for 2 periods to settle
-            int settlesamples = (int)(sampleRate * 2.0 / previewFreq);
-            for (int i = 0; i < settlesamples; i++)
-            {
+            auto rawSample = [&] () {
                 double tph = ph / (2.0 * M_PI);
                 double raw = 0.0;
                 switch (waveType)
@@ -351,46 +451,34 @@ public:
                     case kWaveSaw:     raw = 2.0 * (tph - floor (tph)) - 1.0; break;
                     case kWaveSquare:  raw = (tph - floor (tph)) < 0.5 ? 1.0 : -1.0; break;
                     case kWaveTriangle: raw = 4.0 * fabs (tph - floor (tph) - 0.5) - 1.0; break;
+                    case kWavePreviewAdditive: raw = additivePreview (ph); break;
                 }
-                double hp = a1 * (raw - k * ic1eq - ic2eq);
-                double bp = a2 * (raw - k * ic1eq - ic2eq) + ic1eq;
-                double lp = a2 * ic1eq + ic2eq + g * hp;
-                ic1eq = 2.0 * bp - ic1eq;
-                ic2eq = 2.0 * lp - ic2eq;
                 ph += phaseInc;
                 if (ph >= 2.0 * M_PI) ph -= 2.0 * M_PI;
-            }
+                return raw;
+            };
 
-            // Pass 1: compute filtered samples and find peak
             double filteredBuf[401];
             double peak = 0.0;
-            for (int i = 0; i <= segs; i++)
-            {
-                double filtered = 0.0;
-                for (int j = 0; j < samplesPerSeg; j++)
+            dispatchFilter (filterMode, [&] (auto filter) {
+                using Filter = decltype (filter);
+
+                // Pre-run filter for 2 periods to settle
+                int settlesamples = (int)(sampleRate * 2.0 / previewFreq);
+                for (int i = 0; i < settlesamples; i++)
+                    Filter::process (filterState, coeffs, rawSample ());
+
+                // Pass 1: compute filtered samples and find peak
+                for (int i = 0; i <= segs; i++)
                 {
-                    double tph = ph / (2.0 * M_PI);
-                    double raw = 0.0;
-                    switch (waveType)
-                    {
-                        case kWaveSine:    raw = sin (ph); break;
-                        case kWaveSaw:     raw = 2.0 * (tph - floor (tph)) - 1.0; break;
-                        case kWaveSquare:  raw = (tph - floor (tph)) < 0.5 ? 1.0 : -1.0; break;
-                        case kWaveTriangle: raw = 4.0 * fabs (tph - floor (tph) - 0.5) - 1.0; break;
-                    }
-                    double hp = a1 * (raw - k * ic1eq - ic2eq);
-                    double bp = a2 * (raw - k * ic1eq - ic2eq) + ic1eq;
-                    double lp = a2 * ic1eq + ic2eq + g * hp;
-                    ic1eq = 2.0 * bp - ic1eq;
-                    ic2eq = 2.0 * lp - ic2eq;
-                    filtered = lp;
-                    ph += phaseInc;
-                    if (ph >= 2.0 * M_PI) ph -= 2.0 * M_PI;
+                    double filtered = 0.0;
+                    for (int j = 0; j < samplesPerSeg; j++)
+                        filtered = Filter::process (filterState, coeffs, rawSample ());
+                    filteredBuf[i] = filtered;
+                    if (fabs (filtered) > peak)
+                        peak = fabs (filtered);
                 }
-                filteredBuf[i] = filtered;
-                if (fabs (filtered) > peak)
-                    peak = fabs (filtered);
-            }
+            });
 
             // Pass 2: draw normalized
             double norm = (peak > 0.001) ? 1.0 / peak : 1.0;
@@ -415,6 +503,7 @@ public:
 
 private:
     int waveType = kWaveSine;
+    int filterMode = kFilterLowpass;
     float cutoff = 1.0f;
     float resonance = 0.0f;
 };
@@ -439,6 +528,7 @@ public:
         if (!timer)
         {
             timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) {
+                WINESYNTH_TRACE_SCOPE ("LiveOscilloscopeView::timer");
                 animPhase += 0.05;
                 invalid ();
             }, 16); // ~60 fps
@@ -458,6 +548,9 @@ public:
 
     void draw (CDrawContext* context) override
     {
+        WINESYNTH_TRACE_SCOPE ("LiveOscilloscopeView::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kOscilloscope);
+
         context->setDrawMode (kAntiAliasing);
         auto r = getViewSize ();
 
@@ -502,6 +595,9 @@ public:
                     case kWaveTriangle:
                         sample = 4.0 * fabs (fmod (phase / (2.0 * M_PI), 1.0) - 0.5) - 1.0;
                         break;
+                    case kWavePreviewAdditive:
+                        sample = additivePreview (phase);
+                        break;
                 }
 
                 // Modulation for visual interest
@@ -531,6 +627,308 @@ private:
     SharedPointer<CVSTGUITimer> timer;
 };
 
+//------------------------------------------------------------------------
+// SpectrumView — output spectrum of this instance, drawn from the polyline
+// a SpectrumAnalyzer publishes; nothing is analyzed on the GUI thread. The
+// timer invalidates only when a new frame is there, and its rate follows
+// the view's own paint cost, so drawing takes about kPaintBudget of the GUI
+// thread (at most one frame per kMinIntervalMs). While the view is hidden
+// the analyzer is paused and the processor stops feeding it.
+//------------------------------------------------------------------------
+class SpectrumView : public CView
+{
+public:
+    static constexpr int32_t kFftSize = 4096;
+    static constexpr int32_t kNumPoints = 192;
+    static constexpr uint32_t kMinIntervalMs = 16;
+    static constexpr uint32_t kMaxIntervalMs = 100;
+    static constexpr uint32_t kHiddenIntervalMs = 250;
+    static constexpr double kPaintBudget = 0.05;
+
+    SpectrumView (const CRect& size)
+        : CView (size) {}
+
+    ~SpectrumView () override
+    {
+        stop ();
+    }
+
+    // feed may be null (processor in another process): the view shows the grid
+    void start (std::shared_ptr<SpectrumFeed> feed)
+    {
+        stop ();
+        if (feed)
+            analyzer = std::make_unique<SpectrumAnalyzer> (std::move (feed), kFftSize, kNumPoints);
+        intervalMs = kMinIntervalMs;
+        timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) {
+            WINESYNTH_TRACE_SCOPE ("SpectrumView::timer");
+            update ();
+        }, intervalMs);
+    }
+
+    void stop ()
+    {
+        if (timer)
+        {
+            timer->stop ();
+            timer = nullptr;
+        }
+        analyzer = nullptr;
+    }
+
+    void draw (CDrawContext* context) override
+    {
+        WINESYNTH_TRACE_SCOPE ("SpectrumView::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kSpectrum);
+        const auto paintStart = std::chrono::steady_clock::now ();
+
+        context->setDrawMode (kAntiAliasing);
+        auto r = getViewSize ();
+
+        // Background
+        context->setFillColor (kDisplayBg);
+        context->drawRect (r, kDrawFilled);
+
+        CRect plot = r;
+        plot.inset (5, 5);
+        const SpectrumFrame* frame = analyzer ? &analyzer->read () : nullptr;
+        const bool hasFrame = frame && frame->numPoints > 1;
+        const double fMin = hasFrame ? frame->minFrequency : SpectrumAnalyzer::kMinFrequency;
+        const double fMax = hasFrame ? frame->maxFrequency : SpectrumAnalyzer::kMaxFrequency;
+
+        // Grid: decades and every 24 dB
+        context->setFrameColor (CColor (40, 60, 40, 255));
+        context->setLineWidth (0.5);
+        for (double f : {100.0, 1000.0, 10000.0})
+        {
+            if (f >= fMax)
+                continue;
+            CCoord x = plot.left + log (f / fMin) / log (fMax / fMin) * plot.getWidth ();
+            context->drawLine (CPoint (x, plot.top), CPoint (x, plot.bottom));
+        }
+        for (double db = -24.0; db > SpectrumAnalyzer::kFloorDb; db -= 24.0)
+        {
+            CCoord y = plot.top + db / SpectrumAnalyzer::kFloorDb * plot.getHeight ();
+            context->drawLine (CPoint (plot.left, y), CPoint (plot.right, y));
+        }
+
+        if (hasFrame)
+        {
+            if (auto path = owned (context->createGraphicsPath ()))
+            {
+                const CCoord w = plot.getWidth ();
+                const CCoord h = plot.getHeight ();
+                path->beginSubpath (CPoint (plot.left + frame->x[0] * w, plot.bottom - frame->y[0] * h));
+                for (int32_t i = 1; i < frame->numPoints; i++)
+                    path->addLine (CPoint (plot.left + frame->x[i] * w, plot.bottom - frame->y[i] * h));
+
+                context->setFrameColor (kWaveformColor);
+                context->setLineWidth (1.5);
+                context->drawGraphicsPath (path, CDrawContext::kPathStroked);
+            }
+            drawnSequence = frame->sequence;
+        }
+
+        // Frame border
+        context->setFrameColor (CColor (40, 50, 40, 255));
+        context->setLineWidth (1.0);
+        context->drawRect (r, kDrawStroked);
+
+        setDirty (false);
+
+        const double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - paintStart).count ();
+        paintMs += 0.2 * (ms - paintMs);
+    }
+
+    CLASS_METHODS (SpectrumView, CView)
+
+private:
+    void update ()
+    {
+        const bool visible = isVisible () && isAttached ();
+        if (analyzer)
+            analyzer->setRunning (visible);
+
+        uint32_t interval = kHiddenIntervalMs;
+        if (visible)
+        {
+            interval = (uint32_t)std::min<double> (kMaxIntervalMs, std::max<double> (kMinIntervalMs, paintMs / kPaintBudget));
+            if (analyzer)
+            {
+                analyzer->setInterval (interval * 0.001);
+                if (analyzer->read ().sequence != drawnSequence)
+                    invalid ();
+            }
+        }
+
+        // Retime only on real changes; paint times jitter
+        if (interval > intervalMs + 4 || interval + 4 < intervalMs || interval == kHiddenIntervalMs
+            || intervalMs == kHiddenIntervalMs)
+        {
+            if (interval != intervalMs)
+            {
+                intervalMs = interval;
+                timer->setFireTime (interval);
+            }
+        }
+    }
+
+    std::unique_ptr<SpectrumAnalyzer> analyzer;
+    SharedPointer<CVSTGUITimer> timer;
+    uint32_t intervalMs = kMinIntervalMs;
+    uint32_t drawnSequence = 0;
+    double paintMs = 0.0;
+};
+
+//------------------------------------------------------------------------
+// LevelMeterView — output level of this instance, one bar per channel from
+// kMinDb to kMaxDb: RMS bright, peak dim behind it, and a peak hold line
+// that stays for kHoldSeconds (red once the output went over 0 dBFS).
+// The levels come from the instance's row of the statistics table, so the
+// view costs the audio thread nothing; it repaints only when a bar moved.
+//------------------------------------------------------------------------
+class LevelMeterView : public CView
+{
+public:
+    static constexpr int32_t kNumChannels = InstanceStats::kNumLevels;
+    static constexpr double kMinDb = -60.0;
+    static constexpr double kMaxDb = 6.0;
+    static constexpr double kHoldSeconds = 1.5;
+    static constexpr uint32_t kIntervalMs = 33;
+
+    LevelMeterView (const CRect& size)
+        : CView (size)
+        , table (StatsRegistry::acquire ())
+    {}
+
+    ~LevelMeterView () override
+    {
+        stop ();
+        StatsRegistry::release ();
+    }
+
+    void start (uint32_t id)
+    {
+        instanceId = id;
+        if (!timer)
+        {
+            timer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) {
+                WINESYNTH_TRACE_SCOPE ("LevelMeterView::timer");
+                update ();
+            }, kIntervalMs);
+        }
+    }
+
+    void stop ()
+    {
+        if (timer)
+        {
+            timer->stop ();
+            timer = nullptr;
+        }
+    }
+
+    void draw (CDrawContext* context) override
+    {
+        WINESYNTH_TRACE_SCOPE ("LevelMeterView::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kMeter);
+
+        auto r = getViewSize ();
+        context->setFillColor (kDisplayBg);
+        context->drawRect (r, kDrawFilled);
+
+        CRect area = r;
+        area.inset (3, 3);
+        const CCoord gap = 2;
+        const CCoord barWidth = (area.getWidth () - gap * (kNumChannels - 1)) / kNumChannels;
+        auto yAt = [&] (double position) { return area.bottom - position * area.getHeight (); };
+
+        for (int32_t c = 0; c < kNumChannels; c++)
+        {
+            const CCoord left = area.left + c * (barWidth + gap);
+            context->setFillColor (CColor (40, 110, 40, 255));
+            context->drawRect (CRect (left, yAt (shown[c].peak), left + barWidth, area.bottom), kDrawFilled);
+            context->setFillColor (kWaveformColor);
+            context->drawRect (CRect (left, yAt (shown[c].rms), left + barWidth, area.bottom), kDrawFilled);
+
+            if (shown[c].hold > 0.0)
+            {
+                const CCoord y = yAt (shown[c].hold);
+                context->setFillColor (shown[c].clipped ? CColor (230, 60, 50, 255) : CColor (230, 230, 230, 255));
+                context->drawRect (CRect (left, y, left + barWidth, y + 2), kDrawFilled);
+            }
+        }
+
+        // 0 dBFS mark
+        context->setFrameColor (CColor (120, 120, 120, 255));
+        context->setLineWidth (1.0);
+        const CCoord zero = yAt (toPosition (1.f));
+        context->drawLine (CPoint (r.left, zero), CPoint (r.right, zero));
+
+        context->setFrameColor (CColor (40, 50, 40, 255));
+        context->drawRect (r, kDrawStroked);
+
+        setDirty (false);
+    }
+
+    CLASS_METHODS (LevelMeterView, CView)
+
+private:
+    struct Bar
+    {
+        double peak = 0.0;          // 0..1 of the bar height
+        double rms = 0.0;
+        double hold = 0.0;
+        bool clipped = false;
+        std::chrono::steady_clock::time_point holdTime;
+    };
+
+    static double toPosition (float level)
+    {
+        const double db = 20.0 * log10 (std::max (level, 1e-6f));
+        return std::min (1.0, std::max (0.0, (db - kMinDb) / (kMaxDb - kMinDb)));
+    }
+
+    void update ()
+    {
+        InstanceStats s;
+        if (!readInstanceStats (*table, instanceId, s))
+            s = InstanceStats ();
+
+        const auto now = std::chrono::steady_clock::now ();
+        const double pixel = 1.0 / std::max<CCoord> (1, getViewSize ().getHeight ());
+        bool changed = false;
+        for (int32_t c = 0; c < kNumChannels; c++)
+        {
+            Bar& bar = shown[c];
+            const double peak = toPosition (s.levelPeak[c]);
+            const double rms = toPosition (s.levelRms[c]);
+            if (fabs (peak - bar.peak) >= pixel || fabs (rms - bar.rms) >= pixel)
+            {
+                bar.peak = peak;
+                bar.rms = rms;
+                changed = true;
+            }
+
+            if (peak >= bar.hold || now - bar.holdTime > std::chrono::duration<double> (kHoldSeconds))
+            {
+                const bool clipped = s.levelPeak[c] > 1.f;
+                changed |= fabs (peak - bar.hold) >= pixel || clipped != bar.clipped;
+                bar.hold = peak;
+                bar.clipped = clipped;
+                bar.holdTime = now;
+            }
+        }
+        if (changed)
+            invalid ();
+    }
+
+    StatsTable* table;
+    uint32_t instanceId = 0;
+    Bar shown[kNumChannels];
+    SharedPointer<CVSTGUITimer> timer;
+};
+
 //------------------------------------------------------------------------
 // PianoKeyboardView — one-octave piano keyboard (C4–B4)
 // Uses pre-rendered BITMAPS for normal/highlight states (simulates Serum2)
@@ -571,6 +969,9 @@ public:
 
     void draw (CDrawContext* context) override
     {
+        WINESYNTH_TRACE_SCOPE ("PianoKeyboardView::draw");
+        PaintProfiler::Scope paintScope (this, PaintProfiler::kKeyboard);
+
         // Lazy-init: create key bitmaps on first draw
         if (!bitmapsCreated)
             createKeyBitmaps (context);
@@ -763,4 +1164,105 @@ private:
     }
 };
 
+//------------------------------------------------------------------------
+// InstanceListOverlay — every WineSynth instance in the process (see
+// instancestats.h), highest load first; this editor's own instance is
+// marked. Hidden by default, ignores the mouse; refresh () is polled by
+// the editor's display timer and reads the table only while visible.
+//------------------------------------------------------------------------
+class InstanceListOverlay : public CView
+{
+public:
+    static constexpr CCoord kLineHeight = 14;
+    static constexpr int32_t kMaxRows = 16;
+    static constexpr CCoord kHeight = (kMaxRows + 3) * kLineHeight + 8;
+    static constexpr double kRefreshSeconds = 0.25;
+
+    InstanceListOverlay (const CRect& size)
+        : CView (size)
+        , table (StatsRegistry::acquire ())
+    {
+        setMouseEnabled (false);
+        setVisible (false);
+    }
+
+    ~InstanceListOverlay () override { StatsRegistry::release (); }
+
+    void setOwnId (uint32_t id) { ownId = id; }
+
+    void refresh ()
+    {
+        if (!isVisible ())
+            return;
+
+        auto now = std::chrono::steady_clock::now ();
+        if (now - lastRefresh < std::chrono::duration<double> (kRefreshSeconds))
+            return;
+        lastRefresh = now;
+
+        numRows = readInstanceStats (*table, rows, StatsTable::kMaxInstances);
+        std::sort (rows, rows + numRows, [] (const InstanceStats& a, const InstanceStats& b) {
+            return a.load != b.load ? a.load > b.load : a.instanceId < b.instanceId;
+        });
+        invalid ();
+    }
+
+    void draw (CDrawContext* context) override
+    {
+        auto r = getViewSize ();
+        context->setFillColor (CColor (0, 0, 0, 210));
+        context->drawRect (r, kDrawFilled);
+        context->setFont (kNormalFontSmall);
+
+        char line[160];
+        CRect row (r.left + 6, r.top + 4, r.right - 6, r.top + 4 + kLineHeight);
+        auto drawLine = [&] (const CColor& color) {
+            context->setFontColor (color);
+            context->drawString (line, row, kLeftText);
+            row.offset (0, kLineHeight);
+        };
+        const CColor headerColor (255, 220, 100, 255);
+
+        double total = 0.0;
+        uint32_t totalVoices = 0;
+        for (int32_t i = 0; i < numRows; i++)
+        {
+            total += rows[i].load;
+            totalVoices += rows[i].voices;
+        }
+        snprintf (line, sizeof (line), "%d instances   load %.1f%% in total   %u voices",
+                  numRows, total * 100.0, totalVoices);
+        drawLine (headerColor);
+        snprintf (line, sizeof (line), "  %-4s %-18s %7s %7s %8s %6s %8s", "id", "track", "load", "peak",
+                  "block us", "voices", "mem KiB");
+        drawLine (headerColor);
+
+        for (int32_t i = 0; i < numRows && i < kMaxRows; i++)
+        {
+            const InstanceStats& s = rows[i];
+            const bool own = s.instanceId == ownId;
+            snprintf (line, sizeof (line), "%c #%-3u %-18.18s %6.1f%% %6.1f%% %8.0f %6u %8u%s%s", own ? '>' : ' ',
+                      s.instanceId, s.name, s.load * 100.0, s.peakLoad * 100.0, s.blockMicros, s.voices, s.memoryKiB,
+                      s.idle ? "  idle" : "", s.qualityLevel > 0 ? "  governed" : "");
+            drawLine (own ? kWaveformColor : kLabelColor);
+        }
+        if (numRows > kMaxRows)
+        {
+            snprintf (line, sizeof (line), "  ... %d more", numRows - kMaxRows);
+            drawLine (kLabelColor);
+        }
+
+        setDirty (false);
+    }
+
+    CLASS_METHODS (InstanceListOverlay, CView)
+
+private:
+    StatsTable* table;
+    uint32_t ownId = 0;
+    InstanceStats rows[StatsTable::kMaxInstances];
+    int32_t numRows = 0;
+    std::chrono::steady_clock::time_point lastRefresh {};
+};
+
 } // namespace WineSynth
@@ -1,12 +1,17 @@
 #include "editor.h"
+#include "controller.h"
 #include "pluginparamids.h"
 #include "controls.h"
+#include "trace.h"
 
 #include "vstgui/lib/cframe.h"
 #include "vstgui/lib/controls/ctextlabel.h"
 #include "vstgui/lib/cvstguitimer.h"
+#include "vstgui/lib/cfileselector.h"
 #include "vstgui/lib/platform/platformfactory.h"
-#include "vstgui/lib/platform/win32/win32factory.h"
+
+#include <fstream>
+#include <sstream>
 
 using namespace VSTGUI;
 
@@ -26,7 +31,7 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
     // for proper partial redraws.
 
     CRect frameSize (0, 0, kEditorWidth, kEditorHeight);
-    frame = new CFrame (frameSize, this);
+    frame = new ProfiledFrame (frameSize, this);
     frame->setBackgroundColor (kBgColor);
 
     // --- Title ---
@@ -46,6 +51,21 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
     versionLabel->setHoriAlign (kRightText);
     frame->addView (versionLabel);
 
+    // CPU governor status, empty at full quality
+    qualityLabel = new CTextLabel (CRect (240, 8, 510, 28));
+    qualityLabel->setFontColor (CColor (230, 160, 60, 255));
+    qualityLabel->setBackColor (kBgColor);
+    qualityLabel->setFrameColor (kBgColor);
+    qualityLabel->setHoriAlign (kRightText);
+    frame->addView (qualityLabel);
+    shownQualityLevel = -1;
+
+    // Double-clicking the version label toggles the paint profiler overlay
+    frame->addView (new HiddenButton (versionLabel->getViewSize (), this, kProfilerTag));
+
+    // Double-clicking the title lists all instances in the process by load
+    frame->addView (new HiddenButton (titleLabel->getViewSize (), this, kInstancesTag));
+
     // --- Knob Row: Gain, Frequency, Fine ---
     auto makeLabel = [&](CCoord x, CCoord y, CCoord w, const char* text) {
         auto label = new CTextLabel (CRect (x, y, x + w, y + 16));
@@ -77,15 +97,21 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
     auto fineKnob = new SynthKnobView (CRect (325, 56, 395, 126), this, kFineId, 0.5f);
     frame->addView (fineKnob);
 
+    // --- Tuning: Scala scale (+ optional .kbm next to it) ---
+    makeLabel (440, 38, 150, "Tuning");
+    frame->addView (new TextButton (CRect (450, 60, 580, 84), this, kLoadScaleTag, "Load Scale..."));
+    frame->addView (new TextButton (CRect (450, 94, 580, 118), this, kResetTuningTag, "12-TET"));
+    frame->addView (new TextButton (CRect (450, 124, 580, 148), this, kLoadImpulseTag, "Reverb IR..."));
+
     // --- Waveform Selector ---
     makeLabel (20, 140, 120, "Waveform");
     CCoord btnX = 20;
     CCoord btnY = 158;
-    CCoord btnW = 55;
+    CCoord btnW = 45;
     CCoord btnH = 35;
     CCoord btnGap = 5;
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < kNumWavePreviews; i++)
     {
         waveButtons[i] = new WaveformButton (
             CRect (btnX + i * (btnW + btnGap), btnY, btnX + i * (btnW + btnGap) + btnW, btnY + btnH),
@@ -94,26 +120,49 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
     }
 
     // Waveform labels
-    const char* waveNames[] = {"Sin", "Saw", "Sqr", "Tri"};
-    for (int i = 0; i < 4; i++)
+    const char* waveNames[kNumWavePreviews] = {"Sin", "Saw", "Sqr", "Tri", "Add"};
+    for (int i = 0; i < kNumWavePreviews; i++)
         makeLabel (btnX + i * (btnW + btnGap), btnY + btnH + 2, btnW, waveNames[i]);
 
+    // --- Filter mode selector ---
+    makeLabel (280, 140, 120, "Filter");
+    const char* filterNames[kNumFilterModes] = {"LP", "BP", "HP", "Notch", "Peak", "Ladder"};
+    for (int i = 0; i < kNumFilterModes; i++)
+    {
+        CCoord x = 280 + i * 52;
+        filterButtons[i] = new TextButton (CRect (x, btnY, x + 48, btnY + btnH), this,
+                                           kFilterBtnTagBase + i, filterNames[i]);
+        frame->addView (filterButtons[i]);
+    }
+
     // --- Waveform Display ---
     waveDisplay = new WaveformDisplay (CRect (20, 210, 600, 310));
     frame->addView (waveDisplay);
 
-    // --- Envelope: Attack & Release ---
-    makeLabel (30, 325, 80, "Attack");
-    auto attackKnob = new SynthKnobView (CRect (40, 343, 110, 413), this, kAttackId, 0.05f);
+    // --- Envelope: Attack, Hold, Decay, Sustain, Release ---
+    makeLabel (15, 325, 80, "Attack");
+    auto attackKnob = new SynthKnobView (CRect (25, 343, 95, 413), this, kAttackId, 0.05f);
     frame->addView (attackKnob);
 
-    makeLabel (150, 325, 80, "Release");
-    auto releaseKnob = new SynthKnobView (CRect (160, 343, 230, 413), this, kReleaseId, 0.3f);
+    makeLabel (115, 325, 80, "Hold");
+    auto holdKnob = new SynthKnobView (CRect (125, 343, 195, 413), this, kHoldId, 0.0f);
+    frame->addView (holdKnob);
+
+    makeLabel (215, 325, 80, "Decay");
+    auto decayKnob = new SynthKnobView (CRect (225, 343, 295, 413), this, kDecayId, 0.3f);
+    frame->addView (decayKnob);
+
+    makeLabel (315, 325, 80, "Sustain");
+    auto sustainKnob = new SynthKnobView (CRect (325, 343, 395, 413), this, kSustainId, 1.0f);
+    frame->addView (sustainKnob);
+
+    makeLabel (415, 325, 80, "Release");
+    auto releaseKnob = new SynthKnobView (CRect (425, 343, 495, 413), this, kReleaseId, 0.3f);
     frame->addView (releaseKnob);
 
     // Envelope label
-    auto envLabel = new CTextLabel (CRect (250, 370, 400, 390));
-    envLabel->setText ("AR Envelope");
+    auto envLabel = new CTextLabel (CRect (510, 370, 600, 390));
+    envLabel->setText ("AHDSR Env");
     envLabel->setFontColor (CColor (80, 80, 80, 255));
     envLabel->setBackColor (kBgColor);
     envLabel->setFrameColor (kBgColor);
@@ -122,38 +171,64 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
 
     // --- Live Oscilloscope ---
     makeLabel (20, 425, 160, "Live Oscilloscope");
-    liveScope = new LiveOscilloscopeView (CRect (20, 443, 600, 523));
+    liveScope = new LiveOscilloscopeView (CRect (20, 443, 305, 523));
     frame->addView (liveScope);
 
+    // --- Spectrum of this instance's output ---
+    makeLabel (315, 425, 100, "Spectrum");
+    spectrumView = new SpectrumView (CRect (315, 443, 560, 523));
+    frame->addView (spectrumView);
+
+    // --- Output level ---
+    makeLabel (560, 425, 50, "Level");
+    levelMeter = new LevelMeterView (CRect (570, 443, 600, 523));
+    frame->addView (levelMeter);
+
     // --- Piano Keyboard (one octave C4-B4) ---
     makeLabel (20, 535, 100, "Keyboard");
     keyboard = new PianoKeyboardView (CRect (20, 553, 600, 650), this, kKeyboardTag);
     frame->addView (keyboard);
 
-    frame->open (parent, platformType);
+    // Diagnostics overlay, topmost (see paintprofiler.h)
+    profilerOverlay = new PaintProfilerOverlay (
+        CRect (20, 210, 440, 210 + PaintProfilerOverlay::kHeight));
+    frame->addView (profilerOverlay);
+    instanceList = new InstanceListOverlay (
+        CRect (20, 36, 600, 36 + InstanceListOverlay::kHeight));
+    frame->addView (instanceList);
 
-    // Fix 2: Subclass parent HWND to suppress WM_ERASEBKGND (white flash on Wine).
-    // Reaper's FX panel has a white background brush that shows through before
-    // VSTGUI's child window completes its first D2D1 paint.
-    parentHwnd_ = (HWND)parent;
-    origParentWndProc_ = (WNDPROC)GetWindowLongPtrA (parentHwnd_, GWLP_WNDPROC);
-    SetPropA (parentHwnd_, "WineSynthEditor", (HANDLE)this);
-    SetWindowLongPtrA (parentHwnd_, GWLP_WNDPROC, (LONG_PTR)parentSubclassProc);
+    if (controller)
+        showFilterMode ((int)toPlain (kFilterModeId, controller->getParamNormalized (kFilterModeId)));
+
+    frame->open (parent, platformType);
 
-    // Under Wine, the initial WM_PAINT arrives before D2D1 is fully
-    // initialized, leaving framebuffer garbage visible. Schedule a
-    // delayed full redraw to ensure proper rendering.
-    CFrame* f = frame;
-    Call::later ([f] () { f->invalid (); }, 100);
+    hostWindowFixes.attach (parent, frame);
 
     // Start live oscilloscope animation
     if (liveScope)
         liveScope->start ();
 
+    // The processor's spectrum feed and levels, found by its instance ID
+    auto* ctrl = dynamic_cast<Controller*> (controller);
+    const uint32_t instanceId = ctrl ? ctrl->getInstanceId () : 0;
+    if (spectrumView)
+        spectrumView->start (SpectrumFeed::get (instanceId));
+    if (levelMeter)
+        levelMeter->start (instanceId);
+
     // Timer for deferred waveform display + MIDI keyboard highlight (~15 fps)
     displayTimer = makeOwned<CVSTGUITimer> ([this] (CVSTGUITimer*) {
+        WINESYNTH_TRACE_SCOPE ("Editor::displayTimer");
         flushDisplayUpdate ();
 
+        if (profilerOverlay)
+            profilerOverlay->refresh ();
+        if (instanceList)
+            instanceList->refresh ();
+
+        if (controller)
+            showQualityLevel ((int32_t)toPlain (kQualityLevelId, controller->getParamNormalized (kQualityLevelId)));
+
         // Poll keyboard note parameter for MIDI highlight feedback
         if (keyboard && controller)
         {
@@ -169,29 +244,10 @@ bool PLUGIN_API Editor::open (void* parent, const PlatformType& platformType)
     return true;
 }
 
-LRESULT CALLBACK Editor::parentSubclassProc (HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
-{
-    auto* editor = (Editor*)GetPropA (hwnd, "WineSynthEditor");
-
-    if (msg == WM_ERASEBKGND)
-        return 1;
-
-    if (editor && editor->origParentWndProc_)
-        return CallWindowProcA (editor->origParentWndProc_, hwnd, msg, wParam, lParam);
-
-    return DefWindowProcA (hwnd, msg, wParam, lParam);
-}
-
 void PLUGIN_API Editor::close ()
 {
-    // Restore original WndProc before tearing down the frame
-    if (parentHwnd_ && origParentWndProc_)
-    {
-        SetWindowLongPtrA (parentHwnd_, GWLP_WNDPROC, (LONG_PTR)origParentWndProc_);
-        RemovePropA (parentHwnd_, "WineSynthEditor");
-        parentHwnd_ = nullptr;
-        origParentWndProc_ = nullptr;
-    }
+    // Restore the host window before tearing down the frame
+    hostWindowFixes.detach ();
 
     if (displayTimer)
     {
@@ -205,9 +261,26 @@ void PLUGIN_API Editor::close ()
         liveScope = nullptr;
     }
 
+    if (spectrumView)
+    {
+        spectrumView->stop ();
+        spectrumView = nullptr;
+    }
+
+    if (levelMeter)
+    {
+        levelMeter->stop ();
+        levelMeter = nullptr;
+    }
+
     waveDisplay = nullptr;
-    for (int i = 0; i < 4; i++)
-        waveButtons[i] = nullptr;
+    profilerOverlay = nullptr;
+    instanceList = nullptr;
+    qualityLabel = nullptr;
+    for (auto& button : waveButtons)
+        button = nullptr;
+    for (auto& button : filterButtons)
+        button = nullptr;
 
     if (frame)
     {
@@ -218,6 +291,8 @@ void PLUGIN_API Editor::close ()
 
 void Editor::flushDisplayUpdate ()
 {
+    WINESYNTH_TRACE_SCOPE ("Editor::flushDisplayUpdate");
+
     if (displayDirty && waveDisplay)
     {
         waveDisplay->setCutoff (pendingCutoff);
@@ -226,21 +301,102 @@ void Editor::flushDisplayUpdate ()
     }
 }
 
-void Editor::valueChanged (CControl* pControl)
+void Editor::showQualityLevel (int32_t level)
 {
-    if (!controller)
+    if (!qualityLabel || level == shownQualityLevel)
+        return;
+    shownQualityLevel = level;
+
+    static const char* const texts[kNumQualityLevels] = {
+        "", "CPU: cheap oscillators", "CPU: half voices", "CPU: quarter voices"};
+    qualityLabel->setText (level > kQualityFull && level < kNumQualityLevels ? texts[level] : "");
+}
+
+void Editor::toggleProfiler ()
+{
+    if (!profilerOverlay || !frame)
         return;
 
+    auto& profiler = static_cast<ProfiledFrame*> (frame)->getProfiler ();
+    bool show = !profilerOverlay->isVisible ();
+    if (show && instanceList && instanceList->isVisible ())
+        toggleInstanceList ();
+    profiler.setEnabled (show);
+    profilerOverlay->setVisible (show);
+    frame->invalid ();
+}
+
+// The instance list and the paint profiler overlap; only one is shown
+void Editor::toggleInstanceList ()
+{
+    if (!instanceList || !frame)
+        return;
+
+    bool show = !instanceList->isVisible ();
+    if (show && profilerOverlay && profilerOverlay->isVisible ())
+        toggleProfiler ();
+    if (auto* ctrl = dynamic_cast<Controller*> (controller))
+        instanceList->setOwnId (ctrl->getInstanceId ());
+    instanceList->setVisible (show);
+    instanceList->refresh ();
+    frame->invalid ();
+}
+
+void Editor::valueChanged (CControl* pControl)
+{
+    WINESYNTH_TRACE_SCOPE ("Editor::valueChanged");
+
     int32_t tag = pControl->getTag ();
+    if (tag == kProfilerTag)
+    {
+        toggleProfiler ();
+        return;
+    }
+
+    if (tag == kInstancesTag)
+    {
+        toggleInstanceList ();
+        return;
+    }
+
+    if (!controller)
+        return;
 
     // Waveform buttons have internal tags kWaveBtnTagBase + waveType
-    if (tag >= kWaveBtnTagBase && tag < kWaveBtnTagBase + kNumWaveforms)
+    if (tag >= kWaveBtnTagBase && tag < kWaveBtnTagBase + kNumWavePreviews)
     {
         int waveType = tag - kWaveBtnTagBase;
         selectWaveform (waveType);
         return;
     }
 
+    if (tag >= kFilterBtnTagBase && tag < kFilterBtnTagBase + kNumFilterModes)
+    {
+        if (pControl->getValue () > 0.5f)
+            selectFilterMode (tag - kFilterBtnTagBase);
+        return;
+    }
+
+    // Tuning buttons act on press
+    if (tag == kLoadScaleTag || tag == kResetTuningTag)
+    {
+        if (pControl->getValue () > 0.5f)
+        {
+            if (tag == kLoadScaleTag)
+                selectScaleFile ();
+            else if (auto* ctrl = dynamic_cast<Controller*> (controller))
+                ctrl->loadTuning ({}, {});
+        }
+        return;
+    }
+
+    if (tag == kLoadImpulseTag)
+    {
+        if (pControl->getValue () > 0.5f)
+            selectImpulseFile ();
+        return;
+    }
+
     // GUI keyboard: send note parameter
     if (tag == kKeyboardTag)
     {
@@ -266,6 +422,90 @@ void Editor::valueChanged (CControl* pControl)
     }
 }
 
+void Editor::showFilterMode (int mode)
+{
+    for (int i = 0; i < kNumFilterModes; i++)
+    {
+        if (filterButtons[i])
+            filterButtons[i]->setSelected (i == mode);
+    }
+    if (waveDisplay)
+        waveDisplay->setFilterMode (mode);
+}
+
+void Editor::selectFilterMode (int mode)
+{
+    showFilterMode (mode);
+
+    if (controller)
+    {
+        float normValue = (float)mode / (float)(kNumFilterModes - 1);
+        controller->setParamNormalized (kFilterModeId, normValue);
+        controller->performEdit (kFilterModeId, normValue);
+    }
+}
+
+void Editor::selectScaleFile ()
+{
+    auto* selector = CNewFileSelector::create (frame, CNewFileSelector::kSelectFile);
+    if (!selector)
+        return;
+
+    selector->setTitle ("Load Scala Scale");
+    selector->addFileExtension (CFileExtension ("Scala scale", "scl"));
+    selector->run ([this] (CNewFileSelector* sel) {
+        if (sel->getNumSelectedFiles () > 0)
+            loadScaleFile (sel->getSelectedFile (0));
+    });
+    selector->forget ();
+}
+
+// Reads the .scl file and, if present, a .kbm with the same base name,
+// then hands both to the controller. Parsing happens off the audio thread
+// in Processor::notify ().
+void Editor::loadScaleFile (const std::string& sclPath)
+{
+    auto readFile = [] (const std::string& path, std::string& text) {
+        std::ifstream file (path, std::ios::binary);
+        if (!file)
+            return false;
+        std::ostringstream buffer;
+        buffer << file.rdbuf ();
+        text = buffer.str ();
+        return true;
+    };
+
+    std::string scl, kbm;
+    if (!readFile (sclPath, scl))
+        return;
+
+    auto dot = sclPath.find_last_of ('.');
+    if (dot != std::string::npos)
+        readFile (sclPath.substr (0, dot) + ".kbm", kbm);
+
+    if (auto* ctrl = dynamic_cast<Controller*> (controller))
+        ctrl->loadTuning (scl, kbm);
+}
+
+// The processor reads and resamples the file on its loader thread
+void Editor::selectImpulseFile ()
+{
+    auto* selector = CNewFileSelector::create (frame, CNewFileSelector::kSelectFile);
+    if (!selector)
+        return;
+
+    selector->setTitle ("Load Reverb Impulse");
+    selector->addFileExtension (CFileExtension ("WAVE audio", "wav"));
+    selector->run ([this] (CNewFileSelector* sel) {
+        if (sel->getNumSelectedFiles () > 0)
+        {
+            if (auto* ctrl = dynamic_cast<Controller*> (controller))
+                ctrl->loadImpulse (sel->getSelectedFile (0));
+        }
+    });
+    selector->forget ();
+}
+
 void Editor::selectWaveform (int waveType)
 {
     if (waveDisplay)
@@ -275,9 +515,18 @@ void Editor::selectWaveform (int waveType)
 
     if (controller)
     {
-        float normValue = (float)waveType / (float)(kNumWaveforms - 1);
-        controller->setParamNormalized (kWaveformId, normValue);
-        controller->performEdit (kWaveformId, normValue);
+        // The additive button only switches the mode; the waveform stays
+        // for when the classic oscillator comes back
+        const bool additive = waveType == kWavePreviewAdditive;
+        float modeValue = additive ? 1.f : 0.f;
+        controller->setParamNormalized (kOscModeId, modeValue);
+        controller->performEdit (kOscModeId, modeValue);
+        if (!additive)
+        {
+            float normValue = (float)waveType / (float)(kNumWaveforms - 1);
+            controller->setParamNormalized (kWaveformId, normValue);
+            controller->performEdit (kWaveformId, normValue);
+        }
     }
 }
 
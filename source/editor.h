@@ -2,18 +2,25 @@
 
 #include "public.sdk/source/vst/vstguieditor.h"
 #include "vstgui/lib/controls/icontrollistener.h"
+#include "pluginparamids.h"
+#include "filter.h"
+#include "platform.h"
 
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#include <windows.h>
+#include <string>
+
+namespace VSTGUI { class CTextLabel; }
 
 namespace WineSynth {
 
 class WaveformButton;
 class WaveformDisplay;
 class LiveOscilloscopeView;
+class SpectrumView;
+class LevelMeterView;
 class PianoKeyboardView;
+class TextButton;
+class PaintProfilerOverlay;
+class InstanceListOverlay;
 
 class Editor : public Steinberg::Vst::VSTGUIEditor, public VSTGUI::IControlListener
 {
@@ -28,22 +35,33 @@ public:
 
 private:
     void selectWaveform (int waveType);
+    void selectFilterMode (int mode);
+    void showFilterMode (int mode);
     void flushDisplayUpdate ();
-
-    // WM_ERASEBKGND subclass for parent HWND (Wine white-on-open fix)
-    static LRESULT CALLBACK parentSubclassProc (HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+    void selectScaleFile ();
+    void loadScaleFile (const std::string& sclPath);
+    void selectImpulseFile ();
+    void toggleProfiler ();
+    void toggleInstanceList ();
+    void showQualityLevel (int32_t level);
 
     static const int kEditorWidth = 620;
     static const int kEditorHeight = 670;
 
-    WaveformButton* waveButtons[4] = {};
+    WaveformButton* waveButtons[kNumWaveforms + 1] = {};   // the waveforms, then additive mode
+    TextButton* filterButtons[kNumFilterModes] = {};
     WaveformDisplay* waveDisplay = nullptr;
     LiveOscilloscopeView* liveScope = nullptr;
+    SpectrumView* spectrumView = nullptr;
+    LevelMeterView* levelMeter = nullptr;
     PianoKeyboardView* keyboard = nullptr;
+    PaintProfilerOverlay* profilerOverlay = nullptr;
+    InstanceListOverlay* instanceList = nullptr;
+    VSTGUI::CTextLabel* qualityLabel = nullptr;
+    int32_t shownQualityLevel = -1;
 
-    // Parent HWND subclass state
-    HWND parentHwnd_ = nullptr;
-    WNDPROC origParentWndProc_ = nullptr;
+    // Host window workarounds (Wine / Win32 only)
+    HostWindowFixes hostWindowFixes;
 
     // Deferred display update (avoid redraw conflicts while dragging knobs)
     float pendingCutoff = 1.0f;
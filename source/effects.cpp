@@ -0,0 +1,307 @@
+#include "effects.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace WineSynth {
+
+namespace {
+
+int32_t nextPowerOfTwo (int32_t n)
+{
+    int32_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+// Triangle shaped into a near-sine (cubic), phase t in 0..1. Branch free so
+// the modulation loop vectorizes.
+inline float lfoShape (float t)
+{
+    float tri = 1.f - 4.f * fabsf (t - 0.5f);
+    return tri * (1.5f - 0.5f * tri * tri);
+}
+
+// The chorus writes a whole block before reading it, so its line holds the
+// longest modulated delay plus one block. The delay reads before writing in
+// chunks no longer than the delay time.
+int32_t chorusLineSize (double sampleRate, int32_t blockSize)
+{
+    const double maxMs = EffectsBus::kChorusBaseMs + EffectsBus::kChorusMaxDepthMs;
+    return nextPowerOfTwo ((int32_t)ceil (maxMs * 0.001 * sampleRate) + 2 + blockSize);
+}
+
+int32_t delayLineSize (double sampleRate)
+{
+    return nextPowerOfTwo ((int32_t)(EffectsBus::kMaxDelaySeconds * sampleRate) + 1);
+}
+
+} // namespace
+
+void DelayLine::clear ()
+{
+    if (data)
+        memset (data, 0, size () * sizeof (float));
+    writePos = 0;
+}
+
+size_t EffectsBus::getArenaBytes (double rate, int32_t maxBlockSize)
+{
+    const int32_t block = std::max<int32_t> (maxBlockSize, 1);
+    return Arena::bytesFor<float> (chorusLineSize (rate, block))
+         + 2 * Arena::bytesFor<float> (delayLineSize (rate))
+         + 4 * Arena::bytesFor<float> (block);
+}
+
+void EffectsBus::prepare (Arena& arena, double rate, int32_t maxBlockSize)
+{
+    sampleRate = rate;
+    blockSize = std::max<int32_t> (maxBlockSize, 1);
+
+    const int32_t chorusSize = chorusLineSize (sampleRate, blockSize);
+    const int32_t delaySize = delayLineSize (sampleRate);
+    auto take = [&arena] (int32_t count) { return arena.allocate<float> (count); };
+
+    chorusLine.data = take (chorusSize);
+    chorusLine.mask = chorusSize - 1;
+    delayLeft.data = take (delaySize);
+    delayLeft.mask = delaySize - 1;
+    delayRight.data = take (delaySize);
+    delayRight.mask = delaySize - 1;
+    modLeft = take (blockSize);
+    modRight = take (blockSize);
+    tapLeft = take (blockSize);
+    tapRight = take (blockSize);
+
+    delayFadeLength = std::max<int32_t> (1, (int32_t)(kDelayFadeMs * 0.001 * sampleRate));
+    updateDelayTime ();
+    reset ();
+}
+
+void EffectsBus::reset ()
+{
+    chorusLine.clear ();
+    delayLeft.clear ();
+    delayRight.clear ();
+    chorusPhase = 0.0;
+    delayFadeFrom = delaySamples;
+    tailLeft = 0;
+}
+
+void EffectsBus::setChorus (double mix, double rateHz, double depth)
+{
+    chorusMix = (float)mix;
+    chorusInc = rateHz / sampleRate;
+    chorusBase = (float)(kChorusBaseMs * 0.001 * sampleRate);
+    chorusDepth = (float)(depth * kChorusMaxDepthMs * 0.001 * sampleRate);
+    updateTailLength ();
+}
+
+void EffectsBus::setDelay (double mix, int32_t division, double feedback)
+{
+    delayMix = (float)mix;
+    delayFeedback = (float)feedback;
+    if (division != delayDivision)
+    {
+        delayDivision = division;
+        updateDelayTime ();
+    }
+    updateTailLength ();
+}
+
+void EffectsBus::setTempo (double bpm)
+{
+    if (bpm <= 0.0 || bpm == tempo)
+        return;
+    tempo = bpm;
+    updateDelayTime ();
+    updateTailLength ();
+}
+
+void EffectsBus::updateDelayTime ()
+{
+    double samples = delayDivisionBeats (delayDivision) * 60.0 / tempo * sampleRate;
+    int32_t maxSamples = delayLeft.data ? delayLeft.size () - 1 : 1;
+    int32_t target = std::max<int32_t> (1, std::min<int32_t> (maxSamples, (int32_t)samples));
+    if (target == delaySamples)
+        return;
+
+    // Fade out whichever tap is louder at this point of a running fade
+    if (delayFadeFrom == delaySamples || 2 * delayFadePos >= delayFadeLength)
+        delayFadeFrom = delaySamples;
+    delayFadePos = 0;
+    delaySamples = target;
+}
+
+// Samples until the output has decayed below -80 dB after the input stops
+void EffectsBus::updateTailLength ()
+{
+    int64_t length = chorusLine.size ();
+    if (delayMix > 0.f)
+    {
+        int64_t repeats = 1;
+        if (delayFeedback > 0.f)
+            repeats += (int64_t)ceil (log (1e-4) / log ((double)delayFeedback));
+        length = std::max<int64_t> (length, repeats * delaySamples);
+    }
+    tailLength = length;
+    tailLeft = std::min (tailLeft, tailLength);
+}
+
+void EffectsBus::process (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples,
+                          bool inputActive)
+{
+    // Stages switched on start from silence rather than stale line contents
+    if (chorusMix > 0.f && !chorusWasOn)
+        chorusLine.clear ();
+    if (delayMix > 0.f && !delayWasOn)
+    {
+        delayLeft.clear ();
+        delayRight.clear ();
+        delayFadeFrom = delaySamples;
+    }
+    chorusWasOn = chorusMix > 0.f;
+    delayWasOn = delayMix > 0.f;
+
+    for (int32_t pos = 0; pos < numSamples; pos += blockSize)
+    {
+        int32_t count = std::min (blockSize, numSamples - pos);
+        processBlock (inL + pos, inR + pos, outL + pos, outR + pos, count);
+    }
+
+    if (inputActive)
+        tailLeft = tailLength;
+    else
+        tailLeft = std::max<int64_t> (0, tailLeft - numSamples);
+}
+
+void EffectsBus::processBlock (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples)
+{
+    if (chorusMix > 0.f)
+    {
+        processChorus (inL, inR, outL, outR, numSamples);
+    }
+    else
+    {
+        memcpy (outL, inL, numSamples * sizeof (float));
+        memcpy (outR, inR, numSamples * sizeof (float));
+    }
+
+    if (delayMix > 0.f)
+        processDelay (outL, outR, numSamples);
+}
+
+void EffectsBus::processChorus (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples)
+{
+    // Write the whole block first; every tap then reads from the past. The
+    // line carries the mid signal, the dry path keeps the input's width.
+    const int32_t mask = chorusLine.mask;
+    const int32_t w = chorusLine.writePos;
+    float* line = chorusLine.data;
+    for (int32_t s = 0; s < numSamples; s++)
+        line[(w + s) & mask] = 0.5f * (inL[s] + inR[s]);
+
+    // Modulated delay per sample, left and right LFOs 90° apart
+    const float phase = (float)chorusPhase;
+    const float inc = (float)chorusInc;
+    const float base = chorusBase;
+    const float depth = chorusDepth;
+    for (int32_t s = 0; s < numSamples; s++)
+    {
+        float t = phase + inc * (float)s;
+        float tl = t - floorf (t);
+        float tr = tl + 0.25f;
+        tr -= floorf (tr);
+        modLeft[s] = base + depth * lfoShape (tl);
+        modRight[s] = base + depth * lfoShape (tr);
+    }
+
+    // Interpolated taps
+    const float wet = 0.5f * chorusMix;
+    const float dry = 1.f - wet;
+    for (int32_t s = 0; s < numSamples; s++)
+    {
+        int32_t dl = (int32_t)modLeft[s];
+        int32_t dr = (int32_t)modRight[s];
+        float fl = modLeft[s] - (float)dl;
+        float fr = modRight[s] - (float)dr;
+        int32_t il = (w + s - dl) & mask;
+        int32_t ir = (w + s - dr) & mask;
+        float l0 = line[il], l1 = line[(il - 1) & mask];
+        float r0 = line[ir], r1 = line[(ir - 1) & mask];
+        outL[s] = dry * inL[s] + wet * (l0 + fl * (l1 - l0));
+        outR[s] = dry * inR[s] + wet * (r0 + fr * (r1 - r0));
+    }
+
+    chorusLine.writePos = (w + numSamples) & mask;
+    chorusPhase += chorusInc * numSamples;
+    chorusPhase -= floor (chorusPhase);
+}
+
+void EffectsBus::processDelay (float* left, float* right, int32_t numSamples)
+{
+    // Ping-pong: the mono input enters the left line, each line feeds the
+    // other. Chunks never exceed the delay (either tap while the time
+    // crossfades), so all reads precede the writes.
+    const int32_t mask = delayLeft.mask;
+    const int32_t d = delaySamples;
+    const int32_t chunk = std::min (d, delayFadeFrom);
+    const float fadeStep = 1.f / (float)delayFadeLength;
+    const float fb = delayFeedback;
+    const float mix = delayMix;
+    float* lineL = delayLeft.data;
+    float* lineR = delayRight.data;
+    int32_t w = delayLeft.writePos;
+
+    for (int32_t pos = 0; pos < numSamples;)
+    {
+        const int32_t count = std::min (chunk, numSamples - pos);
+        float* l = left + pos;
+        float* r = right + pos;
+
+        if (delayFadeFrom == d)
+        {
+            for (int32_t s = 0; s < count; s++)
+            {
+                int32_t i = (w + s - d) & mask;
+                tapLeft[s] = lineL[i];
+                tapRight[s] = lineR[i];
+            }
+        }
+        else
+        {
+            const int32_t from = delayFadeFrom;
+            const float g0 = (float)delayFadePos * fadeStep;
+            for (int32_t s = 0; s < count; s++)
+            {
+                int32_t i = (w + s - d) & mask;
+                int32_t j = (w + s - from) & mask;
+                float g = std::min (1.f, g0 + (float)s * fadeStep);
+                tapLeft[s] = lineL[j] + g * (lineL[i] - lineL[j]);
+                tapRight[s] = lineR[j] + g * (lineR[i] - lineR[j]);
+            }
+            delayFadePos += count;
+            if (delayFadePos >= delayFadeLength)
+                delayFadeFrom = d;
+        }
+
+        for (int32_t s = 0; s < count; s++)
+        {
+            int32_t i = (w + s) & mask;
+            lineL[i] = 0.5f * (l[s] + r[s]) + fb * tapRight[s];
+            lineR[i] = fb * tapLeft[s];
+            l[s] += mix * tapLeft[s];
+            r[s] += mix * tapRight[s];
+        }
+
+        w = (w + count) & mask;
+        pos += count;
+    }
+
+    delayLeft.writePos = w;
+    delayRight.writePos = w;
+}
+
+} // namespace WineSynth
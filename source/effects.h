@@ -0,0 +1,127 @@
+#pragma once
+
+#include "arena.h"
+
+#include <cstdint>
+
+namespace WineSynth {
+
+enum DelayDivision
+{
+    kDelay1_16 = 0,
+    kDelay1_8T,
+    kDelay1_8,
+    kDelay1_8D,
+    kDelay1_4,
+    kDelay1_4D,
+    kDelay1_2,
+    kDelay1_1,
+    kNumDelayDivisions
+};
+
+// Length of a delay division in quarter notes
+inline double delayDivisionBeats (int32_t division)
+{
+    static constexpr double kBeats[kNumDelayDivisions] = {0.25, 1.0 / 3.0, 0.5, 0.75, 1.0, 1.5, 2.0, 4.0};
+    return (division >= 0 && division < kNumDelayDivisions) ? kBeats[division] : 1.0;
+}
+
+//------------------------------------------------------------------------
+// DelayLine — power-of-two ring buffer over arena memory
+//------------------------------------------------------------------------
+struct DelayLine
+{
+    float* data = nullptr;
+    int32_t mask = 0;
+    int32_t writePos = 0;
+
+    int32_t size () const { return mask + 1; }
+    void clear ();
+};
+
+//------------------------------------------------------------------------
+// EffectsBus — stereo chorus followed by a tempo-synced ping-pong delay,
+// applied to the summed voice output.
+//
+// Delay lines and scratch come from the processor's arena in prepare ()
+// (called from setupProcessing), sized for the longest delay at that rate;
+// process () never allocates. A stage with zero mix is skipped, and when
+// both are off the processor does not call the bus at all.
+//
+// A new delay time (division or host tempo) does not move the read head:
+// the old and the new tap crossfade over kDelayFadeMs instead.
+//------------------------------------------------------------------------
+class EffectsBus
+{
+public:
+    static constexpr double kMaxDelaySeconds = 4.0;
+    static constexpr double kChorusBaseMs = 7.0;
+    static constexpr double kChorusMaxDepthMs = 5.0;
+    static constexpr double kDelayFadeMs = 30.0;
+
+    // Arena space needed by prepare () for the given setup
+    static size_t getArenaBytes (double sampleRate, int32_t maxBlockSize);
+
+    // Takes the delay lines and scratch buffers from arena. Not realtime safe.
+    void prepare (Arena& arena, double sampleRate, int32_t maxBlockSize);
+    void reset ();
+
+    void setChorus (double mix, double rateHz, double depth);
+    void setDelay (double mix, int32_t division, double feedback);
+    void setTempo (double bpm);
+
+    bool isEnabled () const { return chorusMix > 0.f || delayMix > 0.f; }
+
+    // True while the bus still has to run although its input is silent
+    bool isTailActive () const { return tailLeft > 0; }
+
+    // inL / inR: voice mix (the same buffer when the voices are mono);
+    // outL / outR receive the stereo result (must not alias the input).
+    // inputActive tells the bus whether the input may be non-silent.
+    void process (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples,
+                  bool inputActive);
+
+private:
+    void processBlock (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples);
+    void processChorus (const float* inL, const float* inR, float* outL, float* outR, int32_t numSamples);
+    void processDelay (float* left, float* right, int32_t numSamples);
+    void updateDelayTime ();
+    void updateTailLength ();
+
+    double sampleRate = 44100.0;
+    int32_t blockSize = 0;
+
+    // Chorus
+    float chorusMix = 0.f;
+    double chorusPhase = 0.0;       // LFO phase 0..1
+    double chorusInc = 0.0;         // LFO phase per sample
+    float chorusBase = 0.f;         // centre delay in samples
+    float chorusDepth = 0.f;        // modulation depth in samples
+    bool chorusWasOn = false;
+
+    // Ping-pong delay
+    float delayMix = 0.f;
+    float delayFeedback = 0.f;
+    int32_t delayDivision = kDelay1_4;
+    double tempo = 120.0;
+    int32_t delaySamples = 1;
+    int32_t delayFadeFrom = 1;      // tap faded out; delaySamples when no fade runs
+    int32_t delayFadePos = 0;       // samples into the crossfade
+    int32_t delayFadeLength = 1;
+    bool delayWasOn = false;
+
+    int64_t tailLength = 0;
+    int64_t tailLeft = 0;
+
+    DelayLine chorusLine;
+    DelayLine delayLeft;
+    DelayLine delayRight;
+
+    // Scratch, one block each
+    float* modLeft = nullptr;
+    float* modRight = nullptr;
+    float* tapLeft = nullptr;
+    float* tapRight = nullptr;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Exponential AHDSR envelope
+//
+// Every segment is a one-pole recursion  level = level * coef + base,
+// i.e. one multiply-add per sample. Coefficients are shared by all voices
+// (EnvelopeParams, recomputed on parameter change); per-voice state is a
+// 12-byte EnvelopeState. renderBlock () computes the length of the current
+// segment up front, so the inner loops carry no stage branch. In sustain,
+// the level glides to a changed Sustain value (sustainGlide, a short
+// one-pole) instead of stepping to it at the next block.
+//------------------------------------------------------------------------
+enum EnvStage : int32_t
+{
+    kEnvIdle = 0,
+    kEnvAttack,
+    kEnvHold,
+    kEnvDecay,
+    kEnvSustain,
+    kEnvRelease
+};
+
+struct EnvelopeState
+{
+    float level = 0.f;
+    int32_t stage = kEnvIdle;
+    int32_t holdLeft = 0;      // samples remaining in kEnvHold
+
+    bool isIdle () const { return stage == kEnvIdle; }
+};
+
+struct EnvelopeSegment
+{
+    float coef = 0.f;
+    float base = 0.f;
+    float target = 0.f;        // asymptote the segment approaches
+    float logCoef = -1.f;      // log (coef), for segment length prediction
+};
+
+struct EnvelopeParams
+{
+    // Target ratios set the curve shape: attack is mildly convex (overshoots
+    // to 1 + ratio and stops at 1), decay/release are close to true exponentials.
+    static constexpr double kAttackRatio = 0.3;
+    static constexpr double kDecayReleaseRatio = 0.0001;
+    static constexpr double kSustainGlideMs = 5.0;     // time constant
+    static constexpr float kSustainSnap = 1e-4f;        // glide ends this close to sustain
+
+    EnvelopeSegment attack;
+    EnvelopeSegment decay;
+    EnvelopeSegment release;
+    EnvelopeSegment sustainGlide;
+    int32_t holdSamples = 0;
+    float sustain = 1.f;
+
+    // Times in samples; sustain 0..1
+    void set (double attackSamples, double holdSamps, double decaySamples,
+              double sustainLevel, double releaseSamples, double glideSamples)
+    {
+        sustain = (float)sustainLevel;
+        holdSamples = (int32_t)holdSamps;
+        attack = makeSegment (attackSamples, kAttackRatio, 1.0 + kAttackRatio);
+        decay = makeSegment (decaySamples, kDecayReleaseRatio, sustainLevel - kDecayReleaseRatio);
+        release = makeSegment (releaseSamples, kDecayReleaseRatio, -kDecayReleaseRatio);
+
+        const double coef = exp (-1.0 / std::max (glideSamples, 1.0));
+        sustainGlide.coef = (float)coef;
+        sustainGlide.base = (float)(sustainLevel * (1.0 - coef));
+        sustainGlide.target = sustain;
+        sustainGlide.logCoef = (float)log (coef);
+    }
+
+    // Segment that covers a full 0→1 (or 1→0) swing in 'samples'
+    static EnvelopeSegment makeSegment (double samples, double ratio, double target)
+    {
+        samples = std::max (samples, 1.0);
+        double coef = exp (-log ((1.0 + ratio) / ratio) / samples);
+        EnvelopeSegment seg;
+        seg.coef = (float)coef;
+        seg.base = (float)(target * (1.0 - coef));
+        seg.target = (float)target;
+        seg.logCoef = (float)std::min (log (coef), -1e-9);
+        return seg;
+    }
+};
+
+namespace Envelope {
+
+inline void noteOn (EnvelopeState& s)
+{
+    s.stage = kEnvAttack;   // retrigger from the current level
+}
+
+inline void noteOff (EnvelopeState& s)
+{
+    if (s.stage != kEnvIdle)
+        s.stage = kEnvRelease;
+}
+
+inline void reset (EnvelopeState& s)
+{
+    s = EnvelopeState ();
+}
+
+// Samples until a segment starting at 'level' crosses 'threshold'
+inline int32_t samplesToThreshold (const EnvelopeSegment& seg, float level, float threshold)
+{
+    double num = (double)threshold - seg.target;
+    double den = (double)level - seg.target;
+    if (den == 0.0 || num / den <= 0.0)
+        return 1;
+    double n = ceil (log (num / den) / seg.logCoef);
+    if (n < 1.0)
+        return 1;
+    return n > 1e9 ? 1000000000 : (int32_t)n;
+}
+
+// Runs 'count' samples of one segment into out, returns the final level
+inline float runSegment (const EnvelopeSegment& seg, float level, float* out, int32_t count)
+{
+    const float c = seg.coef;
+    const float b = seg.base;
+    for (int32_t i = 0; i < count; i++)
+    {
+        level = level * c + b;
+        out[i] = level;
+    }
+    return level;
+}
+
+inline void fill (float* out, float value, int32_t count)
+{
+    for (int32_t i = 0; i < count; i++)
+        out[i] = value;
+}
+
+// Fills out[0..numSamples) with envelope levels and advances the state
+inline void renderBlock (EnvelopeState& s, const EnvelopeParams& p, float* out, int32_t numSamples)
+{
+    int32_t pos = 0;
+    while (pos < numSamples)
+    {
+        int32_t remaining = numSamples - pos;
+        switch (s.stage)
+        {
+            case kEnvAttack:
+            {
+                int32_t n = samplesToThreshold (p.attack, s.level, 1.f);
+                if (n > remaining)
+                {
+                    s.level = runSegment (p.attack, s.level, out + pos, remaining);
+                    pos = numSamples;
+                }
+                else
+                {
+                    runSegment (p.attack, s.level, out + pos, n - 1);
+                    out[pos + n - 1] = s.level = 1.f;
+                    pos += n;
+                    s.holdLeft = p.holdSamples;
+                    s.stage = p.holdSamples > 0 ? kEnvHold : kEnvDecay;
+                }
+                break;
+            }
+            case kEnvHold:
+            {
+                int32_t n = std::min (s.holdLeft, remaining);
+                fill (out + pos, s.level, n);
+                pos += n;
+                s.holdLeft -= n;
+                if (s.holdLeft <= 0)
+                    s.stage = kEnvDecay;
+                break;
+            }
+            case kEnvDecay:
+            {
+                if (s.level <= p.sustain)
+                {
+                    s.stage = kEnvSustain;
+                    break;
+                }
+                int32_t n = samplesToThreshold (p.decay, s.level, p.sustain);
+                if (n > remaining)
+                {
+                    s.level = runSegment (p.decay, s.level, out + pos, remaining);
+                    pos = numSamples;
+                }
+                else
+                {
+                    runSegment (p.decay, s.level, out + pos, n - 1);
+                    out[pos + n - 1] = s.level = p.sustain;
+                    pos += n;
+                    s.stage = kEnvSustain;
+                }
+                break;
+            }
+            case kEnvSustain:
+            {
+                if (s.level == p.sustain)
+                {
+                    fill (out + pos, s.level, remaining);
+                    pos = numSamples;
+                    break;
+                }
+                // Sustain changed (or was raised above the level in decay)
+                const float snap = s.level > p.sustain ? EnvelopeParams::kSustainSnap : -EnvelopeParams::kSustainSnap;
+                int32_t n = samplesToThreshold (p.sustainGlide, s.level, p.sustain + snap);
+                if (n > remaining)
+                {
+                    s.level = runSegment (p.sustainGlide, s.level, out + pos, remaining);
+                    pos = numSamples;
+                }
+                else
+                {
+                    runSegment (p.sustainGlide, s.level, out + pos, n - 1);
+                    out[pos + n - 1] = s.level = p.sustain;
+                    pos += n;
+                }
+                break;
+            }
+            case kEnvRelease:
+            {
+                int32_t n = samplesToThreshold (p.release, s.level, 0.f);
+                if (n > remaining)
+                {
+                    s.level = runSegment (p.release, s.level, out + pos, remaining);
+                    pos = numSamples;
+                }
+                else
+                {
+                    runSegment (p.release, s.level, out + pos, n - 1);
+                    out[pos + n - 1] = s.level = 0.f;
+                    pos += n;
+                    s.stage = kEnvIdle;
+                }
+                break;
+            }
+            case kEnvIdle:
+            default:
+            {
+                s.level = 0.f;
+                fill (out + pos, 0.f, remaining);
+                pos = numSamples;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace Envelope
+
+} // namespace WineSynth
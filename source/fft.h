@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Fft — in-place iterative radix-2 complex FFT. Tables are built by
+// init () (not realtime safe); forward () / inverse () do not allocate.
+// inverse () is unscaled: the caller multiplies by 1 / size.
+//------------------------------------------------------------------------
+class Fft
+{
+public:
+    using Complex = std::complex<float>;
+
+    void init (int32_t n)
+    {
+        size = n;
+        int32_t bits = 0;
+        while ((1 << bits) < n)
+            bits++;
+
+        bitReverse.resize (n);
+        for (int32_t i = 0; i < n; i++)
+        {
+            int32_t r = 0;
+            for (int32_t b = 0; b < bits; b++)
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitReverse[i] = r;
+        }
+
+        twiddle.resize (n / 2);
+        for (int32_t i = 0; i < n / 2; i++)
+        {
+            double phase = -2.0 * M_PI * i / n;
+            twiddle[i] = Complex ((float)cos (phase), (float)sin (phase));
+        }
+    }
+
+    int32_t getSize () const { return size; }
+
+    void forward (Complex* data) const { transform (data, false); }
+    void inverse (Complex* data) const { transform (data, true); }
+
+private:
+    void transform (Complex* data, bool inverse) const
+    {
+        for (int32_t i = 0; i < size; i++)
+        {
+            int32_t j = bitReverse[i];
+            if (j > i)
+                std::swap (data[i], data[j]);
+        }
+
+        for (int32_t len = 2; len <= size; len <<= 1)
+        {
+            const int32_t half = len >> 1;
+            const int32_t step = size / len;
+            for (int32_t start = 0; start < size; start += len)
+            {
+                for (int32_t k = 0; k < half; k++)
+                {
+                    Complex tw = inverse ? std::conj (twiddle[k * step]) : twiddle[k * step];
+                    Complex a = data[start + k];
+                    Complex x = data[start + k + half];
+                    // Written out: operator* on std::complex adds NaN/Inf recovery
+                    Complex b (x.real () * tw.real () - x.imag () * tw.imag (),
+                               x.real () * tw.imag () + x.imag () * tw.real ());
+                    data[start + k] = a + b;
+                    data[start + k + half] = a - b;
+                }
+            }
+        }
+    }
+
+    int32_t size = 0;
+    std::vector<int32_t> bitReverse;
+    std::vector<Complex> twiddle;
+};
+
+//------------------------------------------------------------------------
+// RealFft — forward transform of n real samples: one complex FFT of n / 2
+// (even samples in the real, odd samples in the imaginary part) and a
+// split pass that separates the two. Output is the n / 2 + 1 bins from DC
+// to Nyquist. Scratch is kept in the object, so one instance serves one
+// thread; forward () does not allocate.
+//------------------------------------------------------------------------
+class RealFft
+{
+public:
+    using Complex = Fft::Complex;
+
+    void init (int32_t n)
+    {
+        size = n;
+        half.init (n / 2);
+        work.resize (n / 2);
+        twiddle.resize (n / 2);
+        for (int32_t k = 0; k < n / 2; k++)
+        {
+            double phase = -2.0 * M_PI * k / n;
+            twiddle[k] = Complex ((float)cos (phase), (float)sin (phase));
+        }
+    }
+
+    int32_t getSize () const { return size; }
+
+    void forward (const float* in, Complex* out)
+    {
+        const int32_t m = size / 2;
+        for (int32_t i = 0; i < m; i++)
+            work[i] = Complex (in[2 * i], in[2 * i + 1]);
+        half.forward (work.data ());
+
+        out[0] = Complex (work[0].real () + work[0].imag (), 0.f);
+        out[m] = Complex (work[0].real () - work[0].imag (), 0.f);
+        for (int32_t k = 1; k < m; k++)
+        {
+            // even = (Z[k] + conj Z[m-k]) / 2, odd = (Z[k] - conj Z[m-k]) / 2i
+            const Complex a = work[k];
+            const Complex b = std::conj (work[m - k]);
+            const float evenRe = 0.5f * (a.real () + b.real ());
+            const float evenIm = 0.5f * (a.imag () + b.imag ());
+            const float oddRe = 0.5f * (a.imag () - b.imag ());
+            const float oddIm = -0.5f * (a.real () - b.real ());
+            const Complex tw = twiddle[k];
+            out[k] = Complex (evenRe + oddRe * tw.real () - oddIm * tw.imag (),
+                              evenIm + oddRe * tw.imag () + oddIm * tw.real ());
+        }
+    }
+
+private:
+    int32_t size = 0;
+    Fft half;
+    std::vector<Complex> work;
+    std::vector<Complex> twiddle;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+enum FilterMode
+{
+    kFilterLowpass = 0,
+    kFilterBandpass,
+    kFilterHighpass,
+    kFilterNotch,
+    kFilterPeak,
+    kFilterLadder,
+    kNumFilterModes
+};
+
+//------------------------------------------------------------------------
+// Filter coefficients, shared by all voices. Recomputed on parameter change.
+//------------------------------------------------------------------------
+struct FilterCoeffs
+{
+    // Cytomic SVF (topology-preserving transform)
+    double g = 0.0;
+    double k = 2.0;        // damping: 2.0 (no reso) .. 0.1 (max reso)
+    double a1 = 1.0;
+    double a2 = 0.0;
+    double a3 = 0.0;
+
+    // 4-pole TPT ladder
+    double G = 0.0;        // one-pole gain g / (1 + g)
+    double G4 = 0.0;
+    double kLadder = 0.0;  // feedback 0..3.9 (self-oscillation at 4)
+    double ladderNorm = 1.0;
+    double ladderGain = 1.0;   // partial passband compensation for the feedback
+
+    // cutoff in Hz, resonance 0..1
+    static FilterCoeffs make (double cutoffHz, double resonance, double sampleRate)
+    {
+        FilterCoeffs c;
+        cutoffHz = std::min (cutoffHz, sampleRate * 0.49);
+        c.g = tan (M_PI * cutoffHz / sampleRate);
+        c.k = 2.0 - 2.0 * resonance * 0.95;
+        c.a1 = 1.0 / (1.0 + c.g * (c.g + c.k));
+        c.a2 = c.g * c.a1;
+        c.a3 = c.g * c.a2;
+
+        c.G = c.g / (1.0 + c.g);
+        c.G4 = c.G * c.G * c.G * c.G;
+        c.kLadder = 3.9 * resonance;
+        c.ladderNorm = 1.0 / (1.0 + c.kLadder * c.G4);
+        c.ladderGain = 1.0 + 0.5 * c.kLadder;
+        return c;
+    }
+};
+
+//------------------------------------------------------------------------
+// Per-voice filter state: four integrator states in one 32-byte block
+// (the SVF uses s[0..1], the ladder all four stages).
+//------------------------------------------------------------------------
+struct alignas (32) FilterState
+{
+    double s[4] = {0.0, 0.0, 0.0, 0.0};
+
+    void reset () { s[0] = s[1] = s[2] = s[3] = 0.0; }
+};
+
+//------------------------------------------------------------------------
+// Filter topologies as policies. The voice loop is instantiated once per
+// policy (see dispatchFilter ()), so there is no mode branch per sample.
+//------------------------------------------------------------------------
+template <FilterMode Mode>
+struct SvfFilter
+{
+    static double process (FilterState& st, const FilterCoeffs& c, double v0)
+    {
+        double ic1eq = st.s[0];
+        double ic2eq = st.s[1];
+        double v3 = v0 - ic2eq;
+        double v1 = c.a1 * ic1eq + c.a2 * v3;          // band
+        double v2 = ic2eq + c.a2 * ic1eq + c.a3 * v3;  // low
+        st.s[0] = 2.0 * v1 - ic1eq;
+        st.s[1] = 2.0 * v2 - ic2eq;
+
+        switch (Mode)  // compile-time constant
+        {
+            case kFilterBandpass: return v1;
+            case kFilterHighpass: return v0 - c.k * v1 - v2;
+            case kFilterNotch:    return v0 - c.k * v1;
+            case kFilterPeak:     return 2.0 * v2 - v0 + c.k * v1;
+            case kFilterLowpass:
+            default:              return v2;
+        }
+    }
+};
+
+using SvfLowpass = SvfFilter<kFilterLowpass>;
+using SvfBandpass = SvfFilter<kFilterBandpass>;
+using SvfHighpass = SvfFilter<kFilterHighpass>;
+using SvfNotch = SvfFilter<kFilterNotch>;
+using SvfPeak = SvfFilter<kFilterPeak>;
+
+// Zero-delay-feedback 4-pole ladder low-pass (linear, TPT one-pole stages)
+struct LadderFilter
+{
+    static double process (FilterState& st, const FilterCoeffs& c, double x)
+    {
+        const double G = c.G;
+        const double h = 1.0 - G;
+
+        // Output of the cascade without the input term
+        double S = G * G * G * h * st.s[0] + G * G * h * st.s[1] + G * h * st.s[2] + h * st.s[3];
+        double y4 = (c.G4 * x + S) * c.ladderNorm;
+        double u = x - c.kLadder * y4;
+
+        for (int i = 0; i < 4; i++)
+        {
+            double v = (u - st.s[i]) * G;
+            double y = v + st.s[i];
+            st.s[i] = y + v;
+            u = y;
+        }
+        return u * c.ladderGain;
+    }
+};
+
+// Calls fn (Policy {}) with the policy type matching mode
+template <typename Fn>
+inline void dispatchFilter (int32_t mode, Fn&& fn)
+{
+    switch (mode)
+    {
+        case kFilterBandpass: fn (SvfBandpass {}); break;
+        case kFilterHighpass: fn (SvfHighpass {}); break;
+        case kFilterNotch:    fn (SvfNotch {}); break;
+        case kFilterPeak:     fn (SvfPeak {}); break;
+        case kFilterLadder:   fn (LadderFilter {}); break;
+        case kFilterLowpass:
+        default:              fn (SvfLowpass {}); break;
+    }
+}
+
+} // namespace WineSynth
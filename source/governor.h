@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Quality levels, cheapest last. Each level keeps the savings of the ones
+// before it.
+//------------------------------------------------------------------------
+enum QualityLevel
+{
+    kQualityFull = 0,
+    kQualityCheapOscillators,   // polynomial sine instead of sin ()
+    kQualityHalfVoices,         // polyphony capped at half, quietest voices fade out
+    kQualityQuarterVoices,      // polyphony capped at a quarter
+    kNumQualityLevels
+};
+
+//------------------------------------------------------------------------
+// QualityGovernor — steps render quality down when process () gets close
+// to its deadline and back up once there is headroom again.
+//
+// Load is the measured block time over the block's duration
+// (numSamples / sampleRate). A single block above kPeakLoad, or the
+// smoothed load above kHighLoad, steps down one level (at most once per
+// kStepDownSeconds, so the previous step gets time to show). Stepping up
+// needs the smoothed load below kLowLoad for kHoldSeconds of audio. Time is
+// counted in audio seconds, so the governor behaves the same at any block
+// size. Audio thread only.
+//------------------------------------------------------------------------
+class QualityGovernor
+{
+public:
+    static constexpr double kPeakLoad = 0.95;
+    static constexpr double kHighLoad = 0.75;
+    static constexpr double kLowLoad = 0.4;
+    static constexpr double kSmoothingSeconds = 0.1;
+    static constexpr double kStepDownSeconds = 0.25;
+    static constexpr double kHoldSeconds = 2.0;
+
+    void reset ()
+    {
+        level = kQualityFull;
+        smoothedLoad = 0.0;
+        sinceChange = 0.0;
+        sinceHeadroom = 0.0;
+    }
+
+    // Returns true when the level changed
+    bool update (double elapsedSeconds, double blockSeconds)
+    {
+        if (blockSeconds <= 0.0)
+            return false;
+
+        const double load = elapsedSeconds / blockSeconds;
+        const double a = 1.0 - exp (-blockSeconds / kSmoothingSeconds);
+        smoothedLoad += a * (load - smoothedLoad);
+        sinceChange += blockSeconds;
+        sinceHeadroom = smoothedLoad < kLowLoad ? sinceHeadroom + blockSeconds : 0.0;
+
+        int32_t newLevel = level;
+        if ((load > kPeakLoad || smoothedLoad > kHighLoad) && sinceChange >= kStepDownSeconds)
+            newLevel = std::min<int32_t> (level + 1, kNumQualityLevels - 1);
+        else if (sinceHeadroom >= kHoldSeconds && sinceChange >= kHoldSeconds)
+            newLevel = std::max<int32_t> (level - 1, kQualityFull);
+
+        if (newLevel == level)
+            return false;
+        level = newLevel;
+        sinceChange = 0.0;
+        sinceHeadroom = 0.0;
+        return true;
+    }
+
+    int32_t getLevel () const { return level; }
+    double getLoad () const { return smoothedLoad; }
+
+private:
+    int32_t level = kQualityFull;
+    double smoothedLoad = 0.0;
+    double sinceChange = 0.0;
+    double sinceHeadroom = 0.0;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,248 @@
+#include "instancestats.h"
+
+#include <cstdio>
+#include <mutex>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WineSynth {
+
+namespace {
+
+std::mutex registryMutex;
+int refCount = 0;
+StatsTable* table = nullptr;
+
+// Fallback when no shared mapping can be made
+StatsTable privateTable;
+
+#if defined(_WIN32)
+HANDLE mapping = nullptr;
+
+uint32_t getProcessId () { return (uint32_t)GetCurrentProcessId (); }
+
+// Returns the mapped memory; existing is set when another copy of the
+// module in this process created it first
+void* mapShared (const char* name, bool& existing)
+{
+    char fullName[64];
+    snprintf (fullName, sizeof (fullName), "Local\\%s", name);
+    mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof (StatsTable), fullName);
+    if (!mapping)
+        return nullptr;
+    existing = GetLastError () == ERROR_ALREADY_EXISTS;
+    void* memory = MapViewOfFile (mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof (StatsTable));
+    if (!memory)
+    {
+        CloseHandle (mapping);
+        mapping = nullptr;
+    }
+    return memory;
+}
+
+void shareMapped () {}
+
+void unmapShared (void* memory, const char*)
+{
+    UnmapViewOfFile (memory);
+    CloseHandle (mapping);
+    mapping = nullptr;
+}
+#else
+int sharedFd = -1;
+
+uint32_t getProcessId () { return (uint32_t)getpid (); }
+
+// Open file description lock over the whole object; F_OFD_SETLK(W) changes
+// the type of a lock we hold atomically
+bool lockShared (int fd, short type, bool wait)
+{
+    struct flock lock = {};
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    return fcntl (fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &lock) == 0;
+}
+
+// Every copy of the module that maps the object holds a read lock on it
+// for as long as it does; that is the reference count. An object nobody
+// holds is either new or was left behind by a crashed process that had
+// our ID, and is set up again. Its creator keeps a write lock until the
+// table is constructed (shareMapped ()), so the others wait for that.
+void* mapShared (const char* name, bool& existing)
+{
+    char fullName[64];
+    snprintf (fullName, sizeof (fullName), "/%s", name);
+
+    for (int32_t attempt = 0; attempt < 4; attempt++)
+    {
+        int fd = shm_open (fullName, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            return nullptr;
+
+        existing = !lockShared (fd, F_WRLCK, false);
+        if (existing && !lockShared (fd, F_RDLCK, true))
+        {
+            close (fd);
+            return nullptr;
+        }
+
+        // The last owner may have unlinked it between our open and lock
+        struct stat st;
+        if (fstat (fd, &st) != 0 || st.st_nlink == 0)
+        {
+            close (fd);
+            continue;
+        }
+
+        bool sized = existing ? st.st_size >= (off_t)sizeof (StatsTable)
+                              : ftruncate (fd, 0) == 0 && ftruncate (fd, sizeof (StatsTable)) == 0;
+        void* memory = sized ? mmap (nullptr, sizeof (StatsTable), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (memory == MAP_FAILED)
+        {
+            if (!existing)
+                shm_unlink (fullName);
+            close (fd);
+            return nullptr;
+        }
+        sharedFd = fd;
+        return memory;
+    }
+    return nullptr;
+}
+
+void shareMapped ()
+{
+    lockShared (sharedFd, F_RDLCK, false);
+}
+
+void unmapShared (void* memory, const char* name)
+{
+    char fullName[64];
+    snprintf (fullName, sizeof (fullName), "/%s", name);
+    munmap (memory, sizeof (StatsTable));
+
+    // Only the last owner gets the write lock and removes the name
+    if (lockShared (sharedFd, F_WRLCK, false))
+        shm_unlink (fullName);
+    close (sharedFd);
+    sharedFd = -1;
+}
+#endif
+
+void getSharedName (char* name, size_t size)
+{
+    snprintf (name, size, "%s%u", kSharedStatsName, getProcessId ());
+}
+
+} // namespace
+
+namespace StatsRegistry {
+
+StatsTable* acquire ()
+{
+    std::lock_guard<std::mutex> lock (registryMutex);
+    if (refCount++ > 0)
+        return table;
+
+    char name[48];
+    getSharedName (name, sizeof (name));
+    bool existing = false;
+    void* memory = mapShared (name, existing);
+    if (memory)
+    {
+        table = existing ? static_cast<StatsTable*> (memory) : new (memory) StatsTable ();
+    }
+    else
+    {
+        table = new (&privateTable) StatsTable ();
+    }
+
+    if (table->magic.load (std::memory_order_acquire) != StatsTable::kMagic)
+    {
+        table->processId = getProcessId ();
+        table->magic.store (StatsTable::kMagic, std::memory_order_release);
+    }
+    if (memory)
+        shareMapped ();     // valid now; other copies of the module may use it
+    return table;
+}
+
+void release ()
+{
+    std::lock_guard<std::mutex> lock (registryMutex);
+    if (refCount == 0 || --refCount > 0)
+        return;
+
+    if (table != &privateTable)
+    {
+        char name[48];
+        getSharedName (name, sizeof (name));
+        unmapShared (table, name);
+    }
+    table = nullptr;
+}
+
+} // namespace StatsRegistry
+
+bool StatsPublisher::open ()
+{
+    close ();
+    StatsTable* t = StatsRegistry::acquire ();
+    for (InstanceSlot& s : t->slots)
+    {
+        // Claimed slots stay invisible to readers until they are filled
+        uint32_t expected = InstanceSlot::kFree;
+        if (!s.state.compare_exchange_strong (expected, InstanceSlot::kClaimed, std::memory_order_acq_rel))
+            continue;
+
+        slot = &s;
+        instanceId = t->nextInstanceId.fetch_add (1, std::memory_order_relaxed);
+        s.instanceId.store (instanceId, std::memory_order_relaxed);
+        publish (InstanceStats ());
+        setName ("");
+        s.state.store (InstanceSlot::kActive, std::memory_order_release);
+        return true;
+    }
+    StatsRegistry::release ();
+    return false;
+}
+
+void StatsPublisher::close ()
+{
+    if (!slot)
+        return;
+    slot->state.store (InstanceSlot::kFree, std::memory_order_release);
+    slot = nullptr;
+    instanceId = 0;
+    StatsRegistry::release ();
+}
+
+void StatsPublisher::setName (const char* name)
+{
+    if (!slot)
+        return;
+
+    uint32_t words[InstanceStats::kNameSize / 4] = {};
+    strncpy (reinterpret_cast<char*> (words), name, InstanceStats::kNameSize - 1);
+
+    const uint32_t seq = slot->nameSequence.load (std::memory_order_relaxed);
+    slot->nameSequence.store (seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    for (int32_t i = 0; i < InstanceStats::kNameSize / 4; i++)
+        slot->name[i].store (words[i], std::memory_order_relaxed);
+    slot->nameSequence.store (seq + 2, std::memory_order_release);
+}
+
+} // namespace WineSynth
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Instance statistics — one process-wide table of per-instance counters
+// (load, voices, idle state, memory, output levels), written by every processor once per
+// block and read by any editor and by external tools.
+//
+// The table has a fixed layout made only of 32-bit words and lock-free
+// atomics, so it can live in shared memory: each process maps it under
+// the name kSharedStatsName plus its process ID (Win32 / Wine: a Local\ file
+// mapping; Linux: a POSIX shm object), and a tool maps the same name to
+// read it. Nothing in it is a pointer. If the mapping cannot be created the
+// table stays private to the process.
+//
+// Each slot is written by one audio thread only. Readers never block the
+// writer: a sequence counter is made odd for the duration of a write and
+// readers retry when it changed under them (seqlock). The host track name
+// changes rarely and off the audio thread, so it has its own counter.
+//
+// This header does not depend on the VST3 SDK or VSTGUI; a tool includes
+// it, maps the table and calls readInstanceStats ().
+//------------------------------------------------------------------------
+
+static constexpr const char* kSharedStatsName = "WineSynthStats-";   // + decimal process ID
+
+// Copy of one slot, as read
+struct InstanceStats
+{
+    static constexpr int32_t kNameSize = 32;
+    static constexpr int32_t kNumLevels = 2;        // metered output channels
+
+    uint32_t instanceId = 0;        // unique within the process, counting from 1
+    float load = 0.f;               // block time / block duration, smoothed
+    float peakLoad = 0.f;           // highest load, decaying over a few seconds
+    float blockMicros = 0.f;        // process () time of the last block
+    uint32_t voices = 0;            // active voices
+    uint32_t idle = 0;              // 1: the last block was skipped as silent
+    uint32_t qualityLevel = 0;      // QualityLevel of the CPU governor
+    uint32_t memoryKiB = 0;         // DSP arenas and reverb impulse
+    uint32_t blocks = 0;            // process () calls (wraps)
+    float levelPeak[kNumLevels] = {};   // output peak per channel, linear, falling (see meter.h)
+    float levelRms[kNumLevels] = {};    // output RMS per channel, linear
+    char name[kNameSize] = {};      // host track name, UTF-8, may be empty
+};
+
+// One instance in the shared table
+struct alignas (64) InstanceSlot
+{
+    enum : uint32_t
+    {
+        kFree = 0,
+        kActive = 1,
+        kClaimed = 2        // being set up by its new owner
+    };
+
+    std::atomic<uint32_t> state {kFree};
+    std::atomic<uint32_t> sequence {0};         // odd while the owner writes
+    std::atomic<uint32_t> instanceId {0};
+    std::atomic<float> load {0.f};
+    std::atomic<float> peakLoad {0.f};
+    std::atomic<float> blockMicros {0.f};
+    std::atomic<uint32_t> voices {0};
+    std::atomic<uint32_t> idle {0};
+    std::atomic<uint32_t> qualityLevel {0};
+    std::atomic<uint32_t> memoryKiB {0};
+    std::atomic<uint32_t> blocks {0};
+    std::atomic<float> levelPeak[InstanceStats::kNumLevels] {};
+    std::atomic<float> levelRms[InstanceStats::kNumLevels] {};
+
+    std::atomic<uint32_t> nameSequence {0};
+    std::atomic<uint32_t> name[InstanceStats::kNameSize / 4] {};   // bytes in memory order
+};
+
+struct StatsTable
+{
+    static constexpr uint32_t kMagic = 0x54535357;     // "WSST"
+    static constexpr uint32_t kVersion = 2;
+    static constexpr int32_t kMaxInstances = 128;
+
+    std::atomic<uint32_t> magic {0};                    // set last, once the header is valid
+    uint32_t version = kVersion;
+    uint32_t slotSize = sizeof (InstanceSlot);
+    uint32_t maxInstances = kMaxInstances;
+    uint32_t processId = 0;
+    std::atomic<uint32_t> nextInstanceId {1};
+
+    InstanceSlot slots[kMaxInstances];
+};
+
+static_assert (std::atomic<uint32_t>::is_always_lock_free && std::atomic<float>::is_always_lock_free,
+               "shared statistics need address-free atomics");
+static_assert (sizeof (std::atomic<uint32_t>) == 4 && sizeof (std::atomic<float>) == 4,
+               "shared statistics are laid out in 32-bit words");
+
+//------------------------------------------------------------------------
+// Reader side: readInstanceStats () copies the active slots into out (at
+// most maxCount) and returns how many. A slot that is being written is
+// retried a few times and skipped if the writer keeps it busy. Any
+// thread, any process.
+//------------------------------------------------------------------------
+inline bool readInstanceSlot (const InstanceSlot& slot, InstanceStats& s)
+{
+    bool valid = false;
+    for (int32_t attempt = 0; attempt < 4 && !valid; attempt++)
+    {
+        const uint32_t before = slot.sequence.load (std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        s.instanceId = slot.instanceId.load (std::memory_order_relaxed);
+        s.load = slot.load.load (std::memory_order_relaxed);
+        s.peakLoad = slot.peakLoad.load (std::memory_order_relaxed);
+        s.blockMicros = slot.blockMicros.load (std::memory_order_relaxed);
+        s.voices = slot.voices.load (std::memory_order_relaxed);
+        s.idle = slot.idle.load (std::memory_order_relaxed);
+        s.qualityLevel = slot.qualityLevel.load (std::memory_order_relaxed);
+        s.memoryKiB = slot.memoryKiB.load (std::memory_order_relaxed);
+        s.blocks = slot.blocks.load (std::memory_order_relaxed);
+        for (int32_t c = 0; c < InstanceStats::kNumLevels; c++)
+        {
+            s.levelPeak[c] = slot.levelPeak[c].load (std::memory_order_relaxed);
+            s.levelRms[c] = slot.levelRms[c].load (std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence (std::memory_order_acquire);
+        valid = slot.sequence.load (std::memory_order_relaxed) == before;
+    }
+    if (!valid)
+        return false;
+
+    s.name[0] = 0;
+    for (int32_t attempt = 0; attempt < 4; attempt++)
+    {
+        const uint32_t before = slot.nameSequence.load (std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        uint32_t words[InstanceStats::kNameSize / 4];
+        for (int32_t i = 0; i < InstanceStats::kNameSize / 4; i++)
+            words[i] = slot.name[i].load (std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (slot.nameSequence.load (std::memory_order_relaxed) != before)
+            continue;
+        memcpy (s.name, words, sizeof (words));
+        s.name[InstanceStats::kNameSize - 1] = 0;
+        break;
+    }
+    return true;
+}
+
+inline int32_t readInstanceStats (const StatsTable& table, InstanceStats* out, int32_t maxCount)
+{
+    if (table.magic.load (std::memory_order_acquire) != StatsTable::kMagic || table.version != StatsTable::kVersion)
+        return 0;
+
+    int32_t count = 0;
+    for (const InstanceSlot& slot : table.slots)
+    {
+        if (count >= maxCount)
+            break;
+        if (slot.state.load (std::memory_order_acquire) == InstanceSlot::kActive && readInstanceSlot (slot, out[count]))
+            count++;
+    }
+    return count;
+}
+
+// One instance by ID; false if it is not in the table (or stayed busy)
+inline bool readInstanceStats (const StatsTable& table, uint32_t instanceId, InstanceStats& out)
+{
+    if (instanceId == 0 || table.magic.load (std::memory_order_acquire) != StatsTable::kMagic
+        || table.version != StatsTable::kVersion)
+        return false;
+
+    for (const InstanceSlot& slot : table.slots)
+    {
+        if (slot.instanceId.load (std::memory_order_relaxed) == instanceId
+            && slot.state.load (std::memory_order_acquire) == InstanceSlot::kActive)
+            return readInstanceSlot (slot, out) && out.instanceId == instanceId;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------
+// StatsRegistry — the process's table, reference counted: the first
+// acquire () creates (and shares) it, the last release () removes it.
+// Not realtime safe; call from initialize () / terminate () or the GUI.
+//------------------------------------------------------------------------
+namespace StatsRegistry {
+
+StatsTable* acquire ();
+void release ();
+
+} // namespace StatsRegistry
+
+//------------------------------------------------------------------------
+// StatsPublisher — one processor's slot. open () / close () claim and free
+// it (not realtime safe); publish () is wait-free and called by the audio
+// thread once per block; setName () by one non-audio thread.
+//------------------------------------------------------------------------
+class StatsPublisher
+{
+public:
+    StatsPublisher () = default;
+    ~StatsPublisher () { close (); }
+
+    StatsPublisher (const StatsPublisher&) = delete;
+    StatsPublisher& operator= (const StatsPublisher&) = delete;
+
+    // False when all slots are taken; publish () then does nothing
+    bool open ();
+    void close ();
+
+    uint32_t getInstanceId () const { return instanceId; }
+
+    void publish (const InstanceStats& stats)
+    {
+        if (!slot)
+            return;
+        const uint32_t seq = slot->sequence.load (std::memory_order_relaxed);
+        slot->sequence.store (seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        slot->load.store (stats.load, std::memory_order_relaxed);
+        slot->peakLoad.store (stats.peakLoad, std::memory_order_relaxed);
+        slot->blockMicros.store (stats.blockMicros, std::memory_order_relaxed);
+        slot->voices.store (stats.voices, std::memory_order_relaxed);
+        slot->idle.store (stats.idle, std::memory_order_relaxed);
+        slot->qualityLevel.store (stats.qualityLevel, std::memory_order_relaxed);
+        slot->memoryKiB.store (stats.memoryKiB, std::memory_order_relaxed);
+        slot->blocks.store (stats.blocks, std::memory_order_relaxed);
+        for (int32_t c = 0; c < InstanceStats::kNumLevels; c++)
+        {
+            slot->levelPeak[c].store (stats.levelPeak[c], std::memory_order_relaxed);
+            slot->levelRms[c].store (stats.levelRms[c], std::memory_order_relaxed);
+        }
+        slot->sequence.store (seq + 2, std::memory_order_release);
+    }
+
+    void setName (const char* name);
+
+private:
+    InstanceSlot* slot = nullptr;
+    uint32_t instanceId = 0;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WINESYNTH_LANES_SSE 1
+#endif
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// FloatLanes — kSize floats processed together (one per oscillator or
+// partial of a group). Two SSE registers on x86 (SSE2 is baseline on every
+// target we build), a plain array elsewhere. load () / store () are
+// aligned; the Unaligned variants take any float pointer (host buffers).
+//------------------------------------------------------------------------
+#if WINESYNTH_LANES_SSE
+struct FloatLanes
+{
+    static constexpr int32_t kSize = 8;
+
+    __m128 lo, hi;
+
+    static FloatLanes load (const float* p) { return {_mm_load_ps (p), _mm_load_ps (p + 4)}; }
+    static FloatLanes set1 (float x) { return {_mm_set1_ps (x), _mm_set1_ps (x)}; }
+    static FloatLanes loadUnaligned (const float* p) { return {_mm_loadu_ps (p), _mm_loadu_ps (p + 4)}; }
+    void store (float* p) const
+    {
+        _mm_store_ps (p, lo);
+        _mm_store_ps (p + 4, hi);
+    }
+    void storeUnaligned (float* p) const
+    {
+        _mm_storeu_ps (p, lo);
+        _mm_storeu_ps (p + 4, hi);
+    }
+
+    friend FloatLanes operator+ (FloatLanes a, FloatLanes b) { return {_mm_add_ps (a.lo, b.lo), _mm_add_ps (a.hi, b.hi)}; }
+    friend FloatLanes operator- (FloatLanes a, FloatLanes b) { return {_mm_sub_ps (a.lo, b.lo), _mm_sub_ps (a.hi, b.hi)}; }
+    friend FloatLanes operator* (FloatLanes a, FloatLanes b) { return {_mm_mul_ps (a.lo, b.lo), _mm_mul_ps (a.hi, b.hi)}; }
+
+    // Comparisons give all-ones / all-zero lanes
+    friend FloatLanes operator< (FloatLanes a, FloatLanes b) { return {_mm_cmplt_ps (a.lo, b.lo), _mm_cmplt_ps (a.hi, b.hi)}; }
+    friend FloatLanes operator<= (FloatLanes a, FloatLanes b) { return {_mm_cmple_ps (a.lo, b.lo), _mm_cmple_ps (a.hi, b.hi)}; }
+    friend FloatLanes operator& (FloatLanes mask, FloatLanes a) { return {_mm_and_ps (mask.lo, a.lo), _mm_and_ps (mask.hi, a.hi)}; }
+    static FloatLanes select (FloatLanes mask, FloatLanes a, FloatLanes b)
+    {
+        return {_mm_or_ps (_mm_and_ps (mask.lo, a.lo), _mm_andnot_ps (mask.lo, b.lo)),
+                _mm_or_ps (_mm_and_ps (mask.hi, a.hi), _mm_andnot_ps (mask.hi, b.hi))};
+    }
+    static FloatLanes abs (FloatLanes a)
+    {
+        const __m128 sign = _mm_set1_ps (-0.f);
+        return {_mm_andnot_ps (sign, a.lo), _mm_andnot_ps (sign, a.hi)};
+    }
+    static FloatLanes max (FloatLanes a, FloatLanes b) { return {_mm_max_ps (a.lo, b.lo), _mm_max_ps (a.hi, b.hi)}; }
+    // |magnitude| with the sign of sign
+    static FloatLanes copySign (FloatLanes magnitude, FloatLanes sign)
+    {
+        const __m128 bit = _mm_set1_ps (-0.f);
+        return {_mm_or_ps (_mm_andnot_ps (bit, magnitude.lo), _mm_and_ps (bit, sign.lo)),
+                _mm_or_ps (_mm_andnot_ps (bit, magnitude.hi), _mm_and_ps (bit, sign.hi))};
+    }
+
+    static float sum (FloatLanes a)
+    {
+        __m128 x = _mm_add_ps (a.lo, a.hi);
+        x = _mm_add_ps (x, _mm_movehl_ps (x, x));
+        x = _mm_add_ss (x, _mm_shuffle_ps (x, x, _MM_SHUFFLE (1, 1, 1, 1)));
+        return _mm_cvtss_f32 (x);
+    }
+
+    static float maxOf (FloatLanes a)
+    {
+        __m128 x = _mm_max_ps (a.lo, a.hi);
+        x = _mm_max_ps (x, _mm_movehl_ps (x, x));
+        x = _mm_max_ss (x, _mm_shuffle_ps (x, x, _MM_SHUFFLE (1, 1, 1, 1)));
+        return _mm_cvtss_f32 (x);
+    }
+
+    // Sums of all lanes of a and of b
+    static void sum2 (FloatLanes a, FloatLanes b, float& sumA, float& sumB)
+    {
+        __m128 x = _mm_add_ps (a.lo, a.hi);
+        __m128 y = _mm_add_ps (b.lo, b.hi);
+        __m128 t = _mm_add_ps (_mm_unpacklo_ps (x, y), _mm_unpackhi_ps (x, y));   // x0+x2 y0+y2 x1+x3 y1+y3
+        t = _mm_add_ps (t, _mm_movehl_ps (t, t));
+        sumA = _mm_cvtss_f32 (t);
+        sumB = _mm_cvtss_f32 (_mm_shuffle_ps (t, t, _MM_SHUFFLE (1, 1, 1, 1)));
+    }
+};
+#else
+struct FloatLanes
+{
+    static constexpr int32_t kSize = 8;
+
+    float v[kSize];
+
+    template <typename Fn>
+    static FloatLanes map (Fn&& fn)
+    {
+        FloatLanes r;
+        for (int32_t j = 0; j < kSize; j++)
+            r.v[j] = fn (j);
+        return r;
+    }
+
+    static FloatLanes load (const float* p) { return map ([=] (int32_t j) { return p[j]; }); }
+    static FloatLanes loadUnaligned (const float* p) { return load (p); }
+    static FloatLanes set1 (float x) { return map ([=] (int32_t) { return x; }); }
+    void store (float* p) const
+    {
+        for (int32_t j = 0; j < kSize; j++)
+            p[j] = v[j];
+    }
+    void storeUnaligned (float* p) const { store (p); }
+
+    friend FloatLanes operator+ (FloatLanes a, FloatLanes b) { return map ([&] (int32_t j) { return a.v[j] + b.v[j]; }); }
+    friend FloatLanes operator- (FloatLanes a, FloatLanes b) { return map ([&] (int32_t j) { return a.v[j] - b.v[j]; }); }
+    friend FloatLanes operator* (FloatLanes a, FloatLanes b) { return map ([&] (int32_t j) { return a.v[j] * b.v[j]; }); }
+
+    // Masks are kept as 1 / 0
+    friend FloatLanes operator< (FloatLanes a, FloatLanes b) { return map ([&] (int32_t j) { return a.v[j] < b.v[j] ? 1.f : 0.f; }); }
+    friend FloatLanes operator<= (FloatLanes a, FloatLanes b) { return map ([&] (int32_t j) { return a.v[j] <= b.v[j] ? 1.f : 0.f; }); }
+    friend FloatLanes operator& (FloatLanes mask, FloatLanes a) { return map ([&] (int32_t j) { return mask.v[j] != 0.f ? a.v[j] : 0.f; }); }
+    static FloatLanes select (FloatLanes mask, FloatLanes a, FloatLanes b)
+    {
+        return map ([&] (int32_t j) { return mask.v[j] != 0.f ? a.v[j] : b.v[j]; });
+    }
+    static FloatLanes abs (FloatLanes a) { return map ([&] (int32_t j) { return fabsf (a.v[j]); }); }
+    static FloatLanes max (FloatLanes a, FloatLanes b)
+    {
+        return map ([&] (int32_t j) { return a.v[j] > b.v[j] ? a.v[j] : b.v[j]; });
+    }
+    static FloatLanes copySign (FloatLanes magnitude, FloatLanes sign)
+    {
+        return map ([&] (int32_t j) { return copysignf (magnitude.v[j], sign.v[j]); });
+    }
+
+    static float sum (FloatLanes a)
+    {
+        float sum = 0.f;
+        for (int32_t j = 0; j < kSize; j++)
+            sum += a.v[j];
+        return sum;
+    }
+
+    static float maxOf (FloatLanes a)
+    {
+        float m = a.v[0];
+        for (int32_t j = 1; j < kSize; j++)
+            m = a.v[j] > m ? a.v[j] : m;
+        return m;
+    }
+
+    static void sum2 (FloatLanes a, FloatLanes b, float& sumA, float& sumB)
+    {
+        sumA = sumB = 0.f;
+        for (int32_t j = 0; j < kSize; j++)
+        {
+            sumA += a.v[j];
+            sumB += b.v[j];
+        }
+    }
+};
+#endif
+
+} // namespace WineSynth
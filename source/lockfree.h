@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// TripleBuffer — wait-free single-writer / single-reader value handoff
+//
+// The writer fills getWriteBuffer () and calls publish (); the reader calls
+// read () and always gets the most recently published value. Neither side
+// blocks or allocates, so the reader may be the audio thread.
+//------------------------------------------------------------------------
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer side
+    T& getWriteBuffer () { return buffers[back]; }
+
+    void publish ()
+    {
+        back = middle.exchange ((uint8_t)(back | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side
+    const T& read ()
+    {
+        if (middle.load (std::memory_order_relaxed) & kFresh)
+            front = middle.exchange (front, std::memory_order_acq_rel) & kIndexMask;
+        return buffers[front];
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    T buffers[3] {};
+    std::atomic<uint8_t> middle {1};
+    uint8_t front = 0;
+    uint8_t back = 2;
+};
+
+} // namespace WineSynth
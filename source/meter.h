@@ -0,0 +1,144 @@
+#pragma once
+
+#include "lanes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Output level metering. The render loop reduces every sub-block to a
+// peak and a sum of squares per channel, FloatLanes::kSize samples at a
+// time: copyAndMeasure () as part of the copy that writes a host channel,
+// measureLevel () right after a stage that wrote it in place, while the
+// sub-block is still in L1. Neither makes a pass of its own over the host
+// buffers. The accumulators stay in lanes across sub-blocks; they are
+// reduced to one value once per host block.
+//------------------------------------------------------------------------
+struct ChannelLevel
+{
+    FloatLanes peak = FloatLanes::set1 (0.f);       // highest |x| per lane
+    FloatLanes squares = FloatLanes::set1 (0.f);
+    float tailPeak = 0.f;                           // samples past the last full lane group
+    float tailSquares = 0.f;
+
+    float getPeak () const { return std::max (FloatLanes::maxOf (peak), tailPeak); }
+    float getSumSquares () const { return FloatLanes::sum (squares) + tailSquares; }
+};
+
+namespace LevelDetail {
+
+template <bool Copy>
+inline void reduce (float* dst, const float* src, int32_t count, ChannelLevel& level)
+{
+    // Two lane groups per step, so the additions do not wait on each other
+    constexpr int32_t kStep = 2 * FloatLanes::kSize;
+    const int32_t pairCount = count & ~(kStep - 1);
+    const int32_t vectorCount = count & ~(FloatLanes::kSize - 1);
+    FloatLanes peak = level.peak;
+    FloatLanes squares = level.squares;
+    FloatLanes squares2 = FloatLanes::set1 (0.f);
+    int32_t s = 0;
+    for (; s < pairCount; s += kStep)
+    {
+        const FloatLanes x = FloatLanes::loadUnaligned (src + s);
+        const FloatLanes y = FloatLanes::loadUnaligned (src + s + FloatLanes::kSize);
+        if (Copy)
+        {
+            x.storeUnaligned (dst + s);
+            y.storeUnaligned (dst + s + FloatLanes::kSize);
+        }
+        peak = FloatLanes::max (peak, FloatLanes::max (FloatLanes::abs (x), FloatLanes::abs (y)));
+        squares = squares + x * x;
+        squares2 = squares2 + y * y;
+    }
+    for (; s < vectorCount; s += FloatLanes::kSize)
+    {
+        const FloatLanes x = FloatLanes::loadUnaligned (src + s);
+        if (Copy)
+            x.storeUnaligned (dst + s);
+        peak = FloatLanes::max (peak, FloatLanes::abs (x));
+        squares = squares + x * x;
+    }
+    level.peak = peak;
+    level.squares = squares + squares2;
+
+    for (; s < count; s++)
+    {
+        const float x = src[s];
+        if (Copy)
+            dst[s] = x;
+        level.tailPeak = std::max (level.tailPeak, fabsf (x));
+        level.tailSquares += x * x;
+    }
+}
+
+} // namespace LevelDetail
+
+// dst = src (count samples, any alignment), adding src to level
+inline void copyAndMeasure (float* dst, const float* src, int32_t count, ChannelLevel& level)
+{
+    LevelDetail::reduce<true> (dst, src, count, level);
+}
+
+inline void measureLevel (const float* x, int32_t count, ChannelLevel& level)
+{
+    LevelDetail::reduce<false> (nullptr, x, count, level);
+}
+
+//------------------------------------------------------------------------
+// LevelMeter — the block accumulators plus meter ballistics: the peak
+// follows instantly and falls by kPeakFallDbPerSecond, the RMS averages
+// the mean square over kRmsSeconds. Audio thread only; the values are
+// published with the instance statistics.
+//------------------------------------------------------------------------
+class LevelMeter
+{
+public:
+    static constexpr int32_t kNumChannels = 2;
+    static constexpr double kPeakFallDbPerSecond = 12.0;     // about IEC 60268-18: 20 dB in 1.7 s
+    static constexpr double kRmsSeconds = 0.3;
+
+    ChannelLevel block[kNumChannels];   // filled by the render loop, cleared by update ()
+
+    void reset ()
+    {
+        for (int32_t c = 0; c < kNumChannels; c++)
+        {
+            block[c] = ChannelLevel ();
+            peak[c] = 0.f;
+            meanSquare[c] = 0.f;
+        }
+    }
+
+    // End of a host block. Meter channels the output does not have show
+    // its first channel (mono output).
+    void update (int32_t numChannels, int32_t numSamples, double sampleRate)
+    {
+        if (numSamples > 0)
+        {
+            const double seconds = numSamples / sampleRate;
+            const float fall = (float)pow (10.0, -kPeakFallDbPerSecond * seconds / 20.0);
+            const float a = (float)(1.0 - exp (-seconds / kRmsSeconds));
+            for (int32_t c = 0; c < kNumChannels; c++)
+            {
+                const ChannelLevel& b = block[c < numChannels ? c : 0];
+                peak[c] = std::max (b.getPeak (), peak[c] * fall);
+                meanSquare[c] += a * (b.getSumSquares () / numSamples - meanSquare[c]);
+            }
+        }
+        for (auto& b : block)
+            b = ChannelLevel ();
+    }
+
+    float getPeak (int32_t channel) const { return peak[channel]; }
+    float getRms (int32_t channel) const { return sqrtf (meanSquare[channel]); }
+
+private:
+    float peak[kNumChannels] = {};
+    float meanSquare[kNumChannels] = {};
+};
+
+} // namespace WineSynth
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "pluginparamids.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Oscillator pair — oscillator 1 (the voice oscillator) with a second
+// oscillator as FM modulator, hard-sync master and ring modulator.
+//
+// Both run in one loop per voice (renderOscPair), so the pair costs a
+// second phase accumulator and a few multiplies, not a second voice.
+// Phases are in cycles (0..1). Step discontinuities — saw and square edges
+// and every sync reset — are corrected with a two-point polynomial BLEP at
+// their sub-sample position. The correction reaches one sample back, so
+// the pair's output is delayed by one sample (held1 / held2).
+//------------------------------------------------------------------------
+struct OscPairState
+{
+    double phase1 = 0.0;
+    double phase2 = 0.0;
+    double held1 = 0.0;     // current sample, output on the next call
+    double held2 = 0.0;
+
+    void reset () { phase1 = phase2 = held1 = held2 = 0.0; }
+};
+
+// Derived from the Osc 2 parameters, shared by all voices
+struct OscPairSettings
+{
+    double ratio2 = 1.0;    // oscillator 2 frequency / oscillator 1 frequency
+    double level2 = 0.0;    // oscillator 2 in the mix
+    double fmIndex = 0.0;   // linear FM: inc1 * (1 + fmIndex * osc2)
+    double ring = 0.0;      // 0 = osc1, 1 = osc1 * osc2
+    bool sync = false;      // oscillator 1 restarts with every cycle of oscillator 2
+
+    bool isActive () const { return level2 > 0.0 || fmIndex > 0.0 || ring > 0.0 || sync; }
+};
+
+//------------------------------------------------------------------------
+// Waveforms on a phase in cycles, with the steps they make when the phase
+// rises through 1 (wrap) and through 1/2 (half)
+//------------------------------------------------------------------------
+// sin (2 pi p) = -sin (2 pi x), x = p - 1/2 folded into [-1/4, 1/4]; odd
+// polynomial to z^11 (error < 1e-7, well below float resolution) instead of
+// a libm call per sample
+struct PairSine
+{
+    static constexpr double kWrapJump = 0.0;
+    static constexpr double kHalfJump = 0.0;
+    static double value (double p)
+    {
+        double x = p - 0.5;
+        double folded = copysign (0.5, x) - x;
+        x = fabs (x) > 0.25 ? folded : x;
+        double z = -2.0 * M_PI * x;
+        double z2 = z * z;
+        return z * (1.0 + z2 * (-1.0 / 6.0 + z2 * (1.0 / 120.0 + z2 * (-1.0 / 5040.0
+                   + z2 * (1.0 / 362880.0 + z2 * (-1.0 / 39916800.0))))));
+    }
+};
+
+// Same approximation as Processor::generateSample (kQualityCheapOscillators)
+struct PairSineFast
+{
+    static constexpr double kWrapJump = 0.0;
+    static constexpr double kHalfJump = 0.0;
+    static double value (double p)
+    {
+        double x = p * 2.0 - 1.0;
+        double y = 4.0 * x * (1.0 - fabs (x));
+        y += 0.225 * (y * fabs (y) - y);
+        return -y;
+    }
+};
+
+struct PairSaw
+{
+    static constexpr double kWrapJump = -2.0;
+    static constexpr double kHalfJump = 0.0;
+    static double value (double p) { return 2.0 * p - 1.0; }
+};
+
+struct PairSquare
+{
+    static constexpr double kWrapJump = 2.0;
+    static constexpr double kHalfJump = -2.0;
+    static double value (double p) { return p < 0.5 ? 1.0 : -1.0; }
+};
+
+struct PairTriangle
+{
+    static constexpr double kWrapJump = 0.0;
+    static constexpr double kHalfJump = 0.0;
+    static double value (double p) { return 4.0 * fabs (p - 0.5) - 1.0; }
+};
+
+// Calls fn with the waveform type (kNumWaveforms = the cheap sine)
+template <typename Fn>
+inline void dispatchPairWave (int32_t waveform, Fn&& fn)
+{
+    switch (waveform)
+    {
+        case kWaveSaw: fn (PairSaw ()); break;
+        case kWaveSquare: fn (PairSquare ()); break;
+        case kWaveTriangle: fn (PairTriangle ()); break;
+        case kNumWaveforms: fn (PairSineFast ()); break;
+        default: fn (PairSine ()); break;
+    }
+}
+
+//------------------------------------------------------------------------
+// BLEP corrections collected during one sample step. A step of height h at
+// position f (0..1 between the previous and the current sample) adds
+// h (1 - f)^2 / 2 to the previous sample and -h f^2 / 2 to the current one.
+//------------------------------------------------------------------------
+struct BlepStep
+{
+    double prev = 0.0;
+    double next = 0.0;
+
+    void add (double f, double h)
+    {
+        prev += 0.5 * h * (1.0 - f) * (1.0 - f);
+        next -= 0.5 * h * f * f;
+    }
+};
+
+// Moves phase by inc over the part [f0, f1] of a sample step (|inc| <= 1/2)
+// and records the waveform's steps. Returns the new phase; *wrapAt receives
+// the position of an upward wrap (else it is left alone).
+template <typename Wave>
+inline double advancePhase (double phase, double inc, double f0, double f1, BlepStep& blep, double* wrapAt = nullptr)
+{
+    double next = phase + inc * (f1 - f0);
+    if (inc > 0.0)
+    {
+        if (Wave::kHalfJump != 0.0 && phase < 0.5 && next >= 0.5)
+            blep.add (f0 + (0.5 - phase) / inc, Wave::kHalfJump);
+        if (next >= 1.0)
+        {
+            double f = f0 + (1.0 - phase) / inc;
+            if (Wave::kWrapJump != 0.0)
+                blep.add (f, Wave::kWrapJump);
+            if (wrapAt)
+                *wrapAt = f;
+            next -= 1.0;
+        }
+    }
+    else if (inc < 0.0)
+    {
+        // Through-zero FM: the phase runs backwards, steps flip sign
+        if (Wave::kHalfJump != 0.0 && phase >= 0.5 && next < 0.5)
+            blep.add (f0 + (phase - 0.5) / -inc, -Wave::kHalfJump);
+        if (next < 0.0)
+        {
+            if (Wave::kWrapJump != 0.0)
+                blep.add (f0 + phase / -inc, -Wave::kWrapJump);
+            next += 1.0;
+        }
+    }
+    return next;
+}
+
+//------------------------------------------------------------------------
+// Renders numSamples of the pair into out (overwritten). inc1 is
+// oscillator 1's increment in cycles per sample.
+//------------------------------------------------------------------------
+template <typename Wave1, typename Wave2>
+inline void renderOscPair (OscPairState& st, const OscPairSettings& settings, double inc1, float* out,
+                           int32_t numSamples)
+{
+    const double inc2 = std::min (inc1 * settings.ratio2, 0.5);
+    const double fmDepth = inc1 * settings.fmIndex;
+    const double level2 = settings.level2;
+    const double ring = settings.ring;
+    const bool sync = settings.sync;
+
+    double phase1 = st.phase1;
+    double phase2 = st.phase2;
+    double held1 = st.held1;
+    double held2 = st.held2;
+
+    for (int32_t s = 0; s < numSamples; s++)
+    {
+        // Oscillator 2 (master)
+        BlepStep blep2;
+        double wrapAt = -1.0;
+        phase2 = advancePhase<Wave2> (phase2, inc2, 0.0, 1.0, blep2, &wrapAt);
+        const double v2 = Wave2::value (phase2);
+
+        // Oscillator 1, frequency modulated through zero
+        const double inc = std::max (-0.5, std::min (0.5, inc1 + fmDepth * v2));
+        BlepStep blep1;
+        if (sync && wrapAt >= 0.0)
+        {
+            phase1 = advancePhase<Wave1> (phase1, inc, 0.0, wrapAt, blep1);
+            blep1.add (wrapAt, Wave1::value (0.0) - Wave1::value (phase1));
+            phase1 = advancePhase<Wave1> (0.0, inc, wrapAt, 1.0, blep1);
+        }
+        else
+        {
+            phase1 = advancePhase<Wave1> (phase1, inc, 0.0, 1.0, blep1);
+        }
+
+        const double o1 = held1 + blep1.prev;
+        const double o2 = held2 + blep2.prev;
+        held1 = Wave1::value (phase1) + blep1.next;
+        held2 = v2 + blep2.next;
+
+        out[s] = (float)(o1 + ring * (o1 * o2 - o1) + level2 * o2);
+    }
+
+    st.phase1 = phase1;
+    st.phase2 = phase2;
+    st.held1 = held1;
+    st.held2 = held2;
+}
+
+} // namespace WineSynth
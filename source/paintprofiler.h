@@ -0,0 +1,317 @@
+#pragma once
+
+#include "vstgui/lib/cframe.h"
+#include "vstgui/lib/cview.h"
+#include "vstgui/lib/controls/ccontrol.h"
+#include "vstgui/lib/cdrawcontext.h"
+#include "vstgui/lib/ccolor.h"
+#include "vstgui/lib/cfont.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace VSTGUI;
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// PaintProfiler — draw cost per kind of view, paint passes and
+// invalidations, for the hidden diagnostics overlay. GUI thread only.
+//
+// Views time their draw () with PaintProfiler::Scope; ProfiledFrame counts
+// paint passes (drawRect) and invalidations. Counters are collected over a
+// window of at least kWindowSeconds and published as a Report when the
+// window closes. While disabled a scope costs a frame lookup and a branch.
+//------------------------------------------------------------------------
+class PaintProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum ViewKind
+    {
+        kKnobs,
+        kWaveButtons,
+        kTextButtons,
+        kWaveDisplay,
+        kOscilloscope,
+        kSpectrum,
+        kMeter,
+        kKeyboard,
+        kNumViewKinds
+    };
+
+    static constexpr double kWindowSeconds = 0.5;
+
+    struct Report
+    {
+        double lastMs = 0.0;
+        double avgMs = 0.0;
+        double maxMs = 0.0;
+        double drawsPerSecond = 0.0;
+    };
+
+    static const char* getName (ViewKind kind)
+    {
+        static const char* const names[kNumViewKinds] = {
+            "Knobs", "Wave buttons", "Text buttons", "Wave display", "Oscilloscope", "Spectrum",
+            "Meter", "Keyboard"};
+        return names[kind];
+    }
+
+    bool isEnabled () const { return enabled; }
+
+    void setEnabled (bool state)
+    {
+        enabled = state;
+        for (auto& k : kinds)
+            k = {};
+        frames = 0;
+        invalidations = 0;
+        frameRate = 0.0;
+        invalidationRate = 0.0;
+        windowStart = Clock::now ();
+    }
+
+    void addDraw (ViewKind kind, double ms)
+    {
+        auto& k = kinds[kind];
+        k.report.lastMs = ms;
+        k.sumMs += ms;
+        k.maxMs = std::max (k.maxMs, ms);
+        k.draws++;
+    }
+
+    void addFrame ()
+    {
+        if (enabled)
+            frames++;
+    }
+
+    void addInvalidation ()
+    {
+        if (enabled && countInvalidations)
+            invalidations++;
+    }
+
+    // Invalidations made by the overlay itself are not counted
+    void setCountInvalidations (bool state) { countInvalidations = state; }
+
+    // Closes the window once it is long enough; returns true when the
+    // reports changed
+    bool update ()
+    {
+        if (!enabled)
+            return false;
+
+        auto now = Clock::now ();
+        double seconds = std::chrono::duration<double> (now - windowStart).count ();
+        if (seconds < kWindowSeconds)
+            return false;
+
+        for (auto& k : kinds)
+        {
+            k.report.avgMs = k.draws ? k.sumMs / k.draws : 0.0;
+            k.report.maxMs = k.maxMs;
+            k.report.drawsPerSecond = k.draws / seconds;
+            k.sumMs = 0.0;
+            k.maxMs = 0.0;
+            k.draws = 0;
+        }
+        frameRate = frames / seconds;
+        invalidationRate = invalidations / seconds;
+        frames = 0;
+        invalidations = 0;
+        windowStart = now;
+        return true;
+    }
+
+    const Report& getReport (ViewKind kind) const { return kinds[kind].report; }
+    double getFrameRate () const { return frameRate; }
+    double getInvalidationRate () const { return invalidationRate; }
+
+    // Profiler of the ProfiledFrame a view is attached to, or nullptr
+    static PaintProfiler* of (CView* view);
+
+    // Times one draw () call
+    class Scope
+    {
+    public:
+        Scope (CView* view, ViewKind kind)
+            : profiler (of (view))
+            , kind (kind)
+        {
+            if (profiler && profiler->enabled)
+                start = Clock::now ();
+            else
+                profiler = nullptr;
+        }
+
+        ~Scope ()
+        {
+            if (profiler)
+                profiler->addDraw (kind, std::chrono::duration<double, std::milli> (Clock::now () - start).count ());
+        }
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+
+    private:
+        PaintProfiler* profiler;
+        ViewKind kind;
+        Clock::time_point start;
+    };
+
+private:
+    struct KindStats
+    {
+        Report report;          // last closed window (lastMs is live)
+        double sumMs = 0.0;     // current window
+        double maxMs = 0.0;
+        int32_t draws = 0;
+    };
+
+    bool enabled = false;
+    bool countInvalidations = true;
+    KindStats kinds[kNumViewKinds];
+    int32_t frames = 0;
+    int32_t invalidations = 0;
+    double frameRate = 0.0;
+    double invalidationRate = 0.0;
+    Clock::time_point windowStart = Clock::now ();
+};
+
+//------------------------------------------------------------------------
+// ProfiledFrame — CFrame that feeds its PaintProfiler with paint passes
+// and invalidations
+//------------------------------------------------------------------------
+class ProfiledFrame : public CFrame
+{
+public:
+    ProfiledFrame (const CRect& size, VSTGUIEditorInterface* editor)
+        : CFrame (size, editor)
+    {
+    }
+
+    void drawRect (CDrawContext* context, const CRect& updateRect) override
+    {
+        profiler.addFrame ();
+        CFrame::drawRect (context, updateRect);
+    }
+
+    void invalidRect (const CRect& rect) override
+    {
+        profiler.addInvalidation ();
+        CFrame::invalidRect (rect);
+    }
+
+    PaintProfiler& getProfiler () { return profiler; }
+
+private:
+    PaintProfiler profiler;
+};
+
+inline PaintProfiler* PaintProfiler::of (CView* view)
+{
+    auto* frame = dynamic_cast<ProfiledFrame*> (view->getFrame ());
+    return frame ? &frame->getProfiler () : nullptr;
+}
+
+//------------------------------------------------------------------------
+// PaintProfilerOverlay — translucent table of the profiler's reports.
+// Hidden by default, ignores the mouse; refresh () is polled by the
+// editor's display timer.
+//------------------------------------------------------------------------
+class PaintProfilerOverlay : public CView
+{
+public:
+    static constexpr CCoord kLineHeight = 14;
+    static constexpr CCoord kHeight = (PaintProfiler::kNumViewKinds + 2) * kLineHeight + 8;
+
+    PaintProfilerOverlay (const CRect& size)
+        : CView (size)
+    {
+        setMouseEnabled (false);
+        setVisible (false);
+    }
+
+    void refresh ()
+    {
+        auto* profiler = PaintProfiler::of (this);
+        if (!profiler || !isVisible () || !profiler->update ())
+            return;
+
+        profiler->setCountInvalidations (false);
+        invalid ();
+        profiler->setCountInvalidations (true);
+    }
+
+    void draw (CDrawContext* context) override
+    {
+        auto* profiler = PaintProfiler::of (this);
+        if (!profiler)
+            return;
+
+        auto r = getViewSize ();
+        context->setFillColor (CColor (0, 0, 0, 200));
+        context->drawRect (r, kDrawFilled);
+        context->setFont (kNormalFontSmall);
+        context->setFontColor (CColor (255, 220, 100, 255));
+
+        char line[128];
+        CRect row (r.left + 6, r.top + 4, r.right - 6, r.top + 4 + kLineHeight);
+        auto drawLine = [&] () {
+            context->drawString (line, row, kLeftText);
+            row.offset (0, kLineHeight);
+        };
+
+        snprintf (line, sizeof (line), "%.1f paints/s   %.1f invalidations/s",
+                  profiler->getFrameRate (), profiler->getInvalidationRate ());
+        drawLine ();
+        snprintf (line, sizeof (line), "%-14s %8s %8s %8s %8s", "view", "last ms", "avg ms", "max ms", "draws/s");
+        drawLine ();
+
+        for (int32_t i = 0; i < PaintProfiler::kNumViewKinds; i++)
+        {
+            auto kind = (PaintProfiler::ViewKind)i;
+            const auto& report = profiler->getReport (kind);
+            snprintf (line, sizeof (line), "%-14s %8.3f %8.3f %8.3f %8.1f", PaintProfiler::getName (kind),
+                      report.lastMs, report.avgMs, report.maxMs, report.drawsPerSecond);
+            drawLine ();
+        }
+
+        setDirty (false);
+    }
+
+    CLASS_METHODS (PaintProfilerOverlay, CView)
+};
+
+//------------------------------------------------------------------------
+// HiddenButton — invisible control that fires valueChanged () on a
+// double click (used for the diagnostics toggle)
+//------------------------------------------------------------------------
+class HiddenButton : public CControl
+{
+public:
+    HiddenButton (const CRect& r, IControlListener* listener, int32_t tag)
+        : CControl (r, listener, tag)
+    {
+    }
+
+    void draw (CDrawContext*) override { setDirty (false); }
+
+    CMouseEventResult onMouseDown (CPoint& where, const CButtonState& buttons) override
+    {
+        if (!buttons.isLeftButton () || !buttons.isDoubleClick ())
+            return kMouseEventNotHandled;
+
+        setValue (getValue () > 0.5f ? 0.f : 1.f);
+        valueChanged ();
+        return kMouseEventHandled;
+    }
+
+    CLASS_METHODS (HiddenButton, CControl)
+};
+
+} // namespace WineSynth
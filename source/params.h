@@ -0,0 +1,323 @@
+#pragma once
+
+#include "pluginparamids.h"
+#include "filter.h"
+#include "shaper.h"
+#include "effects.h"
+#include "governor.h"
+
+#include "pluginterfaces/vst/vsttypes.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "base/source/fstreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Parameter descriptor table
+//
+// Single source for parameter registration (Controller::initialize), queue
+// dispatch and state I/O (Processor, Controller::setComponentState) and the
+// normalized → plain mappings used by the DSP and the editor displays.
+// Entry N describes parameter ID N, so dispatch is a direct index.
+//------------------------------------------------------------------------
+enum class ParamScale
+{
+    kLinear,        // min + (max - min) * x
+    kExponential,   // min * (max / min)^x
+    kQuadratic,     // min + (max - min) * x^2
+    kList,          // discrete index 0..stepCount
+    kInteger,       // integer range min..max (stepCount = max - min)
+};
+
+enum class ParamStorage
+{
+    kNone,          // not part of the component state (GUI-only)
+    kFloat,         // normalized value as float
+    kInt32,         // discrete index as int32
+};
+
+struct ParamDesc
+{
+    Steinberg::Vst::ParamID id;
+    const Steinberg::Vst::TChar* title;
+    const Steinberg::Vst::TChar* units;
+    double defaultNormalized;
+    int32_t stepCount;
+    int32_t flags;
+    ParamScale scale;
+    double minPlain;
+    double maxPlain;
+    ParamStorage storage;
+    const Steinberg::Vst::TChar* const* listNames;
+};
+
+static constexpr const Steinberg::Vst::TChar* kWaveformNames[kNumWaveforms] = {
+    STR16 ("Sine"), STR16 ("Saw"), STR16 ("Square"), STR16 ("Triangle"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kOscModeNames[kNumOscModes] = {
+    STR16 ("Classic"), STR16 ("Additive"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kStealModeNames[] = {
+    STR16 ("Oldest"), STR16 ("Quietest"), STR16 ("Same Note"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kFilterModeNames[kNumFilterModes] = {
+    STR16 ("Low Pass"), STR16 ("Band Pass"), STR16 ("High Pass"), STR16 ("Notch"), STR16 ("Peak"), STR16 ("Ladder"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kDriveTypeNames[kNumShaperTypes] = {
+    STR16 ("Soft"), STR16 ("Hard"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kDelayTimeNames[kNumDelayDivisions] = {
+    STR16 ("1/16"), STR16 ("1/8T"), STR16 ("1/8"), STR16 ("1/8."), STR16 ("1/4"), STR16 ("1/4."), STR16 ("1/2"), STR16 ("1/1"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kOffOnNames[] = {
+    STR16 ("Off"), STR16 ("On"),
+};
+
+static constexpr const Steinberg::Vst::TChar* kQualityLevelNames[kNumQualityLevels] = {
+    STR16 ("Full"), STR16 ("Cheap Oscillators"), STR16 ("Half Voices"), STR16 ("Quarter Voices"),
+};
+
+static constexpr int32_t kAutomate = Steinberg::Vst::ParameterInfo::kCanAutomate;
+static constexpr int32_t kListFlags = kAutomate | Steinberg::Vst::ParameterInfo::kIsList;
+static constexpr int32_t kBypassFlags = kAutomate | Steinberg::Vst::ParameterInfo::kIsBypass;
+static constexpr int32_t kStatusFlags = Steinberg::Vst::ParameterInfo::kIsReadOnly | Steinberg::Vst::ParameterInfo::kIsList;
+static constexpr int32_t kSettingFlags = 0;   // saved with the state, not automatable
+
+// clang-format off
+static constexpr ParamDesc kParamTable[] = {
+//    id                title                     units           default  steps  flags         scale                     min     max       storage                listNames
+    { kGainId,          STR16 ("Gain"),           nullptr,        0.5,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kCutoffId,        STR16 ("Cutoff"),         STR16 ("Hz"),   1.0,     0,     kAutomate,    ParamScale::kExponential, 20.0,   20000.0,  ParamStorage::kFloat,  nullptr },
+    { kFineId,          STR16 ("Fine"),           STR16 ("ct"),   0.5,     0,     kAutomate,    ParamScale::kLinear,      -100.0, 100.0,    ParamStorage::kFloat,  nullptr },
+    { kResonanceId,     STR16 ("Resonance"),      nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kWaveformId,      STR16 ("Waveform"),       nullptr,        0.0,     kNumWaveforms - 1, kListFlags, ParamScale::kList, 0.0, kNumWaveforms - 1, ParamStorage::kInt32, kWaveformNames },
+    { kAttackId,        STR16 ("Attack"),         STR16 ("ms"),   0.05,    0,     kAutomate,    ParamScale::kQuadratic,   1.0,    1000.0,   ParamStorage::kFloat,  nullptr },
+    { kReleaseId,       STR16 ("Release"),        STR16 ("ms"),   0.3,     0,     kAutomate,    ParamScale::kQuadratic,   10.0,   3000.0,   ParamStorage::kFloat,  nullptr },
+    { kBypassId,        STR16 ("Bypass"),         nullptr,        0.0,     1,     kBypassFlags, ParamScale::kList,        0.0,    1.0,      ParamStorage::kInt32,  nullptr },
+    // GUI keyboard note (0=off, 1-12 = C4-B4) — not automatable, not saved
+    { kKeyboardNoteId,  STR16 ("KeyboardNote"),   nullptr,        0.0,     12,    0,            ParamScale::kList,        0.0,    12.0,     ParamStorage::kNone,   nullptr },
+    { kHoldId,          STR16 ("Hold"),           STR16 ("ms"),   0.0,     0,     kAutomate,    ParamScale::kQuadratic,   0.0,    1000.0,   ParamStorage::kFloat,  nullptr },
+    { kDecayId,         STR16 ("Decay"),          STR16 ("ms"),   0.3,     0,     kAutomate,    ParamScale::kQuadratic,   5.0,    5000.0,   ParamStorage::kFloat,  nullptr },
+    { kSustainId,       STR16 ("Sustain"),        nullptr,        1.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kPolyphonyId,     STR16 ("Voices"),         nullptr,        7.0 / 63.0, 63, kAutomate,    ParamScale::kInteger,     1.0,    64.0,     ParamStorage::kInt32,  nullptr },
+    { kStealModeId,     STR16 ("Voice Steal"),    nullptr,        0.0,     2,     kListFlags,   ParamScale::kList,        0.0,    2.0,      ParamStorage::kInt32,  kStealModeNames },
+    // Pitch bend is performance data, not part of the preset
+    { kPitchBendId,     STR16 ("Pitch Bend"),     nullptr,        0.5,     0,     kAutomate,    ParamScale::kLinear,      -1.0,   1.0,      ParamStorage::kNone,   nullptr },
+    { kBendRangeId,     STR16 ("Bend Range"),     STR16 ("st"),   2.0 / 24.0, 24, kAutomate,    ParamScale::kInteger,     0.0,    24.0,     ParamStorage::kInt32,  nullptr },
+    { kFilterModeId,    STR16 ("Filter Mode"),    nullptr,        0.0,     kNumFilterModes - 1, kListFlags, ParamScale::kList, 0.0, kNumFilterModes - 1, ParamStorage::kInt32, kFilterModeNames },
+    { kDriveId,         STR16 ("Drive"),          STR16 ("dB"),   0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    24.0,     ParamStorage::kFloat,  nullptr },
+    { kDriveTypeId,     STR16 ("Drive Type"),     nullptr,        0.0,     kNumShaperTypes - 1, kListFlags, ParamScale::kList, 0.0, kNumShaperTypes - 1, ParamStorage::kInt32, kDriveTypeNames },
+    { kChorusMixId,     STR16 ("Chorus Mix"),     nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kChorusRateId,    STR16 ("Chorus Rate"),    STR16 ("Hz"),   0.5,     0,     kAutomate,    ParamScale::kExponential, 0.1,    5.0,      ParamStorage::kFloat,  nullptr },
+    { kChorusDepthId,   STR16 ("Chorus Depth"),   nullptr,        0.5,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kDelayMixId,      STR16 ("Delay Mix"),      nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kDelayTimeId,     STR16 ("Delay Time"),     nullptr,        4.0 / 7.0, kNumDelayDivisions - 1, kListFlags, ParamScale::kList, 0.0, kNumDelayDivisions - 1, ParamStorage::kInt32, kDelayTimeNames },
+    { kDelayFeedbackId, STR16 ("Delay Feedback"), nullptr,        0.4,     0,     kAutomate,    ParamScale::kLinear,      0.0,    0.95,     ParamStorage::kFloat,  nullptr },
+    { kReverbMixId,     STR16 ("Reverb Mix"),     nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    // Reported by the processor, not saved
+    { kQualityLevelId,  STR16 ("CPU Quality"),    nullptr,        0.0,     kNumQualityLevels - 1, kStatusFlags, ParamScale::kList, 0.0, kNumQualityLevels - 1, ParamStorage::kNone, kQualityLevelNames },
+    { kUnisonVoicesId,  STR16 ("Unison"),         nullptr,        0.0,     15,    kAutomate,    ParamScale::kInteger,     1.0,    16.0,     ParamStorage::kInt32,  nullptr },
+    { kUnisonDetuneId,  STR16 ("Unison Detune"),  STR16 ("ct"),   0.25,    0,     kAutomate,    ParamScale::kLinear,      0.0,    100.0,    ParamStorage::kFloat,  nullptr },
+    { kUnisonSpreadId,  STR16 ("Unison Spread"),  nullptr,        0.5,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    // Oscillator 2 (single-oscillator voices; unison and additive ignore it)
+    { kOsc2WaveformId,  STR16 ("Osc 2 Wave"),     nullptr,        0.0,     kNumWaveforms - 1, kListFlags, ParamScale::kList, 0.0, kNumWaveforms - 1, ParamStorage::kInt32, kWaveformNames },
+    { kOsc2PitchId,     STR16 ("Osc 2 Pitch"),    STR16 ("st"),   0.5,     48,    kAutomate,    ParamScale::kInteger,     -24.0,  24.0,     ParamStorage::kInt32,  nullptr },
+    { kOsc2FineId,      STR16 ("Osc 2 Fine"),     STR16 ("ct"),   0.5,     0,     kAutomate,    ParamScale::kLinear,      -100.0, 100.0,    ParamStorage::kFloat,  nullptr },
+    { kOsc2LevelId,     STR16 ("Osc 2 Level"),    nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kFmDepthId,       STR16 ("FM Depth"),       nullptr,        0.0,     0,     kAutomate,    ParamScale::kQuadratic,   0.0,    8.0,      ParamStorage::kFloat,  nullptr },
+    { kRingModId,       STR16 ("Ring Mod"),       nullptr,        0.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    { kSyncId,          STR16 ("Sync"),           nullptr,        0.0,     1,     kListFlags,   ParamScale::kList,        0.0,    1.0,      ParamStorage::kInt32,  kOffOnNames },
+    // Additive oscillator mode
+    { kPartialsId,      STR16 ("Partials"),       nullptr,        63.0 / 255.0, 255, kAutomate, ParamScale::kInteger,     1.0,    256.0,    ParamStorage::kInt32,  nullptr },
+    { kSpectralTiltId,  STR16 ("Spectral Tilt"),  nullptr,        0.5,     0,     kAutomate,    ParamScale::kLinear,      0.0,    2.0,      ParamStorage::kFloat,  nullptr },
+    { kEvenPartialsId,  STR16 ("Even Partials"),  nullptr,        1.0,     0,     kAutomate,    ParamScale::kLinear,      0.0,    1.0,      ParamStorage::kFloat,  nullptr },
+    // Takes effect when the host next activates the plug-in
+    { kRenderThreadsId, STR16 ("Render Threads"), nullptr,        0.0,     15,    kSettingFlags, ParamScale::kInteger,    1.0,    16.0,     ParamStorage::kInt32,  nullptr },
+    { kOscModeId,       STR16 ("Osc Mode"),       nullptr,        0.0,     kNumOscModes - 1, kListFlags, ParamScale::kList, 0.0, kNumOscModes - 1, ParamStorage::kInt32, kOscModeNames },
+};
+// clang-format on
+
+static constexpr int32_t kNumParams = (int32_t)(sizeof (kParamTable) / sizeof (kParamTable[0]));
+
+// Number of values stored by WineSynth 1.0 (Gain .. Bypass). Later versions
+// follow them with an int32 count and the values of appended parameters.
+static constexpr int32_t kNumV1StateValues = 8;
+
+constexpr bool isParamTableDense ()
+{
+    for (int32_t i = 0; i < kNumParams; i++)
+        if (kParamTable[i].id != (Steinberg::Vst::ParamID)i)
+            return false;
+    return true;
+}
+
+static_assert (isParamTableDense (), "kParamTable entry N must describe parameter ID N");
+static_assert (kNumParams <= 64, "ParamMask holds one bit per parameter");
+
+//------------------------------------------------------------------------
+// One bit per parameter, used to track which inputs of a derived value changed
+//------------------------------------------------------------------------
+using ParamMask = uint64_t;
+
+constexpr ParamMask paramBit (Steinberg::Vst::ParamID id) { return ParamMask (1) << id; }
+
+static constexpr ParamMask kAllParams = ~ParamMask (0);
+
+inline const ParamDesc* findParam (Steinberg::Vst::ParamID id)
+{
+    return id < (Steinberg::Vst::ParamID)kNumParams ? &kParamTable[id] : nullptr;
+}
+
+//------------------------------------------------------------------------
+// Normalized ↔ plain conversion
+//------------------------------------------------------------------------
+inline int32_t toIndex (const ParamDesc& p, double normalized)
+{
+    return std::min<int32_t> (p.stepCount, (int32_t)(normalized * (p.stepCount + 1)));
+}
+
+inline double fromIndex (const ParamDesc& p, int32_t index)
+{
+    if (p.stepCount <= 0)
+        return 0.0;
+    index = std::max<int32_t> (0, std::min<int32_t> (p.stepCount, index));
+    return (double)index / (double)p.stepCount;
+}
+
+inline double toPlain (const ParamDesc& p, double normalized)
+{
+    switch (p.scale)
+    {
+        case ParamScale::kExponential:
+            return p.minPlain * pow (p.maxPlain / p.minPlain, normalized);
+        case ParamScale::kQuadratic:
+            return p.minPlain + (p.maxPlain - p.minPlain) * normalized * normalized;
+        case ParamScale::kList:
+        case ParamScale::kInteger:
+            return p.minPlain + (double)toIndex (p, normalized);
+        case ParamScale::kLinear:
+        default:
+            return p.minPlain + (p.maxPlain - p.minPlain) * normalized;
+    }
+}
+
+inline double toPlain (Steinberg::Vst::ParamID id, double normalized)
+{
+    return toPlain (kParamTable[id], normalized);
+}
+
+//------------------------------------------------------------------------
+// Component state I/O
+//
+// Layout: the 1.0 values (Gain .. Bypass), then an int32 count followed by
+// that many values of parameters appended since. A 1.0 stream ends after the
+// first block; values from newer versions beyond the table are skipped, so
+// data written after the parameters stays readable.
+//------------------------------------------------------------------------
+inline bool readParamValue (Steinberg::IBStreamer& streamer, const ParamDesc& p, double& normalized)
+{
+    if (p.storage == ParamStorage::kFloat)
+    {
+        float f;
+        if (!streamer.readFloat (f))
+            return false;
+        normalized = f;
+    }
+    else
+    {
+        Steinberg::int32 i;
+        if (!streamer.readInt32 (i))
+            return false;
+        normalized = fromIndex (p, i);
+    }
+    return true;
+}
+
+constexpr int32_t countStoredParams ()
+{
+    int32_t n = 0;
+    for (const auto& p : kParamTable)
+        if (p.storage != ParamStorage::kNone)
+            n++;
+    return n;
+}
+
+static constexpr int32_t kNumStateValues = countStoredParams ();
+
+// setter (ParamID, double normalized) is called for every stored
+// parameter: with the value read, or with its default when the stream is
+// older than the parameter, so nothing keeps the instance's previous value
+template <typename Setter>
+bool readParamState (Steinberg::IBStreamer& streamer, Setter&& setter)
+{
+    int32_t index = 0;
+    int32_t numStored = kNumV1StateValues;
+    bool countRead = false;
+    for (const auto& p : kParamTable)
+    {
+        if (p.storage == ParamStorage::kNone)
+            continue;
+
+        if (index == kNumV1StateValues && !countRead)
+        {
+            countRead = true;
+            Steinberg::int32 numAppended;
+            if (streamer.readInt32 (numAppended))   // absent in 1.0 streams
+                numStored += std::max<Steinberg::int32> (numAppended, 0);
+        }
+        if (index >= numStored)
+        {
+            setter (p.id, p.defaultNormalized);
+            continue;
+        }
+
+        double normalized;
+        if (!readParamValue (streamer, p, normalized))
+            return false;
+        setter (p.id, normalized);
+        index++;
+    }
+
+    // Values of parameters this version does not know (all 32 bit)
+    for (; index < numStored; index++)
+    {
+        Steinberg::int32 unused;
+        if (!streamer.readInt32 (unused))
+            return false;
+    }
+    return true;
+}
+
+// getter (ParamID) returns the normalized value to store
+template <typename Getter>
+void writeParamState (Steinberg::IBStreamer& streamer, Getter&& getter)
+{
+    int32_t index = 0;
+    for (const auto& p : kParamTable)
+    {
+        if (p.storage == ParamStorage::kNone)
+            continue;
+
+        if (index == kNumV1StateValues)
+            streamer.writeInt32 (kNumStateValues - kNumV1StateValues);
+
+        double normalized = getter (p.id);
+        if (p.storage == ParamStorage::kFloat)
+            streamer.writeFloat ((float)normalized);
+        else
+            streamer.writeInt32 (toIndex (p, normalized));
+        index++;
+    }
+}
+
+} // namespace WineSynth
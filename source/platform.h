@@ -0,0 +1,37 @@
+#pragma once
+
+namespace VSTGUI { class CFrame; }
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// HostWindowFixes — per-platform workarounds applied to the host's parent
+// window once the editor frame is open.
+//
+// Win32 / Wine (platformwin32.cpp):
+//   - the parent HWND is subclassed to swallow WM_ERASEBKGND, so the host's
+//     background brush does not flash white before the first D2D1 paint
+//   - a full redraw is scheduled 100 ms after opening, because under Wine
+//     the first WM_PAINT arrives before D2D1 is ready
+//
+// Linux / X11 (platformlinux.cpp): nothing to do.
+//------------------------------------------------------------------------
+class HostWindowFixes
+{
+public:
+    HostWindowFixes () = default;
+    ~HostWindowFixes () { detach (); }
+
+    HostWindowFixes (const HostWindowFixes&) = delete;
+    HostWindowFixes& operator= (const HostWindowFixes&) = delete;
+
+    // parent is the native handle passed to IPlugView::attached
+    void attach (void* parent, VSTGUI::CFrame* frame);
+    void detach ();
+
+private:
+    void* parentWindow = nullptr;
+    void* origWindowProc = nullptr;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,19 @@
+#include "platform.h"
+
+namespace WineSynth {
+
+// VSTGUI's X11 / Cairo backend needs none of the Win32 / Wine workarounds
+
+void HostWindowFixes::attach (void* parent, VSTGUI::CFrame* frame)
+{
+    (void)parent;
+    (void)frame;
+}
+
+void HostWindowFixes::detach ()
+{
+    parentWindow = nullptr;
+    origWindowProc = nullptr;
+}
+
+} // namespace WineSynth
@@ -0,0 +1,71 @@
+#include "platform.h"
+
+#include "vstgui/lib/cframe.h"
+#include "vstgui/lib/cvstguitimer.h"
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+namespace WineSynth {
+
+namespace {
+
+const char* const kEditorProp = "WineSynthEditor";
+
+// WM_ERASEBKGND subclass for the parent HWND (Wine white-on-open fix)
+LRESULT CALLBACK parentSubclassProc (HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    auto* origProc = (WNDPROC)GetPropA (hwnd, kEditorProp);
+
+    if (msg == WM_ERASEBKGND)
+        return 1;
+
+    if (origProc)
+        return CallWindowProcA (origProc, hwnd, msg, wParam, lParam);
+
+    return DefWindowProcA (hwnd, msg, wParam, lParam);
+}
+
+} // namespace
+
+void HostWindowFixes::attach (void* parent, VSTGUI::CFrame* frame)
+{
+    detach ();
+
+    // Reaper's FX panel has a white background brush that shows through
+    // before VSTGUI's child window completes its first D2D1 paint.
+    HWND hwnd = (HWND)parent;
+    if (hwnd)
+    {
+        auto origProc = (WNDPROC)GetWindowLongPtrA (hwnd, GWLP_WNDPROC);
+        SetPropA (hwnd, kEditorProp, (HANDLE)origProc);
+        SetWindowLongPtrA (hwnd, GWLP_WNDPROC, (LONG_PTR)parentSubclassProc);
+        parentWindow = hwnd;
+        origWindowProc = (void*)origProc;
+    }
+
+    // Under Wine, the initial WM_PAINT arrives before D2D1 is fully
+    // initialized, leaving framebuffer garbage visible. Schedule a
+    // delayed full redraw to ensure proper rendering.
+    if (frame)
+    {
+        VSTGUI::SharedPointer<VSTGUI::CFrame> f (frame);
+        VSTGUI::Call::later ([f] () { f->invalid (); }, 100);
+    }
+}
+
+void HostWindowFixes::detach ()
+{
+    if (parentWindow && origWindowProc)
+    {
+        HWND hwnd = (HWND)parentWindow;
+        SetWindowLongPtrA (hwnd, GWLP_WNDPROC, (LONG_PTR)origWindowProc);
+        RemovePropA (hwnd, kEditorProp);
+    }
+    parentWindow = nullptr;
+    origWindowProc = nullptr;
+}
+
+} // namespace WineSynth
@@ -10,4 +10,16 @@ namespace WineSynth {
 static const Steinberg::FUID ProcessorUID  (0x2B3C4D5E, 0x6F7A8B9C, 0x0D1E2F3A, 0x4B5C6D7E);
 static const Steinberg::FUID ControllerUID (0x8F9A0B1C, 0x2D3E4F5A, 0x6B7C8D9E, 0x0F1A2B3C);
 
+// Controller → Processor messages
+// LoadTuning: binary attributes "scl" / "kbm" (file contents, empty = default)
+static const char* const kMsgLoadTuning = "LoadTuning";
+// LoadImpulse: binary attribute "path" (UTF-8 path of a WAV file, empty = none)
+static const char* const kMsgLoadImpulse = "LoadImpulse";
+// ChannelName: binary attribute "name" (UTF-8 host track name, for the instance list)
+static const char* const kMsgChannelName = "ChannelName";
+
+// Processor → Controller messages
+// InstanceId: int attribute "id" (the processor's row in the instance statistics)
+static const char* const kMsgInstanceId = "InstanceId";
+
 } // namespace WineSynth
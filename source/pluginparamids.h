@@ -10,7 +10,45 @@ enum {
     kReleaseId,
     kBypassId,
     kKeyboardNoteId,   // GUI keyboard note (0=off, 1-12=note C4-B4)
-    kKeyboardTag = 100
+    kHoldId,
+    kDecayId,
+    kSustainId,
+    kPolyphonyId,      // 1..64 voices
+    kStealModeId,      // VoiceManager::StealPolicy
+    kPitchBendId,      // MIDI pitch bend (via IMidiMapping), 0.5 = center
+    kBendRangeId,      // 0..24 semitones
+    kFilterModeId,     // FilterMode
+    kDriveId,          // 0..24 dB, 0 = linear path
+    kDriveTypeId,      // ShaperType
+    kChorusMixId,      // 0 = chorus off
+    kChorusRateId,
+    kChorusDepthId,
+    kDelayMixId,       // 0 = delay off
+    kDelayTimeId,      // DelayDivision, synced to host tempo
+    kDelayFeedbackId,
+    kReverbMixId,      // 0 = reverb off
+    kQualityLevelId,   // QualityLevel chosen by the CPU governor (read-only)
+    kUnisonVoicesId,   // 1..16 oscillators per voice
+    kUnisonDetuneId,   // 0..100 ct between the outermost oscillators
+    kUnisonSpreadId,   // stereo width of the unison stack
+    kOsc2WaveformId,   // WaveformType of oscillator 2
+    kOsc2PitchId,      // -24..+24 semitones from oscillator 1
+    kOsc2FineId,       // -100..+100 ct
+    kOsc2LevelId,      // oscillator 2 in the mix, 0 = silent
+    kFmDepthId,        // linear FM of oscillator 1 by oscillator 2
+    kRingModId,        // 0 = osc1, 1 = osc1 * osc2
+    kSyncId,           // hard sync of oscillator 1 to oscillator 2
+    kPartialsId,       // 1..256 partials of the additive waveform
+    kSpectralTiltId,   // additive partial n at n^-tilt, tilt 0..2
+    kEvenPartialsId,   // level of the even additive partials
+    kRenderThreadsId,  // 1..16 voice render threads, 1 = audio thread only
+    kOscModeId,        // OscMode of oscillator 1
+    kKeyboardTag = 100,
+    kLoadScaleTag,
+    kResetTuningTag,
+    kLoadImpulseTag,
+    kProfilerTag,
+    kInstancesTag
 };
 
 enum WaveformType {
@@ -20,3 +58,9 @@ enum WaveformType {
     kWaveTriangle,
     kNumWaveforms
 };
+
+enum OscMode {
+    kOscModeClassic = 0,   // kWaveformId, unison and oscillator 2
+    kOscModeAdditive,      // additive partials; replaces all three
+    kNumOscModes
+};
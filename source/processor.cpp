@@ -1,14 +1,25 @@
 #include "processor.h"
 #include "plugincids.h"
 #include "pluginparamids.h"
+#include "rtcheck.h"
+#include "trace.h"
 
 #include "pluginterfaces/base/ibstream.h"
 #include "pluginterfaces/vst/ivstparameterchanges.h"
 #include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstmessage.h"
+#include "pluginterfaces/vst/ivstprocesscontext.h"
 #include "base/source/fstreamer.h"
 
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define WINESYNTH_HAS_MXCSR 1
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -19,9 +30,46 @@ namespace WineSynth {
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
+namespace {
+
+// Flush-to-zero / denormals-are-zero for the duration of process (), so
+// decaying filter, feedback and reverb tails never hit denormal slow paths.
+// The host's MXCSR is restored on exit.
+class DenormalGuard
+{
+public:
+#if WINESYNTH_HAS_MXCSR
+    DenormalGuard ()
+        : saved (_mm_getcsr ())
+    {
+        _mm_setcsr (saved | 0x8040);   // FTZ | DAZ
+    }
+    ~DenormalGuard () { _mm_setcsr (saved); }
+
+private:
+    unsigned int saved;
+#endif
+};
+
+} // namespace
+
 Processor::Processor ()
 {
     setControllerClass (ControllerUID);
+
+    for (const auto& p : kParamTable)
+        params[p.id] = p.defaultNormalized;
+
+    allocateDspMemory ();
+
+    publishTuning ();
+    tuning = &tuningBuffer.read ();
+}
+
+Processor::~Processor ()
+{
+    if (impulseLoader.joinable ())
+        impulseLoader.join ();
 }
 
 tresult PLUGIN_API Processor::initialize (FUnknown* context)
@@ -33,19 +81,44 @@ tresult PLUGIN_API Processor::initialize (FUnknown* context)
     addAudioOutput (STR16 ("Stereo Out"), SpeakerArr::kStereo);
     addEventInput (STR16 ("Event In"));
 
+    statsPublisher.open ();
+    spectrumTap.attach (SpectrumFeed::get (statsPublisher.getInstanceId ()));
+    WINESYNTH_TRACE_ACQUIRE ();
     return kResultOk;
 }
 
+tresult PLUGIN_API Processor::terminate ()
+{
+    spectrumTap.attach (nullptr);
+    statsPublisher.close ();
+    WINESYNTH_TRACE_RELEASE ();
+    return AudioEffect::terminate ();
+}
+
 tresult PLUGIN_API Processor::setActive (TBool state)
 {
     if (state)
     {
-        phase = 0.0;
-        envState = kIdle;
-        envLevel = 0.0;
-        noteOn = false;
-        ic1eq = 0.0;
-        ic2eq = 0.0;
+        // Not concurrent with process (): a state loaded while inactive
+        // (Render Threads included) takes effect now
+        applyLoadedState ();
+        voiceManager.reset ();
+        effectsBus.reset ();
+        reverb.reset ();
+        governor.reset ();
+        levelMeter.reset ();
+        reportedLevel = -1;
+        dirtyParams |= paramBit (kPolyphonyId);   // drop any governor cap
+        guiNotePitch = -1;
+
+        // Render threads beyond the machine's cores would only compete
+        const int32_t cores = std::max<int32_t> (1, (int32_t)std::thread::hardware_concurrency ());
+        workerPool.start (std::min ((int32_t)toPlain (kRenderThreadsId, params[kRenderThreadsId]), cores));
+        allocateWorkerMemory ();
+    }
+    else
+    {
+        workerPool.stop ();
     }
     return AudioEffect::setActive (state);
 }
@@ -53,9 +126,72 @@ tresult PLUGIN_API Processor::setActive (TBool state)
 tresult PLUGIN_API Processor::setupProcessing (ProcessSetup& newSetup)
 {
     sampleRate = newSetup.sampleRate;
+    quality = newSetup.processMode == kOffline ? kOfflineQuality : kRealtimeQuality;
+    decimator.init (quality.oversampling);
+    spectrumTap.prepare (sampleRate);
+    governor.reset ();
+    reportedLevel = -1;
+    dirtyParams = kAllParams;   // rate-dependent coefficients
+    allocateDspMemory ();
+    stealFadeSamples = std::max<int32> (1, (int32)(kStealFadeMs * 0.001 * sampleRate));
+    publishTuning ();   // phase increments depend on the rate
+    if (!impulsePath.empty ())
+        loadImpulse (impulsePath);   // resample for the new rate
     return AudioEffect::setupProcessing (newSetup);
 }
 
+// Sizes the arena for the current rate and quality and hands out every
+// buffer the audio thread uses. Scratch is per sub-block, so the host's
+// maxSamplesPerBlock does not matter. Only called while processing is
+// stopped.
+void Processor::allocateDspMemory ()
+{
+    const int32 subBlockSize = quality.subBlockSize;
+    const int32 voiceBlockSize = subBlockSize * quality.oversampling;
+    arena.reserve (3 * Arena::bytesFor<float> (subBlockSize)
+                   + 3 * Arena::bytesFor<float> (voiceBlockSize)
+                   + EffectsBus::getArenaBytes (sampleRate, subBlockSize)
+                   + ConvolutionReverb::getArenaBytes ());
+
+    voiceScratch[0].env = arena.allocate<float> (subBlockSize);
+    mixBuffer = arena.allocate<float> (subBlockSize);
+    mixBufferR = arena.allocate<float> (subBlockSize);
+    voiceScratch[0].unisonLeft = arena.allocate<float> (voiceBlockSize);
+    voiceScratch[0].unisonRight = arena.allocate<float> (voiceBlockSize);
+    voiceScratch[0].osc = arena.allocate<float> (voiceBlockSize);
+    effectsBus.prepare (arena, sampleRate, subBlockSize);
+    reverb.prepare (arena);
+}
+
+// Scratch for the render pool's helpers and the per-voice output slots, for
+// the current pool size and quality. Called from setActive, after
+// setupProcessing has fixed the sub-block size.
+void Processor::allocateWorkerMemory ()
+{
+    const int32 numWorkers = workerPool.getNumWorkers ();
+    const int32 subBlockSize = quality.subBlockSize;
+    const int32 voiceBlockSize = subBlockSize * quality.oversampling;
+    for (int32 w = 1; w < WorkerPool::kMaxWorkers; w++)
+        voiceScratch[w] = VoiceScratch ();
+    voiceOut = nullptr;
+    if (numWorkers <= 1)
+    {
+        workerArena.reserve (0);
+        return;
+    }
+
+    workerArena.reserve ((numWorkers - 1) * (Arena::bytesFor<float> (subBlockSize) + 3 * Arena::bytesFor<float> (voiceBlockSize))
+                         + Arena::bytesFor<float> (2 * VoiceManager::kMaxVoices * subBlockSize));
+    for (int32 w = 1; w < numWorkers; w++)
+    {
+        voiceScratch[w].env = workerArena.allocate<float> (subBlockSize);
+        voiceScratch[w].unisonLeft = workerArena.allocate<float> (voiceBlockSize);
+        voiceScratch[w].unisonRight = workerArena.allocate<float> (voiceBlockSize);
+        voiceScratch[w].osc = workerArena.allocate<float> (voiceBlockSize);
+    }
+    voiceOut = workerArena.allocate<float> (2 * VoiceManager::kMaxVoices * subBlockSize);
+}
+
 tresult PLUGIN_API Processor::canProcessSampleSize (int32 symbolicSampleSize)
 {
     if (symbolicSampleSize == kSample32)
@@ -63,6 +199,114 @@ tresult PLUGIN_API Processor::canProcessSampleSize (int32 symbolicSampleSize)
     return kResultFalse;
 }
 
+tresult PLUGIN_API Processor::notify (IMessage* message)
+{
+    if (!message)
+        return kInvalidArgument;
+
+    if (strcmp (message->getMessageID (), kMsgLoadTuning) == 0)
+    {
+        const void* data = nullptr;
+        uint32 size = 0;
+        std::string scl, kbm;
+        if (message->getAttributes ()->getBinary ("scl", data, size) == kResultOk && data)
+            scl.assign ((const char*)data, size);
+        if (message->getAttributes ()->getBinary ("kbm", data, size) == kResultOk && data)
+            kbm.assign ((const char*)data, size);
+        return setTuning (scl, kbm) ? kResultOk : kResultFalse;
+    }
+
+    if (strcmp (message->getMessageID (), kMsgLoadImpulse) == 0)
+    {
+        const void* data = nullptr;
+        uint32 size = 0;
+        std::string path;
+        if (message->getAttributes ()->getBinary ("path", data, size) == kResultOk && data)
+            path.assign ((const char*)data, size);
+        loadImpulse (path);
+        return kResultOk;
+    }
+
+    if (strcmp (message->getMessageID (), kMsgChannelName) == 0)
+    {
+        const void* data = nullptr;
+        uint32 size = 0;
+        std::string name;
+        if (message->getAttributes ()->getBinary ("name", data, size) == kResultOk && data)
+            name.assign ((const char*)data, size);
+        statsPublisher.setName (name.c_str ());
+        return kResultOk;
+    }
+
+    return AudioEffect::notify (message);
+}
+
+// Tells the controller which row of the instance statistics is ours, so
+// the editor can mark it
+tresult PLUGIN_API Processor::connect (IConnectionPoint* other)
+{
+    tresult result = AudioEffect::connect (other);
+    if (result != kResultOk)
+        return result;
+
+    if (auto message = owned (allocateMessage ()))
+    {
+        message->setMessageID (kMsgInstanceId);
+        message->getAttributes ()->setInt ("id", statsPublisher.getInstanceId ());
+        sendMessage (message);
+    }
+    return result;
+}
+
+bool Processor::setTuning (const std::string& scl, const std::string& kbm)
+{
+    ScalaScale scale;
+    KeyboardMapping mapping;
+    if (!scl.empty () && !Tuning::parseScale (scl, scale))
+        return false;
+    if (!kbm.empty () && !Tuning::parseKeyboardMapping (kbm, mapping))
+        return false;
+
+    scaleText = scl;
+    mappingText = kbm;
+    publishTuning ();
+    return true;
+}
+
+// Builds the tuning table for the current scale and sample rate and hands it
+// to the audio thread. Never called from process ().
+void Processor::publishTuning ()
+{
+    ScalaScale scale = ScalaScale::equalTemperament ();
+    KeyboardMapping mapping;
+    if (!scaleText.empty ())
+        Tuning::parseScale (scaleText, scale);
+    if (!mappingText.empty ())
+        Tuning::parseKeyboardMapping (mappingText, mapping);
+
+    Tuning::buildTable (tuningBuffer.getWriteBuffer (), scale, mapping, sampleRate);
+    tuningBuffer.publish ();
+}
+
+// Reads, resamples and transforms the impulse on a loader thread; the
+// reverb picks it up at the start of a later block. Loads are serialized,
+// so the reverb only ever has one publishing thread.
+void Processor::loadImpulse (const std::string& path)
+{
+    if (impulseLoader.joinable ())
+        impulseLoader.join ();
+
+    impulsePath = path;
+    impulseLoader = std::thread ([this, path, rate = sampleRate] () {
+        AudioFile file;
+        const int32 maxFrames = (int32)(ConvolutionReverb::kMaxImpulseSeconds * 192000.0);
+        if (path.empty () || !WavFile::read (path, file, 2, maxFrames))
+            reverb.publish (nullptr);
+        else
+            reverb.publish (reverb.makeImpulse (file, rate));
+    });
+}
+
 double Processor::generateSample (double ph, int waveform)
 {
     double t = ph / (2.0 * M_PI);
@@ -76,214 +320,971 @@ double Processor::generateSample (double ph, int waveform)
             return t < 0.5 ? 1.0 : -1.0;
         case kWaveTriangle:
             return 4.0 * fabs (t - 0.5) - 1.0;
+        case kWaveSineFast:
+        {
+            // sin (ph) = -sin (pi x), x in [-1, 1): parabola plus one
+            // refinement step, max error ~1e-3
+            double x = t * 2.0 - 1.0;
+            double y = 4.0 * x * (1.0 - fabs (x));
+            y += 0.225 * (y * fabs (y) - y);
+            return -y;
+        }
         default:
             return sin (ph);
     }
 }
 
-tresult PLUGIN_API Processor::process (ProcessData& data)
+void Processor::setParam (ParamID id, ParamValue value)
+{
+    if (id >= (ParamID)kNumParams || params[id] == value)
+        return;
+    params[id] = value;
+    dirtyParams |= paramBit (id);
+}
+
+void Processor::updateDerivedParams ()
+{
+    if (!dirtyParams)
+        return;
+
+    if (dirtyParams & paramBit (kGainId))
+        gain = params[kGainId];
+
+    // Fine tune (-100..+100 ct) and pitch bend as one ratio from the lookup
+    if (dirtyParams & (paramBit (kFineId) | paramBit (kPitchBendId) | paramBit (kBendRangeId)))
+    {
+        double cents = toPlain (kFineId, params[kFineId])
+                     + toPlain (kPitchBendId, params[kPitchBendId]) * toPlain (kBendRangeId, params[kBendRangeId]) * 100.0;
+        pitchRatio = pitchRatioTable.fromCents (cents);
+    }
+
+    if (dirtyParams & paramBit (kWaveformId))
+        iWaveform = (int32_t)toPlain (kWaveformId, params[kWaveformId]);
+
+    if (dirtyParams & paramBit (kOscModeId))
+        additiveMode = (int32_t)toPlain (kOscModeId, params[kOscModeId]) == kOscModeAdditive;
+
+    if (dirtyParams & paramBit (kBypassId))
+        bBypass = toPlain (kBypassId, params[kBypassId]) > 0.5;
+
+    if (dirtyParams & paramBit (kPolyphonyId))
+        polyphony = (int32_t)toPlain (kPolyphonyId, params[kPolyphonyId]);
+
+    if (dirtyParams & paramBit (kOsc2WaveformId))
+        osc2Waveform = (int32_t)toPlain (kOsc2WaveformId, params[kOsc2WaveformId]);
+
+    if (dirtyParams & (paramBit (kWaveformId) | paramBit (kOsc2WaveformId) | paramBit (kPolyphonyId)))
+        applyQualityLevel ();
+
+    const ParamMask osc2Mask = paramBit (kOsc2PitchId) | paramBit (kOsc2FineId) | paramBit (kOsc2LevelId)
+                             | paramBit (kFmDepthId) | paramBit (kRingModId) | paramBit (kSyncId);
+    if (dirtyParams & osc2Mask)
+    {
+        double semitones = toPlain (kOsc2PitchId, params[kOsc2PitchId]) + toPlain (kOsc2FineId, params[kOsc2FineId]) * 0.01;
+        oscPair.ratio2 = pow (2.0, semitones / 12.0);
+        oscPair.level2 = params[kOsc2LevelId];
+        oscPair.fmIndex = toPlain (kFmDepthId, params[kFmDepthId]);
+        oscPair.ring = params[kRingModId];
+        oscPair.sync = toPlain (kSyncId, params[kSyncId]) > 0.5;
+    }
+
+    // The additive mode renders a single stack of partials, no unison
+    const ParamMask unisonMask = paramBit (kUnisonVoicesId) | paramBit (kUnisonDetuneId) | paramBit (kUnisonSpreadId)
+                               | paramBit (kOscModeId);
+    if (dirtyParams & unisonMask)
+    {
+        int32_t count = (int32_t)toPlain (kUnisonVoicesId, params[kUnisonVoicesId]);
+        if (count > 1)
+            count = std::min (count * quality.unisonMultiplier, UnisonState::kMaxOscillators);
+        unisonSetup = UnisonSetup::make (additiveMode ? 1 : count,
+                                         toPlain (kUnisonDetuneId, params[kUnisonDetuneId]),
+                                         params[kUnisonSpreadId]);
+    }
+
+    if (dirtyParams & (paramBit (kPartialsId) | paramBit (kSpectralTiltId) | paramBit (kEvenPartialsId)))
+        additiveProfile = AdditiveProfile::make ((int32_t)toPlain (kPartialsId, params[kPartialsId]),
+                                                 toPlain (kSpectralTiltId, params[kSpectralTiltId]),
+                                                 params[kEvenPartialsId]);
+
+    if (dirtyParams & paramBit (kStealModeId))
+        voiceManager.setStealPolicy ((int32_t)toPlain (kStealModeId, params[kStealModeId]));
+
+    // Envelope segment coefficients (times in ms, quadratic mapping)
+    const ParamMask envMask = paramBit (kAttackId) | paramBit (kHoldId) | paramBit (kDecayId)
+                            | paramBit (kSustainId) | paramBit (kReleaseId);
+    if (dirtyParams & envMask)
+    {
+        const double msToSamples = 0.001 * sampleRate;
+        envParams.set (toPlain (kAttackId, params[kAttackId]) * msToSamples,
+                       toPlain (kHoldId, params[kHoldId]) * msToSamples,
+                       toPlain (kDecayId, params[kDecayId]) * msToSamples,
+                       toPlain (kSustainId, params[kSustainId]),
+                       toPlain (kReleaseId, params[kReleaseId]) * msToSamples,
+                       EnvelopeParams::kSustainGlideMs * msToSamples);
+    }
+
+    if (dirtyParams & paramBit (kFilterModeId))
+        filterMode = (int32_t)toPlain (kFilterModeId, params[kFilterModeId]);
+
+    // Filter coefficients (cutoff 20..20000 Hz)
+    if (dirtyParams & (paramBit (kCutoffId) | paramBit (kResonanceId)))
+        filterCoeffs = FilterCoeffs::make (toPlain (kCutoffId, params[kCutoffId]), params[kResonanceId],
+                                           sampleRate * quality.oversampling);
+
+    // Drive stage (0 dB = off, the filter stays linear)
+    if (dirtyParams & (paramBit (kDriveId) | paramBit (kDriveTypeId)))
+    {
+        double db = toPlain (kDriveId, params[kDriveId]);
+        driveEnabled = db > 0.0;
+        driveType = (int32_t)toPlain (kDriveTypeId, params[kDriveTypeId]);
+        driveGain = pow (10.0, db / 20.0);
+        driveNorm = 1.0 / (driveType == kShaperHard ? HardShaper::apply (driveGain) : SoftShaper::apply (driveGain));
+    }
+
+    if (dirtyParams & (paramBit (kChorusMixId) | paramBit (kChorusRateId) | paramBit (kChorusDepthId)))
+        effectsBus.setChorus (params[kChorusMixId], toPlain (kChorusRateId, params[kChorusRateId]), params[kChorusDepthId]);
+
+    if (dirtyParams & (paramBit (kDelayMixId) | paramBit (kDelayTimeId) | paramBit (kDelayFeedbackId)))
+        effectsBus.setDelay (params[kDelayMixId], (int32_t)toPlain (kDelayTimeId, params[kDelayTimeId]),
+                             toPlain (kDelayFeedbackId, params[kDelayFeedbackId]));
+
+    if (dirtyParams & paramBit (kReverbMixId))
+        reverb.setMix (params[kReverbMixId]);
+
+    dirtyParams = 0;
+}
+
+void Processor::handleKeyboardNote (ParamValue value)
 {
-    // Read parameter changes
-    if (IParameterChanges* paramChanges = data.inputParameterChanges)
+    int noteIdx = (int)(value * 12.0 + 0.5);
+    if (guiNotePitch >= 0)
+    {
+        noteOff (guiNotePitch);
+        guiNotePitch = -1;
+    }
+    if (noteIdx > 0 && noteIdx <= 12)
     {
-        int32 numParamsChanged = paramChanges->getParameterCount ();
-        for (int32 i = 0; i < numParamsChanged; i++)
+        guiNotePitch = (int16_t)(60 + noteIdx - 1); // C4=60
+        noteOn (guiNotePitch);
+    }
+}
+
+void Processor::noteOn (int16_t pitch)
+{
+    if (!tuning->isMapped (pitch))
+        return;
+
+    auto alloc = voiceManager.allocate (pitch);
+    Voice& voice = voiceManager.getVoice (alloc.index);
+
+    switch (alloc.result)
+    {
+        case VoiceManager::kFresh:
+            startVoice (voice, pitch);
+            break;
+        case VoiceManager::kRetrigger:
+            if (voice.isFading ())
+                voice.pendingPitch = pitch;
+            else
+                Envelope::noteOn (voice.env);
+            break;
+        case VoiceManager::kStolen:
+            // Fade the old note out first; the new one starts when the fade ends
+            voice.pendingPitch = pitch;
+            beginStealFade (voice);
+            break;
+    }
+}
+
+// Applies the governor's level: cheaper oscillator kernel and/or a voice
+// cap below the Voices parameter. Voices over the cap fade out like steals,
+// so stepping down never clicks.
+void Processor::applyQualityLevel ()
+{
+    const int32_t level = quality.governed ? governor.getLevel () : kQualityFull;
+
+    const bool cheap = level >= kQualityCheapOscillators;
+    renderWaveform = (cheap && iWaveform == kWaveSine) ? kWaveSineFast : iWaveform;
+    renderOsc2Waveform = (cheap && osc2Waveform == kWaveSine) ? kWaveSineFast : osc2Waveform;
+    renderPartials = cheap ? kCheapPartials : AdditiveState::kMaxPartials;
+
+    int32_t limit = polyphony;
+    if (level >= kQualityQuarterVoices)
+        limit = (polyphony + 3) / 4;
+    else if (level >= kQualityHalfVoices)
+        limit = (polyphony + 1) / 2;
+    voiceManager.setPolyphony (limit);
+    fadeExcessVoices (limit);
+}
+
+// Fades the quietest voices (by level bucket) until at most limit keep
+// sounding. Voices already fading out for good do not count.
+void Processor::fadeExcessVoices (int32_t limit)
+{
+    int32_t sounding = 0;
+    for (int32_t i = voiceManager.oldest (); i >= 0; i = voiceManager.next (i))
+        sounding += voiceManager.getVoice (i).isEnding () ? 0 : 1;
+
+    for (; sounding > limit; sounding--)
+    {
+        Voice& quietest = voiceManager.getVoice (voiceManager.quietestSounding ());
+        quietest.pendingPitch = -1;   // end after the fade, no restart
+        beginStealFade (quietest);
+    }
+}
+
+void Processor::beginStealFade (Voice& voice)
+{
+    if (!voice.isFading ())
+    {
+        voice.fadeLeft = stealFadeSamples;
+        voice.fadeGain = 1.f;
+        voice.fadeStep = 1.f / (float)stealFadeSamples;
+    }
+}
+
+void Processor::noteOff (int16_t pitch)
+{
+    for (int32_t i = voiceManager.firstOnPitch (pitch); i >= 0; i = voiceManager.nextOnPitch (i))
+    {
+        Voice& voice = voiceManager.getVoice (i);
+        if (voice.isFading ())
+            voice.pendingPitch = -1;   // fade out and end
+        else
+            Envelope::noteOff (voice.env);
+    }
+}
+
+void Processor::startVoice (Voice& voice, int16_t pitch)
+{
+    voice.phaseInc = tuning->phaseInc[pitch];
+    voice.phase = 0.0;
+    voice.osc.reset ();
+    voice.additive.reset ();
+    voice.filter.reset ();
+    voice.driveIn.reset ();
+    voice.driveOut.reset ();
+    voice.filterR.reset ();
+    voice.driveInR.reset ();
+    voice.driveOutR.reset ();
+    voice.unison.randomize (unisonSeed);
+    if (quality.oversampling > 1)
+    {
+        voice.decimator.reset ();
+        voice.decimatorR.reset ();
+    }
+    voice.pendingPitch = -1;
+    voice.fadeLeft = 0;
+    voice.fadeGain = 1.f;
+    Envelope::reset (voice.env);
+    Envelope::noteOn (voice.env);
+}
+
+// mixR == mixL renders mono (unison off)
+void Processor::renderVoices (float* mixL, float* mixR, int32 numSamples)
+{
+    if (workerPool.getNumWorkers () > 1 && voiceManager.getNumActive () >= kParallelMinVoices)
+    {
+        renderVoicesParallel (mixL, mixR, numSamples);
+        return;
+    }
+
+    memset (mixL, 0, numSamples * sizeof (float));
+    if (mixR != mixL)
+        memset (mixR, 0, numSamples * sizeof (float));
+
+    int32_t next = -1;
+    for (int32_t i = voiceManager.oldest (); i >= 0; i = next)
+    {
+        next = voiceManager.next (i);
+        renderVoice (voiceManager.getVoice (i), voiceScratch[0], mixL, mixR, numSamples);
+        finishVoice (i);
+    }
+}
+
+// Pool rendering: each voice renders into its own voiceOut slot (a single
+// addition to zero per sample, so the slot holds exactly the voice's
+// contribution), and the slots are added to the mix in age order — the
+// additions renderVoices makes, in the same order. Voices whose steal fade
+// ends in this sub-block restart with startVoice, which draws from
+// unisonSeed; they render here first, in age order, so the seed sequence
+// matches as well.
+void Processor::renderVoicesParallel (float* mixL, float* mixR, int32 numSamples)
+{
+    const bool stereo = mixR != mixL;
+    const int32 stride = quality.subBlockSize;
+    auto slotLeft = [&] (int32_t slot) { return voiceOut + 2 * slot * stride; };
+    auto slotRight = [&] (int32_t slot) { return stereo ? voiceOut + (2 * slot + 1) * stride : slotLeft (slot); };
+
+    int32_t order[VoiceManager::kMaxVoices];   // voice index per slot, oldest first
+    int32_t tasks[VoiceManager::kMaxVoices];   // slots left to the pool
+    int32_t numSlots = 0;
+    int32_t numTasks = 0;
+    for (int32_t i = voiceManager.oldest (); i >= 0; i = voiceManager.next (i))
+    {
+        Voice& voice = voiceManager.getVoice (i);
+        const int32_t slot = numSlots++;
+        order[slot] = i;
+        memset (slotLeft (slot), 0, numSamples * sizeof (float));
+        if (stereo)
+            memset (slotRight (slot), 0, numSamples * sizeof (float));
+
+        if (voice.isFading () && voice.fadeLeft <= numSamples && voice.pendingPitch >= 0)
+            renderVoice (voice, voiceScratch[0], slotLeft (slot), slotRight (slot), numSamples);
+        else
+            tasks[numTasks++] = slot;
+    }
+
+    auto renderTask = [&] (int32_t task, int32_t worker) {
+        const int32_t slot = tasks[task];
+        renderVoice (voiceManager.getVoice (order[slot]), voiceScratch[worker], slotLeft (slot), slotRight (slot), numSamples);
+    };
+    workerPool.run (numTasks, renderTask);
+
+    memset (mixL, 0, numSamples * sizeof (float));
+    if (stereo)
+        memset (mixR, 0, numSamples * sizeof (float));
+    for (int32_t slot = 0; slot < numSlots; slot++)
+    {
+        const float* left = slotLeft (slot);
+        for (int32 s = 0; s < numSamples; s++)
+            mixL[s] += left[s];
+        if (stereo)
         {
-            if (IParamValueQueue* paramQueue = paramChanges->getParameterData (i))
-            {
-                ParamValue value;
-                int32 sampleOffset;
-                int32 numPoints = paramQueue->getPointCount ();
-                if (paramQueue->getPoint (numPoints - 1, sampleOffset, value) == kResultTrue)
-                {
-                    switch (paramQueue->getParameterId ())
-                    {
-                        case kGainId:      fGain = (float)value; break;
-                        case kCutoffId:    fCutoff = (float)value; break;
-                        case kFineId:      fFine = (float)value; break;
-                        case kResonanceId: fResonance = (float)value; break;
-                        case kWaveformId:  iWaveform = std::min ((int32)(value * kNumWaveforms), (int32)(kNumWaveforms - 1)); break;
-                        case kAttackId:    fAttack = (float)value; break;
-                        case kReleaseId:   fRelease = (float)value; break;
-                        case kBypassId:    bBypass = (value > 0.5f); break;
-                        case kKeyboardNoteId:
-                        {
-                            int noteIdx = (int)(value * 12.0 + 0.5);
-                            if (noteIdx > 0 && noteIdx <= 12)
-                            {
-                                int midiPitch = 60 + noteIdx - 1; // C4=60
-                                noteFrequency = 440.0f * powf (2.0f, ((float)midiPitch - 69.0f) / 12.0f);
-                                noteOn = true;
-                                envState = kAttack;
-                                double attackMs = 1.0 + 999.0 * fAttack * fAttack;
-                                double attackSamples = attackMs * 0.001 * sampleRate;
-                                attackRate = 1.0 / std::max (attackSamples, 1.0);
-                            }
-                            else
-                            {
-                                noteOn = false;
-                                envState = kRelease;
-                                double releaseMs = 10.0 + 2990.0 * fRelease * fRelease;
-                                double releaseSamples = releaseMs * 0.001 * sampleRate;
-                                releaseRate = envLevel / std::max (releaseSamples, 1.0);
-                            }
-                            break;
-                        }
-                    }
-                }
-            }
+            const float* right = slotRight (slot);
+            for (int32 s = 0; s < numSamples; s++)
+                mixR[s] += right[s];
+        }
+        finishVoice (order[slot]);
+    }
+}
+
+// Voice bookkeeping after a render: free it once silent, else refresh its
+// level bucket
+void Processor::finishVoice (int32_t index)
+{
+    Voice& voice = voiceManager.getVoice (index);
+    if (voice.env.isIdle () && !voice.isFading ())
+    {
+        // Leave no residue behind: the next note starts from exact zero
+        voice.filter.reset ();
+        voice.driveIn.reset ();
+        voice.driveOut.reset ();
+        voice.filterR.reset ();
+        voice.driveInR.reset ();
+        voice.driveOutR.reset ();
+        voiceManager.freeVoice (index);
+    }
+    else if (voice.pendingPitch >= 0)
+        voiceManager.updateLevel (index, 1.f);   // about to start a new note
+    else
+        voiceManager.updateLevel (index, voice.env.level * voice.fadeGain);
+}
+
+void Processor::renderVoice (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR, int32 numSamples)
+{
+    int32 pos = 0;
+    if (voice.isFading ())
+    {
+        int32 count = std::min (voice.fadeLeft, numSamples);
+        if (!voice.env.isIdle ())
+            dispatchVoiceSegment<true> (voice, scratch, mixL, mixR, count);
+        voice.fadeLeft -= count;
+        pos = count;
+
+        if (!voice.isFading ())
+        {
+            if (voice.pendingPitch >= 0)
+                startVoice (voice, voice.pendingPitch);
+            else
+                Envelope::reset (voice.env);
+        }
+    }
+
+    if (pos < numSamples && !voice.env.isIdle ())
+        dispatchVoiceSegment<false> (voice, scratch, mixL + pos, mixR + pos, numSamples - pos);
+}
+
+// One instantiation per filter mode, shaper, quality and oscillator source
+// (single, buffered = pair or additive, unison): no per-sample branches
+template <bool Fade>
+void Processor::dispatchVoiceSegment (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR,
+                                      int32 numSamples)
+{
+    const bool oversampled = quality.oversampling > 1;
+    const bool unison = mixR != mixL;
+    const bool buffered = additiveMode || oscPair.isActive ();
+    dispatchFilter (filterMode, [&] (auto filter) {
+        dispatchShaper (driveEnabled, driveType, [&] (auto shaper) {
+            using F = decltype (filter);
+            using S = decltype (shaper);
+            if (unison && oversampled)
+                renderUnisonSegment<Fade, true, F, S> (voice, scratch, mixL, mixR, numSamples);
+            else if (unison)
+                renderUnisonSegment<Fade, false, F, S> (voice, scratch, mixL, mixR, numSamples);
+            else if (buffered && oversampled)
+                renderVoiceSegment<Fade, true, true, F, S> (voice, scratch, mixL, numSamples);
+            else if (buffered)
+                renderVoiceSegment<Fade, false, true, F, S> (voice, scratch, mixL, numSamples);
+            else if (oversampled)
+                renderVoiceSegment<Fade, true, false, F, S> (voice, scratch, mixL, numSamples);
+            else
+                renderVoiceSegment<Fade, false, false, F, S> (voice, scratch, mixL, numSamples);
+        });
+    });
+}
+
+// Shaper = NoShaper compiles the drive stage out entirely. Oversampled
+// voices run oscillator, drive and filter at quality.oversampling times the
+// rate and decimate before the envelope. Buffered voices render their
+// oscillator source for the whole segment first — the additive stack
+// (renderAdditive) or both oscillators of the pair (renderOscPair) — and
+// filter that.
+template <bool Fade, bool Oversampled, bool Buffered, typename Filter, typename Shaper>
+void Processor::renderVoiceSegment (Voice& voice, const VoiceScratch& scratch, float* mix, int32 numSamples)
+{
+    float* envOut = scratch.env;
+    Envelope::renderBlock (voice.env, envParams, envOut, numSamples);
+
+    const int32 factor = Oversampled ? quality.oversampling : 1;
+    const double phaseInc = voice.phaseInc * pitchRatio / factor;
+    const FilterCoeffs coeffs = filterCoeffs;
+
+    const float* source = scratch.osc;
+    if constexpr (Buffered)
+    {
+        if (additiveMode)
+        {
+            const double inc = phaseInc / (2.0 * M_PI);
+            renderAdditive (voice.additive, additiveProfile, renderPartials, inc, inc * factor, scratch.osc,
+                            numSamples * factor);
+        }
+        else
+        {
+            dispatchPairWave (renderWaveform, [&] (auto wave1) {
+                dispatchPairWave (renderOsc2Waveform, [&] (auto wave2) {
+                    renderOscPair<decltype (wave1), decltype (wave2)> (voice.osc, oscPair, phaseInc / (2.0 * M_PI),
+                                                                       scratch.osc, numSamples * factor);
+                });
+            });
         }
     }
 
-    // Process MIDI events
-    if (IEventList* events = data.inputEvents)
+    double phase = voice.phase;
+    FilterState filter = voice.filter;
+    AdaaState driveIn = voice.driveIn;
+    AdaaState driveOut = voice.driveOut;
+    float fadeGain = voice.fadeGain;
+
+    constexpr bool kDrive = !std::is_same<Shaper, NoShaper>::value;
+
+    auto tick = [&] () {
+        double raw;
+        if constexpr (Buffered)
+            raw = *source++;
+        else
+            raw = generateSample (phase, renderWaveform);
+        if constexpr (kDrive)
+            raw = processAdaa<Shaper> (driveIn, raw * driveGain) * driveNorm;
+
+        double filtered = Filter::process (filter, coeffs, raw);
+        if constexpr (kDrive)
+            filtered = processAdaa<Shaper> (driveOut, filtered);
+
+        phase += phaseInc;
+        if (phase >= 2.0 * M_PI)
+            phase -= 2.0 * M_PI;
+        return filtered;
+    };
+
+    for (int32 s = 0; s < numSamples; s++)
     {
-        int32 numEvents = events->getEventCount ();
-        for (int32 i = 0; i < numEvents; i++)
+        double filtered;
+        if constexpr (Oversampled)
+        {
+            for (int32 k = 0; k < factor; k++)
+                decimator.push (voice.decimator, (float)tick ());
+            filtered = decimator.output (voice.decimator);
+        }
+        else
+        {
+            filtered = tick ();
+        }
+
+        float sample = (float)(filtered * gain * envOut[s]);
+        if (Fade)
         {
-            Event event;
-            if (events->getEvent (i, event) == kResultOk)
+            sample *= fadeGain;
+            fadeGain -= voice.fadeStep;
+        }
+        mix[s] += sample;
+    }
+
+    voice.phase = phase;
+    voice.filter = filter;
+    if (kDrive)
+    {
+        voice.driveIn = driveIn;
+        voice.driveOut = driveOut;
+    }
+    if (Fade)
+        voice.fadeGain = std::max (fadeGain, 0.f);
+}
+
+// Unison: the whole stack is rendered for the segment first (renderUnison,
+// lane parallel, at the voice render rate), then each side runs through its
+// own drive / filter / decimator like a single oscillator would.
+template <bool Fade, bool Oversampled, typename Filter, typename Shaper>
+void Processor::renderUnisonSegment (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR,
+                                     int32 numSamples)
+{
+    float* envOut = scratch.env;
+    Envelope::renderBlock (voice.env, envParams, envOut, numSamples);
+
+    const int32 factor = Oversampled ? quality.oversampling : 1;
+    const float baseInc = (float)(voice.phaseInc * pitchRatio / (2.0 * M_PI * factor));
+    dispatchUnisonWave (renderWaveform, [&] (auto wave) {
+        renderUnison<decltype (wave)> (voice.unison, unisonSetup, baseInc, scratch.unisonLeft, scratch.unisonRight,
+                                       numSamples * factor);
+    });
+
+    const FilterCoeffs coeffs = filterCoeffs;
+    constexpr bool kDrive = !std::is_same<Shaper, NoShaper>::value;
+
+    auto renderSide = [&] (const float* raw, FilterState& filterState, AdaaState& driveInState,
+                           AdaaState& driveOutState, DecimatorState& decimatorState, float* mix) {
+        FilterState filter = filterState;
+        AdaaState driveIn = driveInState;
+        AdaaState driveOut = driveOutState;
+        float fadeGain = voice.fadeGain;
+
+        auto tick = [&] (double x) {
+            if constexpr (kDrive)
+                x = processAdaa<Shaper> (driveIn, x * driveGain) * driveNorm;
+            double filtered = Filter::process (filter, coeffs, x);
+            if constexpr (kDrive)
+                filtered = processAdaa<Shaper> (driveOut, filtered);
+            return filtered;
+        };
+
+        for (int32 s = 0; s < numSamples; s++)
+        {
+            double filtered;
+            if constexpr (Oversampled)
             {
-                if (event.type == Event::kNoteOnEvent)
-                {
-                    // MIDI note to frequency
-                    noteFrequency = 440.0f * powf (2.0f, ((float)event.noteOn.pitch - 69.0f) / 12.0f);
-                    noteOn = true;
-                    envState = kAttack;
-
-                    // Calculate attack rate: 1..1000 ms (exponential)
-                    double attackMs = 1.0 + 999.0 * fAttack * fAttack;
-                    double attackSamples = attackMs * 0.001 * sampleRate;
-                    attackRate = 1.0 / std::max (attackSamples, 1.0);
-
-                    // Notify GUI keyboard: MIDI pitch → keyboard index
-                    int keyIdx = event.noteOn.pitch - 60; // C4=0
-                    if (keyIdx >= 0 && keyIdx < 12 && data.outputParameterChanges)
-                    {
-                        int32 qidx;
-                        if (auto* q = data.outputParameterChanges->addParameterData (kKeyboardNoteId, qidx))
-                            q->addPoint (event.sampleOffset, (float)(keyIdx + 1) / 12.0f, qidx);
-                    }
-                }
-                else if (event.type == Event::kNoteOffEvent)
-                {
-                    noteOn = false;
-                    envState = kRelease;
-
-                    // Notify GUI keyboard: note off
-                    if (data.outputParameterChanges)
-                    {
-                        int32 qidx;
-                        if (auto* q = data.outputParameterChanges->addParameterData (kKeyboardNoteId, qidx))
-                            q->addPoint (event.sampleOffset, 0.0f, qidx);
-                    }
-
-                    // Calculate release rate: 10..3000 ms (exponential)
-                    double releaseMs = 10.0 + 2990.0 * fRelease * fRelease;
-                    double releaseSamples = releaseMs * 0.001 * sampleRate;
-                    releaseRate = envLevel / std::max (releaseSamples, 1.0);
-                }
+                for (int32 k = 0; k < factor; k++)
+                    decimator.push (decimatorState, (float)tick (raw[s * factor + k]));
+                filtered = decimator.output (decimatorState);
             }
+            else
+            {
+                filtered = tick (raw[s]);
+            }
+
+            float sample = (float)(filtered * gain * envOut[s]);
+            if (Fade)
+            {
+                sample *= fadeGain;
+                fadeGain -= voice.fadeStep;
+            }
+            mix[s] += sample;
+        }
+
+        filterState = filter;
+        if (kDrive)
+        {
+            driveInState = driveIn;
+            driveOutState = driveOut;
+        }
+        return fadeGain;
+    };
+
+    renderSide (scratch.unisonLeft, voice.filter, voice.driveIn, voice.driveOut, voice.decimator, mixL);
+    float fadeGain = renderSide (scratch.unisonRight, voice.filterR, voice.driveInR, voice.driveOutR, voice.decimatorR, mixR);
+    if (Fade)
+        voice.fadeGain = std::max (fadeGain, 0.f);
+}
+
+void Processor::ParamCursor::load ()
+{
+    int32 offset;
+    if (next < numPoints && queue->getPoint (next, offset, nextValue) == kResultTrue)
+        nextOffset = std::max<int32> (offset, 0);
+    else
+        nextOffset = kNoOffset;
+}
+
+// Applies every queued point at or before position. Returns the last GUI
+// keyboard value among them (-1 if none), which is handled after the
+// derived parameters are updated.
+ParamValue Processor::applyParamChanges (ParamCursor* cursors, int32 numCursors, int32 position)
+{
+    ParamValue keyboardNote = -1.0;
+    for (int32 i = 0; i < numCursors; i++)
+    {
+        ParamCursor& c = cursors[i];
+        while (c.nextOffset <= position)
+        {
+            if (c.id == kKeyboardNoteId)
+                keyboardNote = c.nextValue;
+            else
+                setParam (c.id, c.nextValue);
+            c.next++;
+            c.load ();
         }
     }
+    return keyboardNote;
+}
 
-    if (data.numOutputs == 0)
-        return kResultOk;
+// Applies the state setState () published last, once
+void Processor::applyLoadedState ()
+{
+    const LoadedState& state = stateBuffer.read ();
+    if (state.serial == appliedStateSerial.load (std::memory_order_relaxed))
+        return;
+
+    for (int32_t id = 0; id < kNumParams; id++)
+    {
+        if (state.loaded & paramBit (id))
+            setParam (id, state.values[id]);
+    }
+    appliedStateSerial.store (state.serial, std::memory_order_release);
+}
+
+void Processor::handleEvent (const Event& event, IParameterChanges* outputChanges)
+{
+    WINESYNTH_TRACE_SCOPE ("Processor::handleEvent");
+
+    if (event.type == Event::kNoteOnEvent)
+    {
+        noteOn (event.noteOn.pitch);
+
+        // Notify GUI keyboard: MIDI pitch → keyboard index
+        int keyIdx = event.noteOn.pitch - 60; // C4=0
+        if (keyIdx >= 0 && keyIdx < 12 && outputChanges)
+        {
+            int32 qidx;
+            if (auto* q = outputChanges->addParameterData (kKeyboardNoteId, qidx))
+                q->addPoint (event.sampleOffset, (float)(keyIdx + 1) / 12.0f, qidx);
+        }
+    }
+    else if (event.type == Event::kNoteOffEvent)
+    {
+        noteOff (event.noteOff.pitch);
+
+        // Notify GUI keyboard: note off
+        if (outputChanges)
+        {
+            int32 qidx;
+            if (auto* q = outputChanges->addParameterData (kKeyboardNoteId, qidx))
+                q->addPoint (event.sampleOffset, 0.0f, qidx);
+        }
+    }
+}
+
+// True while voices sound or an enabled effect still has a tail; this is
+// exactly when renderSubBlock () produces anything but zeros
+bool Processor::isOutputActive () const
+{
+    return (!bBypass && voiceManager.getNumActive () > 0)
+        || (effectsBus.isEnabled () && effectsBus.isTailActive ())
+        || (reverb.isEnabled () && reverb.isTailActive ());
+}
 
-    int32 numChannels = data.outputs[0].numChannels;
-    int32 numSamples = data.numSamples;
-    float** out = data.outputs[0].channelBuffers32;
+// Renders count samples at start into the output channels. Returns false
+// (after zeroing the range) when nothing is audible, without touching the
+// voices or effects.
 
-    if (bBypass || numSamples == 0)
+bool Processor::renderSubBlock (float** out, int32 numChannels, int32 start, int32 count)
+{
+    const bool voicesActive = !bBypass && voiceManager.getNumActive () > 0;
+    const bool stereo = !bBypass && numChannels >= 2;
+    const bool effectsActive = stereo && effectsBus.isEnabled () && (voicesActive || effectsBus.isTailActive ());
+    const bool busActive = voicesActive || effectsActive;
+    const bool reverbActive = stereo && reverb.isEnabled () && (busActive || reverb.isTailActive ());
+
+    if (!busActive && !reverbActive)
     {
         for (int32 ch = 0; ch < numChannels; ch++)
-            memset (out[ch], 0, numSamples * sizeof (float));
-        data.outputs[0].silenceFlags = (1ULL << numChannels) - 1;
-        return kResultOk;
+            memset (out[ch] + start, 0, count * sizeof (float));
+        return false;
     }
 
-    // Calculate oscillator frequency from MIDI note + fine tuning
-    float fineOffset = (fFine - 0.5f) * 200.0f;  // -100..+100 cent
-    float finalFreq = noteFrequency * powf (2.0f, fineOffset / 1200.0f);
+    // Voices render in stereo only while unison is on; mono otherwise
+    float* mixL = mixBuffer;
+    float* mixR = unisonSetup.count > 1 ? mixBufferR : mixBuffer;
+    if (voicesActive)
+        renderVoices (mixL, mixR, count);
+    else
+        memset (mixL, 0, count * sizeof (float));
+    if (!voicesActive && mixR != mixL)
+        memset (mixR, 0, count * sizeof (float));
 
-    double phaseInc = 2.0 * M_PI * finalFreq / sampleRate;
+    // The effects bus writes straight into the first two channels
+    int32 firstCopy = 0;
+    if (effectsActive)
+    {
+        effectsBus.process (mixL, mixR, out[0] + start, out[1] + start, count, voicesActive);
+        mixL = out[0] + start;
+        mixR = out[1] + start;
+        firstCopy = 2;
+    }
 
-    // Cytomic SVF filter coefficients (stable at all frequencies)
-    double cutoffHz = 20.0 * pow (1000.0, (double)fCutoff);  // 20..20000 Hz
-    cutoffHz = std::min (cutoffHz, sampleRate * 0.49);
-    double g = tan (M_PI * cutoffHz / sampleRate);
-    double k = 2.0 - 2.0 * (double)fResonance * 0.95;  // damping: 2.0 (no reso) .. 0.1 (max reso)
-    double a1 = 1.0 / (1.0 + g * (g + k));
-    double a2 = g * a1;
+    if (numChannels == 1 && mixR != mixL)
+    {
+        for (int32 s = 0; s < count; s++)
+            out[0][start + s] = 0.5f * (mixL[s] + mixR[s]);
+        firstCopy = 1;
+    }
 
-    for (int32 s = 0; s < numSamples; s++)
+    // Remaining channels: left on even, right on odd. Without the reverb
+    // this is the last write to the metered channels, so it measures them.
+    for (int32 ch = firstCopy; ch < numChannels; ch++)
+    {
+        const float* src = (ch & 1) ? mixR : mixL;
+        if (ch < LevelMeter::kNumChannels && !reverbActive)
+            copyAndMeasure (out[ch] + start, src, count, levelMeter.block[ch]);
+        else
+            memcpy (out[ch] + start, src, count * sizeof (float));
+    }
+
+    // Reverb adds its wet signal in place on the first two channels
+    if (reverbActive)
+        reverb.process (out[0] + start, out[1] + start, count, busActive);
+
+    // Metered channels finished in place (effects bus, mono mix, reverb),
+    // measured while the sub-block is still in L1
+    const int32 numMetered = std::min<int32> (numChannels, LevelMeter::kNumChannels);
+    for (int32 ch = 0; ch < numMetered; ch++)
     {
-        // Envelope
-        switch (envState)
+        if (ch < firstCopy || reverbActive)
+            measureLevel (out[ch] + start, count, levelMeter.block[ch]);
+    }
+    return true;
+}
+
+// The host block is rendered in sub-blocks of at most quality.subBlockSize
+// samples. Note events split a sub-block so they start at their exact
+// offset; parameter points take effect at the first sub-block boundary at
+// or after their offset (offline: sub-blocks are split there as well).
+tresult PLUGIN_API Processor::process (ProcessData& data)
+{
+    WINESYNTH_RT_SCOPE;
+    WINESYNTH_TRACE_SCOPE ("Processor::process");
+    DenormalGuard denormalGuard;
+    const auto blockStart = std::chrono::steady_clock::now ();
+
+    // Pick up a tuning table / reverb impulse / loaded state published
+    // since the last block
+    tuning = &tuningBuffer.read ();
+    reverb.update ();
+    applyLoadedState ();
+
+    if (data.processContext && (data.processContext->state & ProcessContext::kTempoValid))
+        effectsBus.setTempo (data.processContext->tempo);
+
+    const bool hasOutput = data.numOutputs > 0 && data.outputs[0].channelBuffers32;
+    const int32 numChannels = hasOutput ? data.outputs[0].numChannels : 0;
+    const int32 numSamples = hasOutput ? data.numSamples : 0;
+    float** out = hasOutput ? data.outputs[0].channelBuffers32 : nullptr;
+
+    // Idle fast path: nothing sounding and nothing queued, so the block is
+    // silent. One clear per channel (VST3 does not let us assume the host
+    // kept our last zeros) and the silence flags; no sub-block loop.
+    IParameterChanges* paramChanges = data.inputParameterChanges;
+    IEventList* events = data.inputEvents;
+    if ((!paramChanges || paramChanges->getParameterCount () == 0)
+        && (!events || events->getEventCount () == 0) && !isOutputActive ())
+    {
+        for (int32 ch = 0; ch < numChannels; ch++)
+            memset (out[ch], 0, numSamples * sizeof (float));
+        if (hasOutput)
+            data.outputs[0].silenceFlags = ((1ULL << numChannels) - 1);
+        finishBlock (data, blockStart, true);
+        return kResultOk;
+    }
+
+    // Parameter queues, consumed as rendering advances
+    ParamCursor cursors[kNumParams];
+    int32 numCursors = 0;
+    if (paramChanges)
+    {
+        int32 numQueues = paramChanges->getParameterCount ();
+        for (int32 i = 0; i < numQueues && numCursors < kNumParams; i++)
         {
-            case kAttack:
-                envLevel += attackRate;
-                if (envLevel >= 1.0)
-                {
-                    envLevel = 1.0;
-                    envState = noteOn ? kAttack : kRelease;
-                    if (noteOn) envState = kAttack; // stay at 1.0
-                }
-                break;
-            case kRelease:
-                envLevel -= releaseRate;
-                if (envLevel <= 0.0)
-                {
-                    envLevel = 0.0;
-                    envState = kIdle;
-                }
-                break;
-            case kIdle:
-            default:
+            IParamValueQueue* queue = paramChanges->getParameterData (i);
+            if (!queue || queue->getParameterId () >= (ParamID)kNumParams)
+                continue;
+            ParamCursor& c = cursors[numCursors++];
+            c.queue = queue;
+            c.id = queue->getParameterId ();
+            c.numPoints = queue->getPointCount ();
+            c.next = 0;
+            c.load ();
+        }
+    }
+
+    // Events arrive sorted by sample offset
+    const int32 numEvents = events ? events->getEventCount () : 0;
+    int32 eventIndex = 0;
+    Event event {};
+    int32 eventOffset = kNoOffset;
+    auto fetchEvent = [&] () {
+        eventOffset = kNoOffset;
+        while (eventIndex < numEvents)
+        {
+            if (events->getEvent (eventIndex++, event) == kResultOk)
+            {
+                eventOffset = std::max<int32> (event.sampleOffset, 0);
                 break;
+            }
         }
+    };
+    fetchEvent ();
 
-        float sample = 0.f;
-        if (envLevel > 0.0)
+    bool audible = false;
+    for (int32 pos = 0;;)
+    {
+        // After the last sample, flush whatever is left in the queues
+        const int32 at = pos < numSamples ? pos : kNoOffset - 1;
+
+        ParamValue keyboardNote = applyParamChanges (cursors, numCursors, at);
+        updateDerivedParams ();   // envelope / filter values are needed by note events
+        if (keyboardNote >= 0.0)
+            handleKeyboardNote (keyboardNote);
+
+        while (eventOffset <= at)
         {
-            double raw = generateSample (phase, iWaveform);
-
-            // Cytomic SVF low-pass (topology-preserving transform)
-            double v0 = raw;
-            double hp = a1 * (v0 - k * ic1eq - ic2eq);
-            double bp = a2 * (v0 - k * ic1eq - ic2eq) + ic1eq;
-            double lp = a2 * ic1eq + ic2eq + g * hp;
-            ic1eq = 2.0 * bp - ic1eq;
-            ic2eq = 2.0 * lp - ic2eq;
-
-            sample = (float)(lp * fGain * envLevel);
-            phase += phaseInc;
-            if (phase >= 2.0 * M_PI)
-                phase -= 2.0 * M_PI;
+            handleEvent (event, data.outputParameterChanges);
+            fetchEvent ();
         }
 
-        for (int32 ch = 0; ch < numChannels; ch++)
-            out[ch][s] = sample;
+        if (pos >= numSamples)
+            break;
+
+        int32 end = std::min (std::min (numSamples, pos + quality.subBlockSize), eventOffset);
+        if (quality.sampleAccurateParams)
+        {
+            for (int32 i = 0; i < numCursors; i++)
+                end = std::min (end, cursors[i].nextOffset);
+        }
+        audible |= renderSubBlock (out, numChannels, pos, end - pos);
+        pos = end;
     }
 
-    data.outputs[0].silenceFlags = (envState == kIdle) ? ((1ULL << numChannels) - 1) : 0;
+    if (hasOutput)
+        data.outputs[0].silenceFlags = audible ? 0 : ((1ULL << numChannels) - 1);
+    finishBlock (data, blockStart, false);
     return kResultOk;
 }
 
+// Hands the output to the spectrum analyzers, closes the block's output
+// levels, feeds the block's load to the governor (realtime only) and the
+// instance statistics, and reports the quality level to the controller
+// whenever it changes
+void Processor::finishBlock (ProcessData& data, std::chrono::steady_clock::time_point start, bool idle)
+{
+    const bool hasOutput = data.numOutputs > 0 && data.outputs[0].channelBuffers32;
+    if (hasOutput)
+        spectrumTap.push (data.outputs[0].channelBuffers32, data.outputs[0].numChannels, data.numSamples);
+    levelMeter.update (hasOutput ? data.outputs[0].numChannels : 0, data.numSamples, sampleRate);
+
+    const double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    const double blockSeconds = data.numSamples / sampleRate;
+    if (quality.governed && data.numSamples > 0)
+    {
+        if (governor.update (elapsed, blockSeconds))
+            applyQualityLevel ();
+    }
+
+    const int32_t level = quality.governed ? governor.getLevel () : kQualityFull;
+    if (level != reportedLevel && data.outputParameterChanges)
+    {
+        int32 qidx;
+        if (auto* q = data.outputParameterChanges->addParameterData (kQualityLevelId, qidx))
+            q->addPoint (0, level / (double)(kNumQualityLevels - 1), qidx);
+        reportedLevel = level;
+    }
+
+    publishStats (elapsed, blockSeconds, idle);
+}
+
+static_assert (LevelMeter::kNumChannels == InstanceStats::kNumLevels, "every metered channel is published");
+
+// Updates this instance's row in the process-wide statistics (wait-free)
+void Processor::publishStats (double elapsedSeconds, double blockSeconds, bool idle)
+{
+    if (blockSeconds > 0.0)
+    {
+        const double load = elapsedSeconds / blockSeconds;
+        const double a = 1.0 - exp (-blockSeconds / kStatsSmoothingSeconds);
+        stats.load = (float)(stats.load + a * (load - stats.load));
+        stats.peakLoad = (float)std::max (load, stats.peakLoad * exp (-blockSeconds / kStatsPeakSeconds));
+    }
+    stats.blockMicros = (float)(elapsedSeconds * 1e6);
+    stats.voices = (uint32_t)voiceManager.getNumActive ();
+    stats.idle = idle ? 1 : 0;
+    stats.qualityLevel = (uint32_t)(quality.governed ? governor.getLevel () : kQualityFull);
+    stats.memoryKiB = (uint32_t)((arena.getCapacity () + workerArena.getCapacity () + reverb.getImpulseBytes ()) >> 10);
+    stats.blocks++;
+    for (int32_t c = 0; c < InstanceStats::kNumLevels; c++)
+    {
+        stats.levelPeak[c] = levelMeter.getPeak (c);
+        stats.levelRms[c] = levelMeter.getRms (c);
+    }
+    statsPublisher.publish (stats);
+}
+
+// Called by the host off the audio thread: the parameters go to process ()
+// as one snapshot. A snapshot the audio thread has not applied yet is
+// merged into the next one, so back-to-back loads lose nothing.
 tresult PLUGIN_API Processor::setState (IBStream* state)
 {
     IBStreamer streamer (state, kLittleEndian);
-    float f; int32 i;
 
-    if (!streamer.readFloat (f)) return kResultFalse; fGain = f;
-    if (!streamer.readFloat (f)) return kResultFalse; fCutoff = f;
-    if (!streamer.readFloat (f)) return kResultFalse; fFine = f;
-    if (!streamer.readFloat (f)) return kResultFalse; fResonance = f;
-    if (!streamer.readInt32 (i)) return kResultFalse; iWaveform = i;
-    if (!streamer.readFloat (f)) return kResultFalse; fAttack = f;
-    if (!streamer.readFloat (f)) return kResultFalse; fRelease = f;
-    if (!streamer.readInt32 (i)) return kResultFalse; bBypass = i > 0;
+    // A state replaces every stored parameter; those the stream predates
+    // are set to their defaults, so none keeps a value from before
+    LoadedState next;
+    for (const auto& p : kParamTable)
+    {
+        if (p.storage == ParamStorage::kNone)
+            continue;
+        next.values[p.id] = p.defaultNormalized;
+        next.loaded |= paramBit (p.id);
+    }
+    bool ok = readParamState (streamer, [&next] (ParamID id, double value) { next.values[id] = value; });
+    if (!ok)
+        return kResultFalse;
+
+    next.serial = lastLoaded.serial + 1;
+    lastLoaded = next;
+    stateBuffer.getWriteBuffer () = next;
+    stateBuffer.publish ();
+
+    // Optional tuning chunk: scale and keyboard mapping text
+    std::string text[2];
+    for (auto& t : text)
+    {
+        int32 length = 0;
+        if (!streamer.readInt32 (length) || length < 0)
+            return kResultOk;
+        t.resize (length);
+        if (length > 0 && streamer.readRaw (&t[0], length) != length)
+            return kResultOk;
+    }
+    setTuning (text[0], text[1]);
 
+    // Optional reverb impulse path
+    int32 length = 0;
+    std::string path;
+    if (streamer.readInt32 (length) && length > 0)
+    {
+        path.resize (length);
+        if (streamer.readRaw (&path[0], length) != length)
+            return kResultOk;
+    }
+    if (path != impulsePath)
+        loadImpulse (path);
     return kResultOk;
 }
 
@@ -291,15 +1292,18 @@ tresult PLUGIN_API Processor::getState (IBStream* state)
 {
     IBStreamer streamer (state, kLittleEndian);
 
-    streamer.writeFloat (fGain);
-    streamer.writeFloat (fCutoff);
-    streamer.writeFloat (fFine);
-    streamer.writeFloat (fResonance);
-    streamer.writeInt32 (iWaveform);
-    streamer.writeFloat (fAttack);
-    streamer.writeFloat (fRelease);
-    streamer.writeInt32 (bBypass ? 1 : 0);
+    // A state loaded since the last block is not in params [] yet
+    const bool pending = appliedStateSerial.load (std::memory_order_acquire) != lastLoaded.serial;
+    writeParamState (streamer, [&] (ParamID id) {
+        return pending && (lastLoaded.loaded & paramBit (id)) ? lastLoaded.values[id] : params[id];
+    });
 
+    for (const std::string* t : {&scaleText, &mappingText, &impulsePath})
+    {
+        streamer.writeInt32 ((int32)t->size ());
+        if (!t->empty ())
+            streamer.writeRaw (t->data (), (int32)t->size ());
+    }
     return kResultOk;
 }
 
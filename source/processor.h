@@ -1,15 +1,42 @@
 #pragma once
 
+#include "params.h"
+#include "envelope.h"
+#include "voice.h"
+#include "filter.h"
+#include "shaper.h"
+#include "effects.h"
+#include "reverb.h"
+#include "arena.h"
+#include "oversampling.h"
+#include "governor.h"
+#include "additive.h"
+#include "oscpair.h"
+#include "unison.h"
+#include "tuning.h"
+#include "lockfree.h"
+#include "workerpool.h"
+#include "instancestats.h"
+#include "meter.h"
+#include "spectrum.h"
+
 #include "public.sdk/source/vst/vstaudioeffect.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "pluginterfaces/vst/ivstevents.h"
 
-namespace WineSynth {
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
 
-enum EnvState { kIdle, kAttack, kRelease };
+namespace WineSynth {
 
 class Processor : public Steinberg::Vst::AudioEffect
 {
 public:
     Processor ();
+    ~Processor () SMTG_OVERRIDE;
 
     static Steinberg::FUnknown* createInstance (void*)
     {
@@ -17,43 +44,205 @@ public:
     }
 
     Steinberg::tresult PLUGIN_API initialize (Steinberg::FUnknown* context) SMTG_OVERRIDE;
+    Steinberg::tresult PLUGIN_API terminate () SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API setActive (Steinberg::TBool state) SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API process (Steinberg::Vst::ProcessData& data) SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API setState (Steinberg::IBStream* state) SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API getState (Steinberg::IBStream* state) SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API setupProcessing (Steinberg::Vst::ProcessSetup& newSetup) SMTG_OVERRIDE;
     Steinberg::tresult PLUGIN_API canProcessSampleSize (Steinberg::int32 symbolicSampleSize) SMTG_OVERRIDE;
+    Steinberg::tresult PLUGIN_API notify (Steinberg::Vst::IMessage* message) SMTG_OVERRIDE;
+    Steinberg::tresult PLUGIN_API connect (Steinberg::Vst::IConnectionPoint* other) SMTG_OVERRIDE;
 
 private:
+    // Render quality, picked from ProcessSetup::processMode. Realtime keeps
+    // sub-blocks small (per-voice scratch and mix stay in L1, automation
+    // lands within 32 samples) and renders voices at the sample rate.
+    // Offline bounces oversample the voices (oscillator, drive, filter),
+    // double the unison stack (same detune between the outermost
+    // oscillators, so denser rather than wider) and use longer sub-blocks,
+    // cut at every parameter point instead.
+    struct QualityProfile
+    {
+        Steinberg::int32 oversampling;      // voice render rate factor (1..DecimatorState::kMaxFactor)
+        Steinberg::int32 subBlockSize;      // internal render granularity, independent of the host block
+        Steinberg::int32 unisonMultiplier;  // oscillators per Unison step while unison is on
+        bool sampleAccurateParams;          // split sub-blocks at parameter points
+        bool governed;                      // QualityGovernor may step quality down
+    };
+    static constexpr QualityProfile kRealtimeQuality {1, 32, 1, false, true};
+    static constexpr QualityProfile kOfflineQuality {4, 256, 2, true, false};
+
+    // Polynomial sine used at kQualityCheapOscillators (internal waveform)
+    static constexpr int32_t kWaveSineFast = kNumWaveforms;
+
+    static constexpr double kStealFadeMs = 3.0;
+
+    // Instance statistics: load smoothing and how fast the peak falls back
+    static constexpr double kStatsSmoothingSeconds = 0.3;
+    static constexpr double kStatsPeakSeconds = 3.0;
+
+    // Fewer active voices than this render on the audio thread alone: the
+    // handoff to the worker pool would cost more than it saves
+    static constexpr int32_t kParallelMinVoices = 4;
+
+    // Additive partials per voice at kQualityCheapOscillators
+    static constexpr int32_t kCheapPartials = 64;
+
     double generateSample (double phase, int waveform);
 
-    // Parameters
-    float fGain = 0.5f;
-    float fCutoff = 1.0f;      // normalized (1.0 = fully open)
-    float fFine = 0.5f;        // normalized
-    float fResonance = 0.0f;   // normalized
+    void allocateDspMemory ();
+    void allocateWorkerMemory ();
+
+    // Per-voice scratch, one set per worker of the render pool
+    struct VoiceScratch
+    {
+        float* env = nullptr;          // one sub-block of envelope levels
+        float* osc = nullptr;          // oscillator pair / additive output, one oversampled sub-block
+        float* unisonLeft = nullptr;   // unison stack before filter and decimation
+        float* unisonRight = nullptr;  // (one oversampled sub-block each)
+    };
+
+    // Read position in one input parameter queue
+    struct ParamCursor
+    {
+        Steinberg::Vst::IParamValueQueue* queue;
+        Steinberg::Vst::ParamID id;
+        Steinberg::int32 numPoints;
+        Steinberg::int32 next;          // index of the next unapplied point
+        Steinberg::int32 nextOffset;    // its sample offset, kNoOffset when done
+        Steinberg::Vst::ParamValue nextValue;
+
+        void load ();
+    };
+    static constexpr Steinberg::int32 kNoOffset = 0x7fffffff;
+
+    // Parameter values of a setState () call, handed to the audio thread
+    // whole so that only the audio thread touches params and dirtyParams
+    struct LoadedState
+    {
+        Steinberg::Vst::ParamValue values[kNumParams] = {};
+        ParamMask loaded = 0;           // every stored parameter, read or defaulted
+        uint32_t serial = 0;            // counts setState () calls
+    };
+
+    void applyLoadedState ();
+    Steinberg::Vst::ParamValue applyParamChanges (ParamCursor* cursors, Steinberg::int32 numCursors,
+                                                  Steinberg::int32 position);
+    void handleEvent (const Steinberg::Vst::Event& event, Steinberg::Vst::IParameterChanges* outputChanges);
+    void finishBlock (Steinberg::Vst::ProcessData& data, std::chrono::steady_clock::time_point start, bool idle);
+    void publishStats (double elapsedSeconds, double blockSeconds, bool idle);
+    void applyQualityLevel ();
+    void fadeExcessVoices (int32_t limit);
+    bool isOutputActive () const;
+    bool renderSubBlock (float** out, Steinberg::int32 numChannels, Steinberg::int32 start, Steinberg::int32 count);
+
+    void setParam (Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue value);
+    void updateDerivedParams ();
+    void handleKeyboardNote (Steinberg::Vst::ParamValue value);
+
+    bool setTuning (const std::string& scl, const std::string& kbm);
+    void publishTuning ();
+    void loadImpulse (const std::string& path);
+
+    void noteOn (int16_t pitch);
+    void noteOff (int16_t pitch);
+    void startVoice (Voice& voice, int16_t pitch);
+    void beginStealFade (Voice& voice);
+    void renderVoices (float* mixL, float* mixR, Steinberg::int32 numSamples);
+    void renderVoicesParallel (float* mixL, float* mixR, Steinberg::int32 numSamples);
+    void finishVoice (int32_t index);
+    void renderVoice (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR, Steinberg::int32 numSamples);
+    template <bool Fade>
+    void dispatchVoiceSegment (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR,
+                               Steinberg::int32 numSamples);
+    template <bool Fade, bool Oversampled, bool Buffered, typename Filter, typename Shaper>
+    void renderVoiceSegment (Voice& voice, const VoiceScratch& scratch, float* mix, Steinberg::int32 numSamples);
+    template <bool Fade, bool Oversampled, typename Filter, typename Shaper>
+    void renderUnisonSegment (Voice& voice, const VoiceScratch& scratch, float* mixL, float* mixR,
+                              Steinberg::int32 numSamples);
+
+    // Parameters (normalized, indexed by parameter ID)
+    Steinberg::Vst::ParamValue params[kNumParams];
+    ParamMask dirtyParams = kAllParams;
+
+    // Loaded state on its way to the audio thread (see LoadedState)
+    TripleBuffer<LoadedState> stateBuffer;
+    LoadedState lastLoaded;                         // setState () / getState () thread only
+    std::atomic<uint32_t> appliedStateSerial {0};   // serial of the state params [] reflects
+
+    // Derived values — recomputed in updateDerivedParams () only when one of
+    // their input parameters (or the sample rate) has changed
+    double gain = 0.5;
+    double pitchRatio = 1.0;       // fine tune * pitch bend
     int32_t iWaveform = 0;
-    float fAttack = 0.05f;     // normalized
-    float fRelease = 0.3f;     // normalized
+    int32_t renderWaveform = 0;    // iWaveform, or a cheaper kernel under load
+    bool additiveMode = false;     // kOscModeAdditive
+    int32_t osc2Waveform = 0;
+    int32_t renderOsc2Waveform = 0;
+    int32_t polyphony = 8;         // Voices parameter; the governor may cap it
+    int32_t filterMode = kFilterLowpass;
+    bool driveEnabled = false;
+    int32_t driveType = kShaperSoft;
+    double driveGain = 1.0;
+    double driveNorm = 1.0;        // 1 / shaper (driveGain): full scale in → full scale out
     bool bBypass = false;
+    EnvelopeParams envParams;
+    UnisonSetup unisonSetup;       // count > 1: voices render in stereo
+    OscPairSettings oscPair;       // isActive (): voices render both oscillators
+    AdditiveProfile additiveProfile;
+    int32_t renderPartials = AdditiveState::kMaxPartials;   // governor cap on the profile
 
     // DSP state
-    double phase = 0.0;
     double sampleRate = 44100.0;
+    QualityProfile quality = kRealtimeQuality;
+    Decimator decimator;            // oversampled voices back to sampleRate
+    QualityGovernor governor;
+    int32_t reportedLevel = -1;     // last level sent to the controller
+    StatsPublisher statsPublisher;  // our slot in the process-wide instance statistics
+    InstanceStats stats;            // what the audio thread last published there
+    LevelMeter levelMeter;          // output peak / RMS, published with the statistics
+    SpectrumTap spectrumTap;        // output to the editors' spectrum analyzers
+    Steinberg::int32 stealFadeSamples = 1;
+    uint32_t unisonSeed = 0x2545f491u;   // random unison start phases
+
+    // Filter coefficients, shared by all voices (at the voice render rate)
+    FilterCoeffs filterCoeffs;
+
+    // Effects after the voice mix
+    EffectsBus effectsBus;
+    ConvolutionReverb reverb;
+    std::string impulsePath;        // empty = no impulse; touched off the audio thread only
+    std::thread impulseLoader;
+
+    // Voices
+    VoiceManager voiceManager;
+
+    // Optional render threads (Render Threads parameter, applied in
+    // setActive). Every voice renders into its own slot of voiceOut and the
+    // slots are summed in voice age order, exactly the additions of the
+    // single-threaded loop: the output does not depend on the thread count.
+    WorkerPool workerPool;
+    Arena workerArena;
+    float* voiceOut = nullptr;      // VoiceManager::kMaxVoices stereo slots of one sub-block
 
-    // SVF filter state (Cytomic TPT)
-    double ic1eq = 0.0;
-    double ic2eq = 0.0;
+    // All DSP buffers live in the arena, sized in allocateDspMemory () for
+    // the sample rate; process () never allocates
+    Arena arena;
+    VoiceScratch voiceScratch[WorkerPool::kMaxWorkers];   // [0] here, the helpers' in workerArena
+    float* mixBuffer = nullptr;     // one sub-block of summed voice output
+    float* mixBufferR = nullptr;    // right half of the mix while unison is on
 
-    // Envelope
-    EnvState envState = kIdle;
-    double envLevel = 0.0;
-    double attackRate = 0.0;
-    double releaseRate = 0.0;
+    // Tuning — scale/mapping text is only touched off the audio thread; the
+    // table reaches process () through tuningBuffer
+    PitchRatio pitchRatioTable;
+    std::string scaleText;          // empty = 12-TET
+    std::string mappingText;        // empty = default mapping (A4 = 440 Hz)
+    TripleBuffer<TuningTable> tuningBuffer;
+    const TuningTable* tuning = nullptr;
 
-    // MIDI
-    float noteFrequency = 440.0f;
-    bool noteOn = false;
+    // GUI keyboard (monophonic)
+    int16_t guiNotePitch = -1;
 };
 
 } // namespace WineSynth
@@ -0,0 +1,334 @@
+#include "reverb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+namespace {
+
+constexpr int32_t kChannelStride = 2 * ConvolutionReverb::kNumBins;   // re | im
+constexpr int32_t kSlotStride = 2 * kChannelStride;                   // left | right
+constexpr int32_t kTapsPerStep = 24;                                  // impulse lowpass length per unit of decimation
+
+// Cubic Hermite interpolation of src at pos; samples outside are zero
+float interpolate (const std::vector<float>& src, double pos)
+{
+    const int32_t n = (int32_t)src.size ();
+    const int32_t i = (int32_t)floor (pos);
+    const float t = (float)(pos - i);
+    auto at = [&] (int32_t k) { return (k >= 0 && k < n) ? src[k] : 0.f; };
+
+    float y0 = at (i - 1), y1 = at (i), y2 = at (i + 1), y3 = at (i + 2);
+    float c1 = 0.5f * (y2 - y0);
+    float c2 = y0 - 2.5f * y1 + 2.f * y2 - 0.5f * y3;
+    float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+    return ((c3 * t + c2) * t + c1) * t + y1;
+}
+
+// Zero-phase lowpass of src (Blackman-windowed sinc) at cutoff times its
+// Nyquist, for decimating an impulse without folding the top octave back
+std::vector<float> lowpass (const std::vector<float>& src, double cutoff)
+{
+    const int32_t half = (int32_t)ceil (0.5 * kTapsPerStep / cutoff);
+    const int32_t taps = 2 * half + 1;
+    std::vector<double> coeffs (taps);
+    double sum = 0.0;
+    for (int32_t i = 0; i < taps; i++)
+    {
+        double x = i - half;
+        double sinc = x == 0.0 ? cutoff : sin (M_PI * cutoff * x) / (M_PI * x);
+        double w = 0.42 - 0.5 * cos (2.0 * M_PI * i / (taps - 1)) + 0.08 * cos (4.0 * M_PI * i / (taps - 1));
+        coeffs[i] = sinc * w;
+        sum += coeffs[i];
+    }
+
+    const int32_t n = (int32_t)src.size ();
+    std::vector<float> dst (n);
+    for (int32_t i = 0; i < n; i++)
+    {
+        const int32_t first = std::max (0, half - i);
+        const int32_t last = std::min (taps, n - i + half);
+        double y = 0.0;
+        for (int32_t k = first; k < last; k++)
+            y += coeffs[k] * src[i + k - half];
+        dst[i] = (float)(y / sum);
+    }
+    return dst;
+}
+
+// Adds the product of one FDL slot and one impulse partition to accum
+void multiplyAccumulate (const float* x, const float* h, float* accum)
+{
+    const int32_t bins = ConvolutionReverb::kNumBins;
+    for (int32_t ch = 0; ch < 2; ch++)
+    {
+        const float* xr = x + ch * kChannelStride;
+        const float* xi = xr + bins;
+        const float* hr = h + ch * kChannelStride;
+        const float* hi = hr + bins;
+        float* ar = accum + ch * kChannelStride;
+        float* ai = ar + bins;
+        for (int32_t k = 0; k < bins; k++)
+        {
+            ar[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            ai[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+}
+
+// Separates the spectra of two real signals packed as z = left + i * right
+// into split half spectra (bins 0..N/2) at dst (layout of one FDL slot)
+void splitSpectrum (const Fft::Complex* z, float* dst)
+{
+    const int32_t n = ConvolutionReverb::kFftSize;
+    const int32_t bins = ConvolutionReverb::kNumBins;
+    float* lRe = dst;
+    float* lIm = dst + bins;
+    float* rRe = dst + kChannelStride;
+    float* rIm = rRe + bins;
+
+    for (int32_t k = 0; k < bins; k++)
+    {
+        const Fft::Complex a = z[k];
+        const Fft::Complex b = z[(n - k) & (n - 1)];
+        lRe[k] = 0.5f * (a.real () + b.real ());
+        lIm[k] = 0.5f * (a.imag () - b.imag ());
+        rRe[k] = 0.5f * (a.imag () + b.imag ());
+        rIm[k] = -0.5f * (a.real () - b.real ());
+    }
+}
+
+} // namespace
+
+ConvolutionReverb::ConvolutionReverb ()
+{
+    fft.init (kFftSize);
+}
+
+size_t ConvolutionReverb::getArenaBytes ()
+{
+    return 2 * Arena::bytesFor<float> (kFftSize) + 2 * Arena::bytesFor<float> (kPartitionSize)
+         + Arena::bytesFor<Fft::Complex> (kFftSize) + Arena::bytesFor<float> (kSlotStride);
+}
+
+void ConvolutionReverb::prepare (Arena& arena)
+{
+    for (int32_t ch = 0; ch < 2; ch++)
+    {
+        input[ch] = arena.allocate<float> (kFftSize);
+        output[ch] = arena.allocate<float> (kPartitionSize);
+    }
+    work = arena.allocate<Fft::Complex> (kFftSize);
+    accum = arena.allocate<float> (kSlotStride);
+    fill = 0;
+    accumulated = 0;
+    tailLeft = 0;
+}
+
+std::unique_ptr<ImpulseResponse> ConvolutionReverb::makeImpulse (const AudioFile& file, double sampleRate) const
+{
+    if (file.channels.empty () || file.getNumFrames () == 0 || sampleRate <= 0.0)
+        return nullptr;
+
+    // Resample to the processing rate; a mono impulse feeds both channels.
+    // Going down, everything above the new Nyquist is filtered out first.
+    const double step = file.sampleRate / sampleRate;
+    const int32_t length = std::min ((int32_t)(file.getNumFrames () / step),
+                                     (int32_t)(kMaxImpulseSeconds * sampleRate));
+    if (length <= 0)
+        return nullptr;
+
+    std::vector<float> h[2];
+    double energy = 0.0;
+    for (int32_t ch = 0; ch < 2; ch++)
+    {
+        const auto& channel = file.channels[std::min<size_t> (ch, file.channels.size () - 1)];
+        const std::vector<float> filtered = step > 1.0 ? lowpass (channel, 0.9 / step) : std::vector<float> ();
+        const auto& src = step > 1.0 ? filtered : channel;
+        h[ch].resize (length);
+        double e = 0.0;
+        for (int32_t i = 0; i < length; i++)
+        {
+            h[ch][i] = interpolate (src, i * step);
+            e += (double)h[ch][i] * h[ch][i];
+        }
+        energy = std::max (energy, e);
+    }
+
+    // Unit energy, so the wet level does not depend on the impulse length
+    const float norm = energy > 0.0 ? (float)(1.0 / sqrt (energy)) : 0.f;
+
+    auto impulse = std::make_unique<ImpulseResponse> ();
+    impulse->length = length;
+    impulse->numPartitions = (length + kPartitionSize - 1) / kPartitionSize;
+    impulse->spectra.assign ((size_t)impulse->numPartitions * kSlotStride, 0.f);
+    impulse->history.assign (impulse->spectra.size (), 0.f);
+
+    std::vector<Fft::Complex> z (kFftSize);
+    for (int32_t p = 0; p < impulse->numPartitions; p++)
+    {
+        std::fill (z.begin (), z.end (), Fft::Complex ());
+        const int32_t start = p * kPartitionSize;
+        const int32_t count = std::min (kPartitionSize, length - start);
+        for (int32_t i = 0; i < count; i++)
+            z[i] = Fft::Complex (h[0][start + i] * norm, h[1][start + i] * norm);
+
+        fft.forward (z.data ());
+        splitSpectrum (z.data (), impulse->spectra.data () + (size_t)p * kSlotStride);
+    }
+    return impulse;
+}
+
+void ConvolutionReverb::publish (std::unique_ptr<ImpulseResponse> newImpulse)
+{
+    // The write slot is never visible to the reader, so the impulse it held
+    // (if any) is released here, on the loader thread
+    impulses.getWriteBuffer () = std::move (newImpulse);
+    impulses.publish ();
+}
+
+void ConvolutionReverb::update ()
+{
+    ImpulseResponse* latest = impulses.read ().get ();
+    if (latest == impulse)
+        return;
+
+    impulse = latest;
+    for (int32_t ch = 0; ch < 2; ch++)
+    {
+        std::fill (input[ch], input[ch] + kFftSize, 0.f);
+        std::fill (output[ch], output[ch] + kPartitionSize, 0.f);
+    }
+    std::fill (accum, accum + kSlotStride, 0.f);
+    fill = 0;
+    accumulated = 0;
+    tailLeft = 0;
+}
+
+void ConvolutionReverb::reset ()
+{
+    for (int32_t ch = 0; ch < 2; ch++)
+    {
+        std::fill (input[ch], input[ch] + kFftSize, 0.f);
+        std::fill (output[ch], output[ch] + kPartitionSize, 0.f);
+    }
+    if (impulse)
+    {
+        std::fill (impulse->history.begin (), impulse->history.end (), 0.f);
+        impulse->historyPos = 0;
+    }
+    std::fill (accum, accum + kSlotStride, 0.f);
+    fill = 0;
+    accumulated = 0;
+    tailLeft = 0;
+}
+
+void ConvolutionReverb::process (float* left, float* right, int32_t numSamples, bool inputActive)
+{
+    if (!impulse)
+        return;
+
+    float* io[2] = {left, right};
+    for (int32_t pos = 0; pos < numSamples;)
+    {
+        const int32_t count = std::min (numSamples - pos, kPartitionSize - fill);
+        for (int32_t ch = 0; ch < 2; ch++)
+        {
+            float* x = io[ch] + pos;
+            float* in = input[ch] + kPartitionSize + fill;
+            const float* wet = output[ch] + fill;
+            memcpy (in, x, count * sizeof (float));
+            for (int32_t s = 0; s < count; s++)
+                x[s] += wetGain * wet[s];
+        }
+
+        fill += count;
+        pos += count;
+
+        // Older partitions of the next output, in step with the input
+        accumulateHistory ((int32_t)((int64_t)(impulse->numPartitions - 1) * fill / kPartitionSize));
+        if (fill == kPartitionSize)
+        {
+            processPartition ();
+            fill = 0;
+        }
+    }
+
+    if (inputActive)
+        tailLeft = impulse->length + 2 * kPartitionSize;
+    else
+        tailLeft = std::max<int64_t> (0, tailLeft - numSamples);
+}
+
+void ConvolutionReverb::accumulateHistory (int32_t upTo)
+{
+    // Partition p of the next output pairs with the spectrum p - 1 slots
+    // behind the newest one; for p >= 1 those are all in the FDL already
+    const int32_t numPartitions = impulse->numPartitions;
+    const float* history = impulse->history.data ();
+    const float* spectra = impulse->spectra.data ();
+    for (; accumulated < upTo; accumulated++)
+    {
+        const int32_t p = accumulated + 1;
+        int32_t slot = impulse->historyPos + p - 1;
+        if (slot >= numPartitions)
+            slot -= numPartitions;
+        multiplyAccumulate (history + (size_t)slot * kSlotStride, spectra + (size_t)p * kSlotStride, accum);
+    }
+}
+
+void ConvolutionReverb::processPartition ()
+{
+    const int32_t numPartitions = impulse->numPartitions;
+
+    // Previous and current input partition, both channels in one transform
+    for (int32_t k = 0; k < kFftSize; k++)
+        work[k] = Fft::Complex (input[0][k], input[1][k]);
+    fft.forward (work);
+
+    // Newest spectrum goes one slot back, so partition p pairs with slot pos + p
+    int32_t pos = impulse->historyPos - 1;
+    if (pos < 0)
+        pos += numPartitions;
+    impulse->historyPos = pos;
+    float* newest = impulse->history.data () + (size_t)pos * kSlotStride;
+    splitSpectrum (work, newest);
+
+    // Partitions 1.. were accumulated while this input came in
+    multiplyAccumulate (newest, impulse->spectra.data (), accum);
+
+    // Repack Y = Yl + i * Yr over the full spectrum (both halves Hermitian)
+    const float* lRe = accum;
+    const float* lIm = lRe + kNumBins;
+    const float* rRe = lRe + kChannelStride;
+    const float* rIm = rRe + kNumBins;
+    for (int32_t k = 0; k < kNumBins; k++)
+        work[k] = Fft::Complex (lRe[k] - rIm[k], lIm[k] + rRe[k]);
+    for (int32_t k = kNumBins; k < kFftSize; k++)
+    {
+        const int32_t m = kFftSize - k;
+        work[k] = Fft::Complex (lRe[m] + rIm[m], rRe[m] - lIm[m]);
+    }
+    fft.inverse (work);
+    std::fill (accum, accum + kSlotStride, 0.f);
+    accumulated = 0;
+
+    // Overlap-save: the second half is the valid linear convolution
+    const float scale = 1.f / (float)kFftSize;
+    for (int32_t k = 0; k < kPartitionSize; k++)
+    {
+        output[0][k] = work[kPartitionSize + k].real () * scale;
+        output[1][k] = work[kPartitionSize + k].imag () * scale;
+    }
+
+    for (int32_t ch = 0; ch < 2; ch++)
+        memcpy (input[ch], input[ch] + kPartitionSize, kPartitionSize * sizeof (float));
+}
+
+} // namespace WineSynth
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "arena.h"
+#include "fft.h"
+#include "lockfree.h"
+#include "wavfile.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// ImpulseResponse — partitioned spectra of a stereo impulse plus the
+// frequency-domain delay line (FDL) of input spectra that goes with it.
+// Built off the audio thread; once published only the audio thread
+// touches it.
+//
+// Spectra are stored split (re / im arrays, kNumBins each), per partition
+// and channel: [partition][channel][re | im].
+//------------------------------------------------------------------------
+struct ImpulseResponse
+{
+    int32_t numPartitions = 0;
+    int32_t length = 0;             // samples at the processing rate
+    std::vector<float> spectra;     // impulse partitions
+    std::vector<float> history;     // FDL, same layout, one slot per partition
+    int32_t historyPos = 0;         // slot of the newest input spectrum
+};
+
+//------------------------------------------------------------------------
+// ConvolutionReverb — uniformly partitioned overlap-save convolution.
+//
+// Input is collected in partitions of kPartitionSize samples; each full
+// partition costs one forward and one inverse FFT of 2 * kPartitionSize
+// for both channels together (left in the real, right in the imaginary
+// part) and one complex multiply-accumulate per impulse partition. The
+// wet signal is delayed by one partition.
+//
+// Only the newest partition's product waits for the partition boundary;
+// the older ones already have their input spectra in the FDL and are
+// accumulated a share per call to process (), so a long impulse costs
+// about the same in every sub-block instead of all of it every
+// kPartitionSize samples.
+//
+// Impulse spectra and their FDL are allocated by the loader thread with the
+// impulse; the fixed-size scratch used by process () comes from the arena.
+//
+// New impulses are handed over through a TripleBuffer: the loader thread
+// publishes, the audio thread picks the newest up in update (). Old
+// impulses are released by the loader on its next publish.
+//------------------------------------------------------------------------
+class ConvolutionReverb
+{
+public:
+    static constexpr int32_t kPartitionSize = 256;
+    static constexpr int32_t kFftSize = 2 * kPartitionSize;
+    static constexpr int32_t kNumBins = kPartitionSize + 1;
+    static constexpr double kMaxImpulseSeconds = 10.0;
+
+    ConvolutionReverb ();
+
+    // Arena space for the audio-thread buffers taken by prepare ()
+    static size_t getArenaBytes ();
+    void prepare (Arena& arena);
+
+    // Loader side (one thread at a time)
+    std::unique_ptr<ImpulseResponse> makeImpulse (const AudioFile& file, double sampleRate) const;
+    void publish (std::unique_ptr<ImpulseResponse> impulse);
+
+    // Audio side
+    void update ();                 // call once per block before process ()
+    void reset ();
+    void setMix (double mix) { wetGain = (float)mix; }
+
+    bool isEnabled () const { return wetGain > 0.f && impulse != nullptr; }
+    bool isTailActive () const { return tailLeft > 0; }
+
+    // Heap memory of the impulse in use (audio side)
+    size_t getImpulseBytes () const
+    {
+        return impulse ? (impulse->spectra.size () + impulse->history.size ()) * sizeof (float) : 0;
+    }
+
+    // Adds the wet signal to left / right in place
+    void process (float* left, float* right, int32_t numSamples, bool inputActive);
+
+private:
+    void accumulateHistory (int32_t upTo);
+    void processPartition ();
+
+    Fft fft;
+    float wetGain = 0.f;
+
+    TripleBuffer<std::unique_ptr<ImpulseResponse>> impulses;
+    ImpulseResponse* impulse = nullptr;
+
+    // Audio-thread state (arena memory)
+    float* input[2] = {};           // last two partitions of input (overlap-save)
+    float* output[2] = {};          // wet output of the last partition
+    Fft::Complex* work = nullptr;
+    float* accum = nullptr;         // re / im per channel
+    int32_t fill = 0;
+    int32_t accumulated = 0;        // older partitions already in accum
+    int64_t tailLeft = 0;
+};
+
+} // namespace WineSynth
@@ -0,0 +1,188 @@
+#include "rtcheck.h"
+
+#if WINESYNTH_RT_CHECKS
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <pthread.h>
+#endif
+
+namespace WineSynth {
+namespace RtCheck {
+
+namespace {
+
+// Initial-exec TLS is a plain %fs-relative access. A thread_local in a
+// shared object may go through __tls_get_addr, which can allocate on a
+// thread's first access and so re-enter the malloc below.
+#if defined(_WIN32)
+thread_local int depth = 0;
+#else
+__thread int depth __attribute__ ((tls_model ("initial-exec"))) = 0;
+#endif
+
+} // namespace
+
+Scope::Scope () { depth++; }
+Scope::~Scope () { depth--; }
+
+bool isRealtime () { return depth > 0; }
+
+void violation (const char* what)
+{
+    depth = 0;   // reporting may allocate
+    fprintf (stderr, "WineSynth: %s on the audio thread (Processor::process)\n", what);
+    fflush (stderr);
+    abort ();
+}
+
+} // namespace RtCheck
+} // namespace WineSynth
+
+using WineSynth::RtCheck::isRealtime;
+using WineSynth::RtCheck::violation;
+
+//------------------------------------------------------------------------
+// Global operator new / delete replacements
+//------------------------------------------------------------------------
+namespace {
+
+void* checkedAlloc (size_t size)
+{
+    if (isRealtime ())
+        violation ("operator new");
+    if (void* p = malloc (size ? size : 1))
+        return p;
+    throw std::bad_alloc ();
+}
+
+void* checkedAlignedAlloc (size_t size, std::align_val_t align)
+{
+    if (isRealtime ())
+        violation ("operator new (aligned)");
+    size_t a = (size_t)align;
+    size = (size + a - 1) / a * a;
+#if defined(_WIN32)
+    if (void* p = _aligned_malloc (size ? size : a, a))
+        return p;
+#else
+    if (void* p = aligned_alloc (a, size ? size : a))
+        return p;
+#endif
+    throw std::bad_alloc ();
+}
+
+void checkedFree (void* p)
+{
+    if (p && isRealtime ())
+        violation ("operator delete");
+    free (p);
+}
+
+void checkedAlignedFree (void* p)
+{
+    if (p && isRealtime ())
+        violation ("operator delete (aligned)");
+#if defined(_WIN32)
+    _aligned_free (p);
+#else
+    free (p);
+#endif
+}
+
+} // namespace
+
+void* operator new (size_t size) { return checkedAlloc (size); }
+void* operator new[] (size_t size) { return checkedAlloc (size); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+    try { return checkedAlloc (size); } catch (...) { return nullptr; }
+}
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept
+{
+    try { return checkedAlloc (size); } catch (...) { return nullptr; }
+}
+void* operator new (size_t size, std::align_val_t align) { return checkedAlignedAlloc (size, align); }
+void* operator new[] (size_t size, std::align_val_t align) { return checkedAlignedAlloc (size, align); }
+
+void operator delete (void* p) noexcept { checkedFree (p); }
+void operator delete[] (void* p) noexcept { checkedFree (p); }
+void operator delete (void* p, size_t) noexcept { checkedFree (p); }
+void operator delete[] (void* p, size_t) noexcept { checkedFree (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept { checkedFree (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept { checkedFree (p); }
+void operator delete (void* p, std::align_val_t) noexcept { checkedAlignedFree (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept { checkedAlignedFree (p); }
+void operator delete (void* p, size_t, std::align_val_t) noexcept { checkedAlignedFree (p); }
+void operator delete[] (void* p, size_t, std::align_val_t) noexcept { checkedAlignedFree (p); }
+
+//------------------------------------------------------------------------
+// glibc: interpose the C allocator and mutex locking as well
+//------------------------------------------------------------------------
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void* __libc_malloc (size_t);
+void* __libc_calloc (size_t, size_t);
+void* __libc_realloc (void*, size_t);
+void __libc_free (void*);
+
+void* malloc (size_t size)
+{
+    if (isRealtime ())
+        violation ("malloc");
+    return __libc_malloc (size);
+}
+
+void* calloc (size_t count, size_t size)
+{
+    if (isRealtime ())
+        violation ("calloc");
+    return __libc_calloc (count, size);
+}
+
+void* realloc (void* p, size_t size)
+{
+    if (isRealtime ())
+        violation ("realloc");
+    return __libc_realloc (p, size);
+}
+
+void free (void* p)
+{
+    if (p && isRealtime ())
+        violation ("free");
+    __libc_free (p);
+}
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// glibc's own entry point, bound at link time: resolving the next
+// pthread_mutex_lock with dlsym from in here would take the loader's lock
+// (through this function) and allocate. It is a compat symbol since
+// glibc 2.34, so name the base version explicitly.
+int realMutexLock (pthread_mutex_t*);
+#if defined(__x86_64__)
+__asm__ (".symver realMutexLock, __pthread_mutex_lock@GLIBC_2.2.5");
+#else
+__asm__ (".symver realMutexLock, __pthread_mutex_lock@GLIBC_2.17");
+#endif
+
+int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    if (isRealtime ())
+        violation ("pthread_mutex_lock");
+    return realMutexLock (mutex);
+}
+
+#endif
+
+} // extern "C"
+
+#endif // __GLIBC__
+
+#endif // WINESYNTH_RT_CHECKS
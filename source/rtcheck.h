@@ -0,0 +1,63 @@
+#pragma once
+
+//------------------------------------------------------------------------
+// Realtime-safety checks (configure with -DWINESYNTH_RT_CHECKS=ON)
+//
+// WINESYNTH_RT_SCOPE marks the rest of the enclosing block as audio-thread
+// code. While such a scope is active on a thread, heap allocation or
+// release through operator new / delete (and, on glibc, malloc / free and
+// pthread_mutex_lock) prints the offending call and aborts, so a test or
+// validator run fails on the first hidden allocation instead of an
+// occasional xrun. WINESYNTH_RT_BLOCKING marks calls that may block but
+// cannot be intercepted (e.g. Win32 synchronization).
+//
+// Only calls that bind to these replacements are seen. In a dlopen'ed
+// plugin that is the plugin's own code, and on Linux only because the
+// RT_CHECKS build links with -Bsymbolic-functions; with plain default
+// visibility even those calls may bind to libc's definitions first.
+// Allocations made by the host (in its event and parameter queues) or
+// inside other shared libraries, libstdc++ included, go to libc and are
+// not checked. The test executable (tests/rtchecktests.cpp) links the
+// processor statically, so there everything on the thread is covered.
+//
+// In normal builds both macros expand to nothing.
+//------------------------------------------------------------------------
+
+#if WINESYNTH_RT_CHECKS
+
+namespace WineSynth {
+namespace RtCheck {
+
+class Scope
+{
+public:
+    Scope ();
+    ~Scope ();
+
+    Scope (const Scope&) = delete;
+    Scope& operator= (const Scope&) = delete;
+};
+
+bool isRealtime ();
+void violation (const char* what);
+
+} // namespace RtCheck
+} // namespace WineSynth
+
+#define WINESYNTH_RT_SCOPE WineSynth::RtCheck::Scope rtCheckScope
+#define WINESYNTH_RT_BLOCKING(what)                 \
+    do                                              \
+    {                                               \
+        if (WineSynth::RtCheck::isRealtime ())      \
+            WineSynth::RtCheck::violation (what);   \
+    } while (0)
+
+#else
+
+#define WINESYNTH_RT_SCOPE
+#define WINESYNTH_RT_BLOCKING(what) \
+    do                              \
+    {                               \
+    } while (0)
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+enum ShaperType
+{
+    kShaperSoft = 0,    // algebraic sigmoid, tanh-like knee
+    kShaperHard,        // cubic soft clipper, reaches ±1 at |x| = 1
+    kNumShaperTypes
+};
+
+//------------------------------------------------------------------------
+// Waveshapers with closed-form antiderivatives (no exp/log per sample)
+//------------------------------------------------------------------------
+
+// f(x) = x / sqrt (1 + x^2),  F(x) = sqrt (1 + x^2) - 1
+struct SoftShaper
+{
+    static double apply (double x) { return x / sqrt (1.0 + x * x); }
+    static double antiderivative (double x) { return sqrt (1.0 + x * x) - 1.0; }
+};
+
+// f(x) = 1.5 x - 0.5 x^3 for |x| <= 1, sign (x) beyond
+struct HardShaper
+{
+    static double apply (double x)
+    {
+        if (x >= 1.0) return 1.0;
+        if (x <= -1.0) return -1.0;
+        return 1.5 * x - 0.5 * x * x * x;
+    }
+
+    static double antiderivative (double x)
+    {
+        double ax = fabs (x);
+        if (ax >= 1.0)
+            return ax - 0.375;
+        double x2 = x * x;
+        return 0.75 * x2 - 0.125 * x2 * x2;
+    }
+};
+
+// Marks the linear path (no drive stage)
+struct NoShaper
+{
+};
+
+//------------------------------------------------------------------------
+// First-order antiderivative anti-aliasing (ADAA)
+//   y[n] = (F (x[n]) - F (x[n-1])) / (x[n] - x[n-1])
+// falls back to f at the midpoint when the difference is tiny. Adds half a
+// sample of delay; suppresses aliasing of the shaper without oversampling.
+//------------------------------------------------------------------------
+struct AdaaState
+{
+    double x1 = 0.0;
+    double F1 = 0.0;
+
+    void reset () { x1 = F1 = 0.0; }
+};
+
+template <typename Shaper>
+inline double processAdaa (AdaaState& st, double x)
+{
+    constexpr double kEpsilon = 1e-6;
+
+    double Fx = Shaper::antiderivative (x);
+    double dx = x - st.x1;
+    double y = (fabs (dx) > kEpsilon) ? (Fx - st.F1) / dx
+                                      : Shaper::apply (0.5 * (x + st.x1));
+    st.x1 = x;
+    st.F1 = Fx;
+    return y;
+}
+
+// Calls fn (Shaper {}) for the selected type, or fn (NoShaper {}) when off
+template <typename Fn>
+inline void dispatchShaper (bool enabled, int32_t type, Fn&& fn)
+{
+    if (!enabled)
+        fn (NoShaper {});
+    else if (type == kShaperHard)
+        fn (HardShaper {});
+    else
+        fn (SoftShaper {});
+}
+
+} // namespace WineSynth
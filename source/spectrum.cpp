@@ -0,0 +1,233 @@
+#include "spectrum.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+
+namespace WineSynth {
+
+namespace {
+
+std::mutex feedsMutex;
+std::map<uint32_t, std::weak_ptr<SpectrumFeed>> feeds;
+
+} // namespace
+
+std::shared_ptr<SpectrumFeed> SpectrumFeed::get (uint32_t instanceId)
+{
+    if (instanceId == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock (feedsMutex);
+    for (auto it = feeds.begin (); it != feeds.end ();)
+        it = it->second.expired () ? feeds.erase (it) : std::next (it);
+
+    auto& entry = feeds[instanceId];
+    auto feed = entry.lock ();
+    if (!feed)
+    {
+        feed = std::make_shared<SpectrumFeed> ();
+        entry = feed;
+    }
+    return feed;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer (std::shared_ptr<SpectrumFeed> newFeed, int32_t size, int32_t points)
+    : feed (std::move (newFeed))
+    , fftSize ([size] {
+        int32_t n = kMinFftSize;
+        while (n < size && n < kMaxFftSize)
+            n *= 2;
+        return n;
+    }())
+    , numPoints (std::max<int32_t> (2, std::min (points, SpectrumFrame::kMaxPoints)))
+{
+    fft.init (fftSize);
+    window.resize (fftSize);
+    frame.resize (fftSize);
+    spectrum.resize (fftSize / 2 + 1);
+    power.assign (fftSize / 2 + 1, 0.f);
+    bands.resize (numPoints);
+
+    // Hann window; a full scale sine on a bin peaks at |X| = sum (w) / 2
+    double sum = 0.0;
+    for (int32_t i = 0; i < fftSize; i++)
+    {
+        window[i] = (float)(0.5 - 0.5 * cos (2.0 * M_PI * i / fftSize));
+        sum += window[i];
+    }
+    powerScale = (float)(4.0 / (sum * sum));
+
+    worker = std::thread ([this] () { workerMain (); });
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer ()
+{
+    setRunning (false);
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        stopping = true;
+    }
+    wake.notify_one ();
+    worker.join ();
+}
+
+void SpectrumAnalyzer::setRunning (bool state)
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (state == running || !feed)
+            return;
+        running = state;
+        restart = state;
+    }
+    if (state)
+        feed->addListener ();
+    else
+        feed->removeListener ();
+    wake.notify_one ();
+}
+
+void SpectrumAnalyzer::setInterval (double seconds)
+{
+    intervalMicros.store ((int32_t)(seconds * 1e6), std::memory_order_relaxed);
+}
+
+void SpectrumAnalyzer::workerMain ()
+{
+    std::unique_lock<std::mutex> lock (mutex);
+    while (!stopping)
+    {
+        if (!running)
+        {
+            wake.wait (lock, [this] () { return running || stopping; });
+            continue;
+        }
+
+        const bool fresh = restart;
+        restart = false;
+        lock.unlock ();
+
+        // The first FFT waits for a full frame of new samples; whatever was
+        // in the ring while nobody listened is stale
+        if (fresh)
+        {
+            nextFrameEnd = feed->getWritten () + (uint32_t)fftSize;
+            std::fill (power.begin (), power.end (), 0.f);
+        }
+        if (analyze ())
+            publish ();
+
+        lock.lock ();
+        const auto interval = std::chrono::microseconds (intervalMicros.load (std::memory_order_relaxed));
+        wake.wait_for (lock, interval, [this] () { return stopping || !running; });
+    }
+}
+
+// Runs every FFT whose hop has arrived since the last call; returns true
+// when the levels changed
+bool SpectrumAnalyzer::analyze ()
+{
+    WINESYNTH_TRACE_SCOPE ("SpectrumAnalyzer::analyze");
+
+    const double rate = feed->getSampleRate ();
+    if (rate != feedRate)
+        configure (rate);
+
+    const int32_t hop = fftSize / kOverlap;
+    const uint32_t end = feed->getWritten ();
+    if ((int32_t)(end - nextFrameEnd) > kMaxCatchUpFrames * hop)
+        nextFrameEnd = end - (uint32_t)((kMaxCatchUpFrames - 1) * hop);
+
+    const float release = (float)exp (-hop / (rate * kReleaseSeconds));
+    bool changed = false;
+    for (; (int32_t)(end - nextFrameEnd) >= 0; nextFrameEnd += (uint32_t)hop)
+    {
+        if (!feed->read (nextFrameEnd, frame.data (), fftSize))
+            continue;
+
+        for (int32_t i = 0; i < fftSize; i++)
+            frame[i] *= window[i];
+        fft.forward (frame.data (), spectrum.data ());
+
+        for (size_t k = 0; k < power.size (); k++)
+        {
+            const float p = std::norm (spectrum[k]) * powerScale;
+            power[k] = std::max (p, power[k] * release);
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+// Maps the display points to FFT bins for a feed rate: each point takes
+// the loudest bin between it and its neighbours' midpoints, or, where the
+// points are closer than the bins (low frequencies), interpolates
+void SpectrumAnalyzer::configure (double rate)
+{
+    feedRate = rate;
+    const double binHz = rate / fftSize;
+    const double fMin = kMinFrequency;
+    const double fMax = std::min (kMaxFrequency, 0.5 * rate);
+    const double ratio = fMax / fMin;
+    const double halfStep = pow (ratio, 0.5 / (numPoints - 1));
+    const int32_t lastBin = fftSize / 2;
+
+    layout.numPoints = numPoints;
+    layout.minFrequency = (float)fMin;
+    layout.maxFrequency = (float)fMax;
+    for (int32_t i = 0; i < numPoints; i++)
+    {
+        const double t = (double)i / (numPoints - 1);
+        const double f = fMin * pow (ratio, t);
+        layout.x[i] = (float)t;
+
+        Band& band = bands[i];
+        band.lo = std::max<int32_t> (1, (int32_t)ceil (f / halfStep / binHz));
+        band.hi = std::min<int32_t> (lastBin, (int32_t)floor (f * halfStep / binHz));
+        band.frac = 0.f;
+        if (band.hi < band.lo)
+        {
+            const double pos = std::min<double> (f / binHz, lastBin - 1);
+            band.lo = (int32_t)pos;
+            band.hi = band.lo - 1;
+            band.frac = (float)(pos - band.lo);
+        }
+    }
+    std::fill (power.begin (), power.end (), 0.f);
+}
+
+void SpectrumAnalyzer::publish ()
+{
+    SpectrumFrame& out = frames.getWriteBuffer ();
+    out.numPoints = layout.numPoints;
+    out.minFrequency = layout.minFrequency;
+    out.maxFrequency = layout.maxFrequency;
+    out.sequence = ++sequence;
+
+    const float floorPower = (float)pow (10.0, kFloorDb / 10.0);
+    const float invFloorDb = (float)(1.0 / kFloorDb);
+    for (int32_t i = 0; i < numPoints; i++)
+    {
+        const Band& band = bands[i];
+        float p;
+        if (band.hi >= band.lo)
+        {
+            p = power[band.lo];
+            for (int32_t k = band.lo + 1; k <= band.hi; k++)
+                p = std::max (p, power[k]);
+        }
+        else
+        {
+            p = power[band.lo] + band.frac * (power[band.lo + 1] - power[band.lo]);
+        }
+        const float db = 10.f * log10f (std::max (p, floorPower));
+        out.x[i] = layout.x[i];
+        out.y[i] = std::min (1.f, 1.f - db * invFloorDb);
+    }
+    frames.publish ();
+}
+
+} // namespace WineSynth
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "fft.h"
+#include "lockfree.h"
+#include "oversampling.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Spectrum analyzer
+//
+// SpectrumFeed carries one processor's output (mono, decimated to at most
+// 50 kHz) to the editors that show it: a ring of samples with a single
+// writer and any number of readers, none of which ever blocks. Feeds are
+// shared by instance ID (instancestats.h), which processor and controller
+// both know. The audio thread (SpectrumTap) writes only while an analyzer
+// listens, so with no analyzer open a block costs one relaxed load.
+//
+// SpectrumAnalyzer does all the analysis on a worker thread: Hann-windowed
+// real FFTs overlapping by 1 - 1 / kOverlap, levels with an instant attack
+// and a slow release, reduced to a polyline of points evenly spaced in log
+// frequency and published through a TripleBuffer. The worker wakes at the
+// rate the view asks for; the view only scales and strokes the points.
+//------------------------------------------------------------------------
+class SpectrumFeed
+{
+public:
+    static constexpr int32_t kCapacity = 32768;         // samples, power of two
+    static constexpr int32_t kPublishInterval = 256;    // the write index is published at least this often
+
+    // Feed of an instance, created on first use; nullptr for instance ID 0.
+    // Not realtime safe.
+    static std::shared_ptr<SpectrumFeed> get (uint32_t instanceId);
+
+    void addListener () { listeners.fetch_add (1, std::memory_order_relaxed); }
+    void removeListener () { listeners.fetch_sub (1, std::memory_order_relaxed); }
+    bool isListening () const { return listeners.load (std::memory_order_relaxed) > 0; }
+
+    void setSampleRate (double rate) { sampleRate.store ((float)rate, std::memory_order_relaxed); }
+    double getSampleRate () const { return sampleRate.load (std::memory_order_relaxed); }
+
+    // Writer side (one thread)
+    void write (float x)
+    {
+        samples[pos & (kCapacity - 1)].store (x, std::memory_order_relaxed);
+        if ((++pos & (kPublishInterval - 1)) == 0)
+            publish ();
+    }
+
+    void flush () { publish (); }
+
+    // Reader side: total samples written so far (wraps)
+    uint32_t getWritten () const { return written.load (std::memory_order_acquire); }
+
+    // Copies the count samples before end (a getWritten () value) to out;
+    // false when the writer may have overwritten some of them meanwhile
+    bool read (uint32_t end, float* out, int32_t count) const
+    {
+        const uint32_t begin = end - (uint32_t)count;
+        for (int32_t i = 0; i < count; i++)
+            out[i] = samples[(begin + (uint32_t)i) & (kCapacity - 1)].load (std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        // The writer is at most kPublishInterval samples past what it published
+        const uint32_t now = written.load (std::memory_order_relaxed);
+        return now - begin + (uint32_t)kPublishInterval <= (uint32_t)kCapacity;
+    }
+
+private:
+    // The fence before the store hands the samples to getWritten (); the
+    // one after orders the store before later overwrites, so a reader that
+    // saw an overwritten sample also sees an index that tells it so
+    void publish ()
+    {
+        std::atomic_thread_fence (std::memory_order_release);
+        written.store (pos, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+    }
+
+    std::atomic<float> samples[kCapacity] {};
+    std::atomic<uint32_t> written {0};
+    uint32_t pos = 0;                               // writer only
+    std::atomic<int32_t> listeners {0};
+    std::atomic<float> sampleRate {48000.f};        // of the feed, after decimation
+};
+
+//------------------------------------------------------------------------
+// SpectrumTap — the processor's end of a feed. attach () / prepare () are
+// called while processing is stopped; push () by the audio thread with the
+// finished output of every block.
+//------------------------------------------------------------------------
+class SpectrumTap
+{
+public:
+    static constexpr double kMaxFeedRate = 50000.0;
+    static constexpr double kDecimatorCutoff = 0.8;     // of the feed's Nyquist; the display ends at 20 kHz
+
+    void attach (std::shared_ptr<SpectrumFeed> newFeed)
+    {
+        feed = std::move (newFeed);
+        if (feed)
+            feed->setSampleRate (sampleRate / decimator.getFactor ());
+    }
+
+    void prepare (double rate)
+    {
+        sampleRate = rate;
+        int32_t factor = 1;
+        while (rate / factor > kMaxFeedRate && factor < DecimatorState::kMaxFactor)
+            factor *= 2;
+        decimator.init (factor, kDecimatorCutoff);
+        history.reset ();
+        phase = 0;
+        if (feed)
+            feed->setSampleRate (rate / factor);
+    }
+
+    void push (float* const* channels, int32_t numChannels, int32_t numSamples)
+    {
+        SpectrumFeed* f = feed.get ();
+        if (!f || !f->isListening () || numChannels <= 0)
+            return;
+
+        const float* left = channels[0];
+        const float* right = numChannels > 1 ? channels[1] : channels[0];
+        const int32_t factor = decimator.getFactor ();
+        for (int32_t s = 0; s < numSamples; s++)
+        {
+            const float mono = 0.5f * (left[s] + right[s]);
+            if (factor == 1)
+            {
+                f->write (mono);
+                continue;
+            }
+            decimator.push (history, mono);
+            if (++phase == factor)
+            {
+                phase = 0;
+                f->write (decimator.output (history));
+            }
+        }
+        f->flush ();
+    }
+
+private:
+    std::shared_ptr<SpectrumFeed> feed;
+    double sampleRate = 48000.0;
+    Decimator decimator;
+    DecimatorState history;
+    int32_t phase = 0;
+};
+
+//------------------------------------------------------------------------
+// One published spectrum: the polyline in view-relative coordinates
+//------------------------------------------------------------------------
+struct SpectrumFrame
+{
+    static constexpr int32_t kMaxPoints = 512;
+
+    int32_t numPoints = 0;
+    uint32_t sequence = 0;          // counts publishes
+    float minFrequency = 20.f;      // at x = 0
+    float maxFrequency = 20000.f;   // at x = 1
+    float x[kMaxPoints] = {};       // 0..1, log frequency
+    float y[kMaxPoints] = {};       // 0..1, SpectrumAnalyzer::kFloorDb .. 0 dB
+};
+
+//------------------------------------------------------------------------
+// SpectrumAnalyzer — the worker. Construct and control it from the GUI
+// thread; read () must only be called from that thread as well.
+//------------------------------------------------------------------------
+class SpectrumAnalyzer
+{
+public:
+    static constexpr int32_t kMinFftSize = 2048;
+    static constexpr int32_t kMaxFftSize = 8192;
+    static constexpr int32_t kOverlap = 4;              // hop = FFT size / kOverlap
+    static constexpr double kMinFrequency = 20.0;
+    static constexpr double kMaxFrequency = 20000.0;
+    static constexpr double kFloorDb = -96.0;
+    static constexpr double kReleaseSeconds = 0.3;      // fall time constant of the levels
+    static constexpr int32_t kMaxCatchUpFrames = 8;     // FFTs per wake-up after a stall
+
+    // fftSize is rounded to a power of two in kMinFftSize .. kMaxFftSize
+    SpectrumAnalyzer (std::shared_ptr<SpectrumFeed> feed, int32_t fftSize, int32_t numPoints);
+    ~SpectrumAnalyzer ();
+
+    SpectrumAnalyzer (const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator= (const SpectrumAnalyzer&) = delete;
+
+    // Paused, the worker sleeps and the feed's writer stops writing
+    void setRunning (bool state);
+
+    // How often the worker analyzes and publishes
+    void setInterval (double seconds);
+
+    const SpectrumFrame& read () { return frames.read (); }
+
+private:
+    struct Band
+    {
+        int32_t lo;                 // bins lo .. hi; hi < lo: interpolate at lo + frac
+        int32_t hi;
+        float frac;
+    };
+
+    void workerMain ();
+    bool analyze ();
+    void configure (double feedRate);
+    void publish ();
+
+    std::shared_ptr<SpectrumFeed> feed;
+    const int32_t fftSize;
+    const int32_t numPoints;
+
+    // Worker state
+    RealFft fft;
+    std::vector<float> window;
+    std::vector<float> frame;
+    std::vector<Fft::Complex> spectrum;
+    std::vector<float> power;       // smoothed, per bin, full scale sine = 1
+    std::vector<Band> bands;
+    double feedRate = 0.0;
+    float powerScale = 1.f;         // |X|^2 to power
+    uint32_t nextFrameEnd = 0;
+    uint32_t sequence = 0;
+    SpectrumFrame layout;           // x and frequency range for the current feed rate
+
+    TripleBuffer<SpectrumFrame> frames;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool running = false;           // guarded by mutex
+    bool restart = false;
+    bool stopping = false;
+    std::atomic<int32_t> intervalMicros {33000};
+};
+
+} // namespace WineSynth
@@ -0,0 +1,178 @@
+#include "trace.h"
+
+#if WINESYNTH_TRACE
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace WineSynth {
+namespace Trace {
+
+std::atomic<bool> running {false};
+
+namespace {
+
+struct Event
+{
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Single producer (the owning thread), single consumer (the flusher)
+struct Ring
+{
+    Event events[kRingSize];
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+    std::atomic<uint32_t> dropped {0};
+};
+
+static_assert ((kRingSize & (kRingSize - 1)) == 0, "kRingSize must be a power of two");
+
+// Rings are claimed once per thread and kept for the life of the module, so
+// record () never allocates
+Ring rings[kMaxThreads];
+std::atomic<int> numClaimed {0};
+thread_local Ring* threadRing = nullptr;
+thread_local bool threadUnclaimed = true;
+
+// Session state (acquire / release and the flusher only)
+std::mutex sessionMutex;
+int refCount = 0;
+FILE* file = nullptr;
+uint64_t epoch = 0;
+bool firstEvent = true;
+
+std::thread flusher;
+std::mutex flusherMutex;
+std::condition_variable flusherWake;
+bool stopRequested = false;
+
+Ring* claimRing ()
+{
+    threadUnclaimed = false;
+    int index = numClaimed.fetch_add (1, std::memory_order_relaxed);
+    threadRing = index < kMaxThreads ? &rings[index] : nullptr;
+    return threadRing;
+}
+
+void drain ()
+{
+    const int count = std::min (numClaimed.load (std::memory_order_acquire), kMaxThreads);
+    for (int i = 0; i < count; i++)
+    {
+        Ring& ring = rings[i];
+        uint32_t tail = ring.tail.load (std::memory_order_relaxed);
+        const uint32_t head = ring.head.load (std::memory_order_acquire);
+        for (; tail != head; tail++)
+        {
+            const Event& e = ring.events[tail & (kRingSize - 1)];
+            if (e.start < epoch)
+                continue;   // left over from an earlier session
+            fprintf (file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     firstEvent ? "" : ",\n", e.name, i + 1,
+                     (e.start - epoch) * 0.001, (e.end - e.start) * 0.001);
+            firstEvent = false;
+        }
+        ring.tail.store (tail, std::memory_order_release);
+    }
+    fflush (file);
+}
+
+void flusherMain ()
+{
+    std::unique_lock<std::mutex> lock (flusherMutex);
+    while (!stopRequested)
+    {
+        flusherWake.wait_for (lock, std::chrono::milliseconds (100), [] { return stopRequested; });
+        lock.unlock ();
+        drain ();
+        lock.lock ();
+    }
+}
+
+} // namespace
+
+uint64_t now ()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now ().time_since_epoch ())
+        .count ();
+}
+
+void record (const char* name, uint64_t start, uint64_t end)
+{
+    Ring* ring = threadRing;
+    if (!ring)
+    {
+        if (!threadUnclaimed)
+            return;     // pool exhausted
+        ring = claimRing ();
+        if (!ring)
+            return;
+    }
+
+    const uint32_t head = ring->head.load (std::memory_order_relaxed);
+    if (head - ring->tail.load (std::memory_order_acquire) >= (uint32_t)kRingSize)
+    {
+        ring->dropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+    ring->events[head & (kRingSize - 1)] = {name, start, end};
+    ring->head.store (head + 1, std::memory_order_release);
+}
+
+void acquire ()
+{
+    std::lock_guard<std::mutex> lock (sessionMutex);
+    if (refCount++ > 0)
+        return;
+
+    const char* path = getenv ("WINESYNTH_TRACE_FILE");
+    if (!path || !*path)
+        return;
+    file = fopen (path, "w");
+    if (!file)
+        return;
+
+    fputs ("{\"traceEvents\":[\n", file);
+    firstEvent = true;
+    epoch = now ();
+    stopRequested = false;
+    flusher = std::thread (flusherMain);
+    running.store (true, std::memory_order_release);
+}
+
+void release ()
+{
+    std::lock_guard<std::mutex> lock (sessionMutex);
+    if (refCount == 0 || --refCount > 0 || !file)
+        return;
+
+    running.store (false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> wakeLock (flusherMutex);
+        stopRequested = true;
+    }
+    flusherWake.notify_one ();
+    flusher.join ();
+    drain ();
+
+    uint32_t dropped = 0;
+    for (auto& ring : rings)
+        dropped += ring.dropped.exchange (0, std::memory_order_relaxed);
+    fprintf (file, "\n],\"otherData\":{\"droppedEvents\":\"%u\"}}\n", dropped);
+    fclose (file);
+    file = nullptr;
+}
+
+} // namespace Trace
+} // namespace WineSynth
+
+#endif // WINESYNTH_TRACE
@@ -0,0 +1,89 @@
+#pragma once
+
+//------------------------------------------------------------------------
+// Timeline tracing (configure with -DWINESYNTH_TRACE=ON)
+//
+// WINESYNTH_TRACE_SCOPE ("name") records the rest of the enclosing block as
+// one complete event. Each thread writes into its own lock-free ring; a
+// background thread drains the rings every 100 ms and appends Chrome trace
+// JSON (chrome://tracing, ui.perfetto.dev) to the file named by the
+// WINESYNTH_TRACE_FILE environment variable. Without that variable nothing
+// is recorded.
+//
+// Names must be string literals (only the pointer is stored). Events are
+// dropped, not blocked on, when a ring is full or more than kMaxThreads
+// threads trace.
+//
+// Cost: compiled out, the macros expand to nothing; compiled in but not
+// running, a scope is one relaxed load and a branch.
+//------------------------------------------------------------------------
+
+#if WINESYNTH_TRACE
+
+#include <atomic>
+#include <cstdint>
+
+namespace WineSynth {
+namespace Trace {
+
+constexpr int kMaxThreads = 16;
+constexpr int kRingSize = 4096;         // events per thread, power of two
+
+extern std::atomic<bool> running;
+
+uint64_t now ();                        // nanoseconds, steady clock
+void record (const char* name, uint64_t start, uint64_t end);
+
+// Session lifetime, reference counted: the first acquire () starts the
+// flusher (if WINESYNTH_TRACE_FILE is set), the last release () drains the
+// rings and closes the file. Call from initialize () / terminate (), never
+// from the audio thread.
+void acquire ();
+void release ();
+
+class Scope
+{
+public:
+    explicit Scope (const char* name)
+        : name (name)
+        , start (running.load (std::memory_order_relaxed) ? now () : 0)
+    {
+    }
+
+    ~Scope ()
+    {
+        if (start)
+            record (name, start, now ());
+    }
+
+    Scope (const Scope&) = delete;
+    Scope& operator= (const Scope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+} // namespace Trace
+} // namespace WineSynth
+
+#define WINESYNTH_TRACE_CONCAT2(a, b) a##b
+#define WINESYNTH_TRACE_CONCAT(a, b) WINESYNTH_TRACE_CONCAT2 (a, b)
+#define WINESYNTH_TRACE_SCOPE(name) \
+    WineSynth::Trace::Scope WINESYNTH_TRACE_CONCAT (traceScope, __LINE__) (name)
+#define WINESYNTH_TRACE_ACQUIRE() WineSynth::Trace::acquire ()
+#define WINESYNTH_TRACE_RELEASE() WineSynth::Trace::release ()
+
+#else
+
+#define WINESYNTH_TRACE_SCOPE(name)
+#define WINESYNTH_TRACE_ACQUIRE() \
+    do                            \
+    {                             \
+    } while (0)
+#define WINESYNTH_TRACE_RELEASE() \
+    do                            \
+    {                             \
+    } while (0)
+
+#endif
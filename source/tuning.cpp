@@ -0,0 +1,200 @@
+#include "tuning.h"
+
+#include <cstdlib>
+#include <sstream>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+namespace {
+
+// Next line that is not a '!' comment; trailing CR removed
+bool nextLine (std::istringstream& in, std::string& line)
+{
+    while (std::getline (in, line))
+    {
+        if (!line.empty () && line.back () == '\r')
+            line.pop_back ();
+        if (!line.empty () && line[0] == '!')
+            continue;
+        return true;
+    }
+    return false;
+}
+
+std::string firstToken (const std::string& line)
+{
+    std::istringstream in (line);
+    std::string token;
+    in >> token;
+    return token;
+}
+
+bool parseInt (const std::string& line, int32_t& value)
+{
+    std::string token = firstToken (line);
+    if (token.empty ())
+        return false;
+    char* end = nullptr;
+    long v = strtol (token.c_str (), &end, 10);
+    if (*end != '\0')
+        return false;
+    value = (int32_t)v;
+    return true;
+}
+
+// Scala pitch: "701.955" (cents, has a period), "3/2" or "2" (ratio)
+bool parsePitch (const std::string& line, double& cents)
+{
+    std::string token = firstToken (line);
+    if (token.empty ())
+        return false;
+
+    char* end = nullptr;
+    if (token.find ('.') != std::string::npos)
+    {
+        cents = strtod (token.c_str (), &end);
+        return *end == '\0';
+    }
+
+    double num = (double)strtol (token.c_str (), &end, 10);
+    double den = 1.0;
+    if (*end == '/')
+        den = (double)strtol (end + 1, &end, 10);
+    if (*end != '\0' || num <= 0.0 || den <= 0.0)
+        return false;
+    cents = 1200.0 * log2 (num / den);
+    return true;
+}
+
+int32_t floorDiv (int32_t a, int32_t b)
+{
+    int32_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+} // namespace
+
+ScalaScale ScalaScale::equalTemperament ()
+{
+    ScalaScale scale;
+    for (int32_t i = 1; i <= 12; i++)
+        scale.cents.push_back (100.0 * i);
+    return scale;
+}
+
+namespace Tuning {
+
+bool parseScale (const std::string& text, ScalaScale& scale)
+{
+    std::istringstream in (text);
+    std::string line;
+
+    if (!nextLine (in, line))   // description
+        return false;
+
+    int32_t count = 0;
+    if (!nextLine (in, line) || !parseInt (line, count) || count <= 0 || count > 1024)
+        return false;
+
+    ScalaScale result;
+    for (int32_t i = 0; i < count; i++)
+    {
+        double cents;
+        if (!nextLine (in, line) || !parsePitch (line, cents))
+            return false;
+        result.cents.push_back (cents);
+    }
+    if (result.cents.back () <= 0.0)
+        return false;
+
+    scale = std::move (result);
+    return true;
+}
+
+bool parseKeyboardMapping (const std::string& text, KeyboardMapping& kbm)
+{
+    std::istringstream in (text);
+    std::string line;
+    KeyboardMapping result;
+
+    int32_t* fields[] = {&result.mapSize, &result.firstNote, &result.lastNote,
+                         &result.middleNote, &result.referenceNote};
+    for (int32_t* field : fields)
+    {
+        if (!nextLine (in, line) || !parseInt (line, *field))
+            return false;
+    }
+
+    if (!nextLine (in, line))
+        return false;
+    result.referenceFrequency = strtod (firstToken (line).c_str (), nullptr);
+    if (!nextLine (in, line) || !parseInt (line, result.octaveDegree))
+        return false;
+
+    if (result.mapSize < 0 || result.mapSize > TuningTable::kNumKeys ||
+        result.referenceFrequency <= 0.0)
+        return false;
+
+    for (int32_t i = 0; i < result.mapSize; i++)
+    {
+        int32_t degree = -1;
+        // Missing trailing entries and 'x' are unmapped
+        if (nextLine (in, line) && firstToken (line) != "x" && !parseInt (line, degree))
+            return false;
+        result.mapping.push_back (degree);
+    }
+
+    kbm = std::move (result);
+    return true;
+}
+
+void buildTable (TuningTable& table, const ScalaScale& scale, const KeyboardMapping& kbm,
+                 double sampleRate)
+{
+    const int32_t scaleSize = (int32_t)scale.cents.size ();
+    const double period = scale.cents.back ();
+    const int32_t octaveDegree = kbm.octaveDegree > 0 ? kbm.octaveDegree : scaleSize;
+
+    // Cents of a key relative to the middle note; false if unmapped
+    auto keyCents = [&] (int32_t key, double& cents) {
+        if (key < kbm.firstNote || key > kbm.lastNote)
+            return false;
+
+        int32_t offset = key - kbm.middleNote;
+        int32_t degree = offset;
+        if (kbm.mapSize > 0)
+        {
+            int32_t mapOctave = floorDiv (offset, kbm.mapSize);
+            int32_t slot = offset - mapOctave * kbm.mapSize;
+            if (kbm.mapping[slot] < 0)
+                return false;
+            degree = kbm.mapping[slot] + mapOctave * octaveDegree;
+        }
+
+        int32_t periods = floorDiv (degree, scaleSize);
+        int32_t step = degree - periods * scaleSize;
+        cents = periods * period + (step > 0 ? scale.cents[step - 1] : 0.0);
+        return true;
+    };
+
+    double referenceCents = 0.0;
+    bool hasReference = keyCents (kbm.referenceNote, referenceCents);
+
+    for (int32_t key = 0; key < TuningTable::kNumKeys; key++)
+    {
+        double cents;
+        if (hasReference && keyCents (key, cents))
+            table.frequency[key] = kbm.referenceFrequency * pow (2.0, (cents - referenceCents) / 1200.0);
+        else
+            table.frequency[key] = 0.0;
+        table.phaseInc[key] = 2.0 * M_PI * table.frequency[key] / sampleRate;
+    }
+}
+
+} // namespace Tuning
+
+} // namespace WineSynth
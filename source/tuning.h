@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// TuningTable — per-key frequency and oscillator phase increment
+// (radians per sample) at one sample rate. Built off the audio thread and
+// handed to the processor through a TripleBuffer. A frequency of 0 marks a
+// key that the keyboard mapping leaves unmapped.
+//------------------------------------------------------------------------
+struct TuningTable
+{
+    static constexpr int32_t kNumKeys = 128;
+
+    double frequency[kNumKeys] {};
+    double phaseInc[kNumKeys] {};
+
+    bool isMapped (int32_t key) const { return key >= 0 && key < kNumKeys && frequency[key] > 0.0; }
+};
+
+//------------------------------------------------------------------------
+// PitchRatio — cents → frequency ratio without transcendental calls.
+// ratio = semitone[floor (cents / 100)] * interpolated cent[remainder]
+//------------------------------------------------------------------------
+class PitchRatio
+{
+public:
+    static constexpr int32_t kMaxSemitones = 48;
+
+    PitchRatio ()
+    {
+        for (int32_t i = 0; i < kNumSemitones; i++)
+            semitone[i] = pow (2.0, (double)(i - kMaxSemitones) / 12.0);
+        for (int32_t i = 0; i <= 100; i++)
+            cent[i] = pow (2.0, (double)i / 1200.0);
+    }
+
+    double fromCents (double cents) const
+    {
+        double semis = floor (cents * 0.01);
+        double rest = cents - semis * 100.0;          // 0..100
+        int32_t s = (int32_t)semis + kMaxSemitones;
+        if (s < 0)
+        {
+            s = 0;
+            rest = 0.0;
+        }
+        else if (s >= kNumSemitones)
+        {
+            s = kNumSemitones - 1;
+            rest = 0.0;
+        }
+        int32_t c = (int32_t)rest;
+        if (c > 99)
+            c = 99;
+        double frac = rest - c;
+        return semitone[s] * (cent[c] + (cent[c + 1] - cent[c]) * frac);
+    }
+
+private:
+    static constexpr int32_t kNumSemitones = 2 * kMaxSemitones + 1;
+
+    double semitone[kNumSemitones];
+    double cent[101];
+};
+
+//------------------------------------------------------------------------
+// Scala scale (.scl) and keyboard mapping (.kbm) support
+// See https://www.huygens-fokker.org/scala/scl_format.html
+//------------------------------------------------------------------------
+struct ScalaScale
+{
+    // Degrees 1..N in cents; degree 0 (unison) is implicit, the last entry
+    // is the period (usually the octave).
+    std::vector<double> cents;
+
+    static ScalaScale equalTemperament ();
+};
+
+struct KeyboardMapping
+{
+    int32_t mapSize = 0;          // 0 = linear mapping
+    int32_t firstNote = 0;
+    int32_t lastNote = 127;
+    int32_t middleNote = 60;      // key that plays scale degree 0
+    int32_t referenceNote = 69;
+    double referenceFrequency = 440.0;
+    int32_t octaveDegree = 0;     // formal octave in scale degrees (0 = scale size)
+    std::vector<int32_t> mapping; // scale degree per map slot, -1 = unmapped
+};
+
+namespace Tuning {
+
+bool parseScale (const std::string& text, ScalaScale& scale);
+bool parseKeyboardMapping (const std::string& text, KeyboardMapping& kbm);
+
+// Fills table for the given scale / mapping at sampleRate
+void buildTable (TuningTable& table, const ScalaScale& scale, const KeyboardMapping& kbm,
+                 double sampleRate);
+
+} // namespace Tuning
+
+} // namespace WineSynth
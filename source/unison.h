@@ -0,0 +1,191 @@
+#pragma once
+
+#include "lanes.h"
+#include "pluginparamids.h"
+
+#include <cmath>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Unison oscillator stack
+//
+// Up to kMaxOscillators detuned copies of the voice waveform, spread across
+// the stereo field. Phases (in cycles, 0..1) are kept in lane arrays and
+// rendered kLanes oscillators at a time: the inner loop over one lane group
+// has a fixed trip count and no calls or branches, so it maps onto SIMD
+// registers (FloatLanes). Unused lanes of the last group run with zero
+// gain.
+//------------------------------------------------------------------------
+struct alignas (32) UnisonState
+{
+    static constexpr int32_t kMaxOscillators = 16;
+    static constexpr int32_t kLanes = FloatLanes::kSize;
+    static constexpr int32_t kMaxGroups = kMaxOscillators / kLanes;
+
+    float phase[kMaxOscillators] = {};
+
+    // Random start phases, so the stack does not begin phase-aligned
+    void randomize (uint32_t& seed)
+    {
+        for (auto& p : phase)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            p = (float)(seed >> 8) * (1.f / 16777216.f);
+        }
+    }
+};
+
+//------------------------------------------------------------------------
+// Per-oscillator detune ratios and pan gains, shared by all voices and
+// rebuilt when the unison parameters change
+//------------------------------------------------------------------------
+struct alignas (32) UnisonSetup
+{
+    // Lane arrays first, so every group starts on a 32-byte boundary
+    float ratio[UnisonState::kMaxOscillators] = {};
+    float gainL[UnisonState::kMaxOscillators] = {};
+    float gainR[UnisonState::kMaxOscillators] = {};
+    int32_t count = 1;
+    int32_t numGroups = 1;
+
+    // detuneCents is the distance between the outermost oscillators; pitch
+    // neighbours are panned to opposite sides, spread 0..1
+    static UnisonSetup make (int32_t count, double detuneCents, double spread)
+    {
+        UnisonSetup u;
+        u.count = count < 1 ? 1 : (count > UnisonState::kMaxOscillators ? UnisonState::kMaxOscillators : count);
+        u.numGroups = (u.count + UnisonState::kLanes - 1) / UnisonState::kLanes;
+
+        // Equal power, normalized so a centred oscillator has unity gain per side
+        const double norm = sqrt (2.0 / u.count);
+        for (int32_t k = 0; k < UnisonState::kMaxOscillators; k++)
+        {
+            if (k >= u.count)
+            {
+                u.ratio[k] = 1.f;
+                continue;
+            }
+            double x = u.count > 1 ? 2.0 * k / (u.count - 1) - 1.0 : 0.0;
+            int32_t slot = (k & 1) ? u.count - 1 - k / 2 : k / 2;
+            double pan = u.count > 1 ? spread * (2.0 * slot / (u.count - 1) - 1.0) : 0.0;
+            double angle = (pan + 1.0) * 0.25 * M_PI;
+
+            u.ratio[k] = (float)pow (2.0, 0.5 * x * detuneCents / 1200.0);
+            u.gainL[k] = (float)(cos (angle) * norm);
+            u.gainR[k] = (float)(sin (angle) * norm);
+        }
+        return u;
+    }
+};
+
+//------------------------------------------------------------------------
+// Branch-free waveform kernels on kLanes phases in cycles (0..1), matching
+// Processor::generateSample
+//------------------------------------------------------------------------
+struct UnisonSaw
+{
+    static FloatLanes value (FloatLanes p) { return FloatLanes::set1 (2.f) * p - FloatLanes::set1 (1.f); }
+};
+
+struct UnisonSquare
+{
+    static FloatLanes value (FloatLanes p)
+    {
+        return FloatLanes::select (p < FloatLanes::set1 (0.5f), FloatLanes::set1 (1.f), FloatLanes::set1 (-1.f));
+    }
+};
+
+struct UnisonTriangle
+{
+    static FloatLanes value (FloatLanes p)
+    {
+        return FloatLanes::set1 (4.f) * FloatLanes::abs (p - FloatLanes::set1 (0.5f)) - FloatLanes::set1 (1.f);
+    }
+};
+
+struct UnisonSine
+{
+    // sin (2 pi p) = -sin (2 pi x), x = p - 1/2, folded into [-1/4, 1/4];
+    // odd polynomial to z^9, error < 4e-6
+    static FloatLanes value (FloatLanes p)
+    {
+        using L = FloatLanes;
+        L x = p - L::set1 (0.5f);
+        L fold = L::copySign (L::set1 (0.5f), x) - x;
+        x = L::select (L::set1 (0.25f) < L::abs (x), fold, x);
+        L z = L::set1 (-2.f * (float)M_PI) * x;
+        L z2 = z * z;
+        L poly = L::set1 (1.f / 362880.f);
+        poly = poly * z2 + L::set1 (-1.f / 5040.f);
+        poly = poly * z2 + L::set1 (1.f / 120.f);
+        poly = poly * z2 + L::set1 (-1.f / 6.f);
+        poly = poly * z2 + L::set1 (1.f);
+        return z * poly;
+    }
+};
+
+// Calls fn with the kernel type for the waveform
+template <typename Fn>
+inline void dispatchUnisonWave (int32_t waveform, Fn&& fn)
+{
+    switch (waveform)
+    {
+        case kWaveSaw: fn (UnisonSaw ()); break;
+        case kWaveSquare: fn (UnisonSquare ()); break;
+        case kWaveTriangle: fn (UnisonTriangle ()); break;
+        default: fn (UnisonSine ()); break;
+    }
+}
+
+//------------------------------------------------------------------------
+// Renders numSamples of the summed stack into outL / outR (overwritten).
+// baseInc is the voice's phase increment in cycles per sample (< 1 / max
+// ratio). Phases, increments and gains stay in registers for the whole
+// call; the only per-sample reduction is the sum over lanes.
+//------------------------------------------------------------------------
+template <typename Wave>
+inline void renderUnison (UnisonState& state, const UnisonSetup& setup, float baseInc,
+                          float* outL, float* outR, int32_t numSamples)
+{
+    using L = FloatLanes;
+    constexpr int32_t kLanes = UnisonState::kLanes;
+
+    for (int32_t s = 0; s < numSamples; s++)
+    {
+        outL[s] = 0.f;
+        outR[s] = 0.f;
+    }
+
+    const L one = L::set1 (1.f);
+    for (int32_t g = 0; g < setup.numGroups; g++)
+    {
+        const int32_t first = g * kLanes;
+        L phase = L::load (state.phase + first);
+        const L inc = L::load (setup.ratio + first) * L::set1 (baseInc);
+        const L wrapAt = one - inc;
+        const L gainL = L::load (setup.gainL + first);
+        const L gainR = L::load (setup.gainR + first);
+
+        for (int32_t s = 0; s < numSamples; s++)
+        {
+            L v = Wave::value (phase);
+            float l, r;
+            L::sum2 (v * gainL, v * gainR, l, r);
+            outL[s] += l;
+            outR[s] += r;
+
+            // Wrap test on the current phase, off the add's critical path
+            phase = phase + inc - ((wrapAt <= phase) & one);
+        }
+
+        phase.store (state.phase + first);
+    }
+}
+
+} // namespace WineSynth
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "additive.h"
+#include "envelope.h"
+#include "filter.h"
+#include "oscpair.h"
+#include "oversampling.h"
+#include "shaper.h"
+#include "unison.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Voice — per-note DSP state
+//------------------------------------------------------------------------
+struct alignas (32) Voice
+{
+    // Oscillator
+    double phase = 0.0;
+    double phaseInc = 0.0;         // radians per sample before fine tune / bend
+    OscPairState osc;              // while oscillator 2 is in use
+    AdditiveState additive;        // kOscModeAdditive
+
+    FilterState filter;
+    AdaaState driveIn;             // shaper before the filter
+    AdaaState driveOut;            // shaper after the filter (bounds resonance peaks)
+
+    DecimatorState decimator;      // offline quality only (oversampled voices)
+
+    // Unison stack (more than one oscillator): rendered in stereo, the
+    // states above carry the left channel
+    UnisonState unison;
+    FilterState filterR;
+    AdaaState driveInR;
+    AdaaState driveOutR;
+    DecimatorState decimatorR;
+
+    EnvelopeState env;
+    int16_t pitch = -1;
+
+    // Declick fade after a steal: the voice ramps to zero over fadeLeft
+    // samples, then restarts with pendingPitch (or ends if it is -1).
+    int16_t pendingPitch = -1;
+    int32_t fadeLeft = 0;
+    float fadeGain = 1.f;
+    float fadeStep = 0.f;
+
+    bool isFading () const { return fadeLeft > 0; }
+    bool isEnding () const { return fadeLeft > 0 && pendingPitch < 0; }   // fading out for good
+};
+
+//------------------------------------------------------------------------
+// VoiceManager — O(1) voice allocation and stealing
+//
+// All bookkeeping is index based with no scans over the voice pool:
+//  - a free stack of unused voices
+//  - an age list of active voices (oldest at the head)
+//  - one list per MIDI pitch (same-note lookup, note-off)
+//  - level buckets (one per octave of envelope level) for quietest-voice
+//    stealing; a voice's bucket is refreshed by updateLevel () after each
+//    render, where the voice is touched anyway.
+//------------------------------------------------------------------------
+class VoiceManager
+{
+public:
+    static constexpr int32_t kMaxVoices = 64;
+    static constexpr int32_t kNumPitches = 128;
+    static constexpr int32_t kNumLevelBuckets = 8;   // ~6 dB each, bucket 0 = silent
+    static constexpr int32_t kLoudestBucket = kNumLevelBuckets - 1;
+
+    enum StealPolicy
+    {
+        kStealOldest = 0,
+        kStealQuietest,
+        kStealSameNote,
+        kNumStealPolicies
+    };
+
+    enum AllocResult
+    {
+        kFresh,        // unused voice, start immediately
+        kRetrigger,    // same pitch already sounding, retrigger in place
+        kStolen        // voice taken from another note, fade out first
+    };
+
+    struct Allocation
+    {
+        int32_t index;
+        AllocResult result;
+    };
+
+    VoiceManager () { reset (); }
+
+    void reset ()
+    {
+        for (int32_t i = 0; i < kMaxVoices; i++)
+        {
+            voices[i] = Voice ();
+            freeStack[i] = kMaxVoices - 1 - i;
+            active[i] = false;
+            bucketOf[i] = 0;
+            ageLinks[i] = pitchLinks[i] = bucketLinks[i] = Link ();
+        }
+        numFree = kMaxVoices;
+        numActive = 0;
+        ageList = ListHead ();
+        for (auto& h : pitchLists)
+            h = ListHead ();
+        for (auto& h : bucketLists)
+            h = ListHead ();
+    }
+
+    void setPolyphony (int32_t n) { polyphony = n < 1 ? 1 : (n > kMaxVoices ? kMaxVoices : n); }
+    void setStealPolicy (int32_t p) { policy = (p >= 0 && p < kNumStealPolicies) ? (StealPolicy)p : kStealOldest; }
+
+    int32_t getNumActive () const { return numActive; }
+    Voice& getVoice (int32_t index) { return voices[index]; }
+
+    // Iteration over active voices, oldest first (-1 terminates)
+    int32_t oldest () const { return ageList.head; }
+    int32_t next (int32_t index) const { return ageLinks[index].next; }
+
+    // Iteration over voices assigned to a pitch
+    int32_t firstOnPitch (int16_t pitch) const { return pitchLists[pitch & 0x7F].head; }
+    int32_t nextOnPitch (int32_t index) const { return pitchLinks[index].next; }
+
+    Allocation allocate (int16_t pitch)
+    {
+        pitch &= 0x7F;
+
+        if (policy == kStealSameNote && pitchLists[pitch].head >= 0)
+        {
+            int32_t index = pitchLists[pitch].head;
+            touch (index);
+            return {index, kRetrigger};
+        }
+
+        if (numActive < polyphony && numFree > 0)
+        {
+            int32_t index = freeStack[--numFree];
+            active[index] = true;
+            numActive++;
+            append (ageList, ageLinks, index);
+            append (pitchLists[pitch], pitchLinks, index);
+            bucketOf[index] = kLoudestBucket;
+            append (bucketLists[kLoudestBucket], bucketLinks, index);
+            voices[index].pitch = pitch;
+            return {index, kFresh};
+        }
+
+        int32_t victim = (policy == kStealQuietest) ? quietest () : ageList.head;
+        unlink (pitchLists[voices[victim].pitch], pitchLinks, victim);
+        append (pitchLists[pitch], pitchLinks, victim);
+        voices[victim].pitch = pitch;
+        touch (victim);
+        updateLevel (victim, 1.f);   // new note is about to start, not a steal candidate
+        return {victim, kStolen};
+    }
+
+    // Returns a finished voice to the free pool
+    void freeVoice (int32_t index)
+    {
+        if (!active[index])
+            return;
+        unlink (ageList, ageLinks, index);
+        unlink (pitchLists[voices[index].pitch], pitchLinks, index);
+        unlink (bucketLists[bucketOf[index]], bucketLinks, index);
+        active[index] = false;
+        voices[index].pitch = -1;
+        numActive--;
+        freeStack[numFree++] = index;
+    }
+
+    // Quietest voice that is not ending, by level bucket (-1 if none).
+    // Costs one step per bucket plus one per ending voice passed over.
+    int32_t quietestSounding () const
+    {
+        for (int32_t b = 0; b < kNumLevelBuckets; b++)
+            for (int32_t i = bucketLists[b].head; i >= 0; i = bucketLinks[i].next)
+                if (!voices[i].isEnding ())
+                    return i;
+        return -1;
+    }
+
+    // Moves the voice to the level bucket matching its current envelope level
+    void updateLevel (int32_t index, float level)
+    {
+        int32_t bucket = levelBucket (level);
+        if (bucket != bucketOf[index])
+        {
+            unlink (bucketLists[bucketOf[index]], bucketLinks, index);
+            append (bucketLists[bucket], bucketLinks, index);
+            bucketOf[index] = bucket;
+        }
+    }
+
+private:
+    struct Link
+    {
+        int32_t prev = -1;
+        int32_t next = -1;
+    };
+
+    struct ListHead
+    {
+        int32_t head = -1;
+        int32_t tail = -1;
+    };
+
+    static void append (ListHead& list, Link* links, int32_t index)
+    {
+        links[index].prev = list.tail;
+        links[index].next = -1;
+        if (list.tail >= 0)
+            links[list.tail].next = index;
+        else
+            list.head = index;
+        list.tail = index;
+    }
+
+    static void unlink (ListHead& list, Link* links, int32_t index)
+    {
+        Link& l = links[index];
+        if (l.prev >= 0)
+            links[l.prev].next = l.next;
+        else
+            list.head = l.next;
+        if (l.next >= 0)
+            links[l.next].prev = l.prev;
+        else
+            list.tail = l.prev;
+        l = Link ();
+    }
+
+    // Marks a voice as the newest
+    void touch (int32_t index)
+    {
+        unlink (ageList, ageLinks, index);
+        append (ageList, ageLinks, index);
+    }
+
+    int32_t quietest () const
+    {
+        for (int32_t b = 0; b < kNumLevelBuckets; b++)
+            if (bucketLists[b].head >= 0)
+                return bucketLists[b].head;
+        return ageList.head;
+    }
+
+    static int32_t levelBucket (float level)
+    {
+        if (level <= 0.f)
+            return 0;
+        int exponent;
+        frexpf (level, &exponent);   // level = m * 2^exponent, exponent <= 1 for level <= 1
+        int32_t bucket = exponent + kNumLevelBuckets - 2;
+        return bucket < 1 ? 1 : (bucket >= kNumLevelBuckets ? kNumLevelBuckets - 1 : bucket);
+    }
+
+    Voice voices[kMaxVoices];
+
+    int32_t freeStack[kMaxVoices];
+    int32_t numFree = 0;
+    int32_t numActive = 0;
+    bool active[kMaxVoices];
+
+    ListHead ageList;
+    ListHead pitchLists[kNumPitches];
+    ListHead bucketLists[kNumLevelBuckets];
+    Link ageLinks[kMaxVoices];
+    Link pitchLinks[kMaxVoices];
+    Link bucketLinks[kMaxVoices];
+    int32_t bucketOf[kMaxVoices];
+
+    int32_t polyphony = kMaxVoices;
+    StealPolicy policy = kStealOldest;
+};
+
+} // namespace WineSynth
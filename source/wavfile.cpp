@@ -0,0 +1,114 @@
+#include "wavfile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace WineSynth {
+
+namespace {
+
+enum
+{
+    kFormatPcm = 1,
+    kFormatFloat = 3,
+    kFormatExtensible = 0xFFFE
+};
+
+uint32_t readLE (const uint8_t* p, int32_t bytes)
+{
+    uint32_t v = 0;
+    for (int32_t i = bytes - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+float decodeSample (const uint8_t* p, int32_t format, int32_t bits)
+{
+    if (format == kFormatFloat)
+    {
+        uint32_t raw = readLE (p, 4);
+        float f;
+        memcpy (&f, &raw, sizeof (f));
+        return f;
+    }
+
+    switch (bits)
+    {
+        case 16: return (float)(int16_t)readLE (p, 2) / 32768.f;
+        case 24: return (float)((int32_t)(readLE (p, 3) << 8) >> 8) / 8388608.f;
+        case 32: return (float)((double)(int32_t)readLE (p, 4) / 2147483648.0);
+        default: return 0.f;
+    }
+}
+
+} // namespace
+
+namespace WavFile {
+
+bool read (const std::string& path, AudioFile& file, int32_t maxChannels, int32_t maxFrames)
+{
+    std::ifstream in (path, std::ios::binary);
+    if (!in)
+        return false;
+    std::vector<uint8_t> bytes ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+
+    if (bytes.size () < 12 || memcmp (bytes.data (), "RIFF", 4) != 0 || memcmp (bytes.data () + 8, "WAVE", 4) != 0)
+        return false;
+
+    int32_t format = 0, numChannels = 0, bits = 0;
+    double rate = 0.0;
+    const uint8_t* data = nullptr;
+    size_t dataSize = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size ())
+    {
+        const uint8_t* chunk = bytes.data () + pos;
+        size_t size = readLE (chunk + 4, 4);
+        size_t available = std::min (size, bytes.size () - pos - 8);
+
+        if (memcmp (chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            format = (int32_t)readLE (chunk + 8, 2);
+            numChannels = (int32_t)readLE (chunk + 10, 2);
+            rate = (double)readLE (chunk + 12, 4);
+            bits = (int32_t)readLE (chunk + 22, 2);
+            if (format == kFormatExtensible && available >= 26)
+                format = (int32_t)readLE (chunk + 32, 2);   // first field of the sub-format GUID
+        }
+        else if (memcmp (chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            dataSize = available;
+        }
+        pos += 8 + size + (size & 1);   // chunks are word aligned
+    }
+
+    if (!data || numChannels <= 0 || rate <= 0.0)
+        return false;
+    if (!((format == kFormatPcm && (bits == 16 || bits == 24 || bits == 32)) ||
+          (format == kFormatFloat && bits == 32)))
+        return false;
+
+    const int32_t frameBytes = numChannels * bits / 8;
+    const int32_t numFrames = std::min<int32_t> (maxFrames, (int32_t)(dataSize / frameBytes));
+    const int32_t channels = std::min (numChannels, maxChannels);
+
+    AudioFile result;
+    result.sampleRate = rate;
+    result.channels.assign (channels, std::vector<float> (numFrames));
+    for (int32_t f = 0; f < numFrames; f++)
+    {
+        for (int32_t ch = 0; ch < channels; ch++)
+            result.channels[ch][f] = decodeSample (data + (size_t)f * frameBytes + ch * bits / 8, format, bits);
+    }
+
+    file = std::move (result);
+    return numFrames > 0;
+}
+
+} // namespace WavFile
+
+} // namespace WineSynth
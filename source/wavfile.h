@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// Minimal WAV reader for impulse responses: PCM 16/24/32 bit and 32-bit
+// float, including WAVE_FORMAT_EXTENSIBLE. Not realtime safe.
+//------------------------------------------------------------------------
+struct AudioFile
+{
+    double sampleRate = 0.0;
+    std::vector<std::vector<float>> channels;
+
+    int32_t getNumFrames () const { return channels.empty () ? 0 : (int32_t)channels[0].size (); }
+};
+
+namespace WavFile {
+
+// Reads at most maxChannels channels and maxFrames frames
+bool read (const std::string& path, AudioFile& file, int32_t maxChannels, int32_t maxFrames);
+
+} // namespace WavFile
+
+} // namespace WineSynth
@@ -0,0 +1,318 @@
+#include "workerpool.h"
+#include "rtcheck.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define WINESYNTH_HAS_MXCSR 1
+#endif
+
+namespace WineSynth {
+
+namespace {
+
+// Spin iterations before an idle helper goes to sleep (tens of microseconds)
+constexpr int32_t kSpinCount = 4096;
+
+// Pause iterations of the join before it starts yielding (a helper holding
+// the last task may share the core with us)
+constexpr int32_t kJoinSpinCount = 256;
+
+inline void cpuPause ()
+{
+#if WINESYNTH_HAS_MXCSR
+    _mm_pause ();
+#endif
+}
+
+inline uint32_t getFpMode ()
+{
+#if WINESYNTH_HAS_MXCSR
+    return _mm_getcsr ();
+#else
+    return 0;
+#endif
+}
+
+inline void setFpMode (uint32_t mode)
+{
+#if WINESYNTH_HAS_MXCSR
+    _mm_setcsr (mode);
+#else
+    (void)mode;
+#endif
+}
+
+// Scheduling of the calling thread, packed as policy << 32 | priority
+// (policy 0 on Windows, where only the priority is relative to the class)
+#if defined(_WIN32)
+inline int64_t getThreadScheduling ()
+{
+    return (int64_t)(uint32_t)GetThreadPriority (GetCurrentThread ());
+}
+
+inline bool setThreadScheduling (int64_t scheduling)
+{
+    return SetThreadPriority (GetCurrentThread (), (int)(int32_t)(uint32_t)scheduling) != 0;
+}
+
+inline bool isRealtimeScheduling (int64_t scheduling)
+{
+    return (int32_t)(uint32_t)scheduling >= THREAD_PRIORITY_TIME_CRITICAL;
+}
+#else
+inline int64_t getThreadScheduling ()
+{
+    int policy = SCHED_OTHER;
+    sched_param param {};
+    pthread_getschedparam (pthread_self (), &policy, &param);
+    return (int64_t)policy << 32 | (uint32_t)param.sched_priority;
+}
+
+inline bool setThreadScheduling (int64_t scheduling)
+{
+    sched_param param {};
+    param.sched_priority = (int32_t)(uint32_t)scheduling;
+    return pthread_setschedparam (pthread_self (), (int)(scheduling >> 32), &param) == 0;
+}
+
+inline bool isRealtimeScheduling (int64_t scheduling)
+{
+    const int policy = (int)(scheduling >> 32);
+    return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+#endif
+
+} // namespace
+
+//------------------------------------------------------------------------
+// Semaphore — posted from the audio thread: ReleaseSemaphore / sem_post
+// never block and do not take a user-space lock
+//------------------------------------------------------------------------
+#if defined(_WIN32)
+WorkerPool::Semaphore::Semaphore () { handle = CreateSemaphoreW (nullptr, 0, kMaxWorkers, nullptr); }
+WorkerPool::Semaphore::~Semaphore () { CloseHandle ((HANDLE)handle); }
+void WorkerPool::Semaphore::post (int32_t count) { ReleaseSemaphore ((HANDLE)handle, count, nullptr); }
+void WorkerPool::Semaphore::wait () { WaitForSingleObject ((HANDLE)handle, INFINITE); }
+void WorkerPool::Semaphore::drain ()
+{
+    while (WaitForSingleObject ((HANDLE)handle, 0) == WAIT_OBJECT_0)
+    {
+    }
+}
+#else
+WorkerPool::Semaphore::Semaphore ()
+{
+    sem_t* sem = new sem_t;
+    sem_init (sem, 0, 0);
+    handle = sem;
+}
+
+WorkerPool::Semaphore::~Semaphore ()
+{
+    sem_t* sem = static_cast<sem_t*> (handle);
+    sem_destroy (sem);
+    delete sem;
+}
+
+void WorkerPool::Semaphore::post (int32_t count)
+{
+    for (int32_t i = 0; i < count; i++)
+        sem_post (static_cast<sem_t*> (handle));
+}
+
+void WorkerPool::Semaphore::wait ()
+{
+    while (sem_wait (static_cast<sem_t*> (handle)) != 0 && errno == EINTR)
+    {
+    }
+}
+
+void WorkerPool::Semaphore::drain ()
+{
+    while (sem_trywait (static_cast<sem_t*> (handle)) == 0 || errno == EINTR)
+    {
+    }
+}
+#endif
+
+void WorkerPool::start (int32_t count)
+{
+    stop ();
+    numWorkers = std::max<int32_t> (1, std::min (count, kMaxWorkers));
+    stopping.store (false, std::memory_order_relaxed);
+    callerScheduling.store (kUnknownScheduling, std::memory_order_relaxed);
+    schedulingPublished = false;
+    for (int32_t w = 1; w < numWorkers; w++)
+        helpers[w] = std::thread ([this, w] () { helperMain (w); });
+}
+
+void WorkerPool::stop ()
+{
+    if (numWorkers <= 1)
+        return;
+    stopping.store (true, std::memory_order_seq_cst);
+    wakeup.post (numWorkers - 1);
+    for (int32_t w = 1; w < numWorkers; w++)
+        helpers[w].join ();
+
+    // Helpers that were spinning rather than asleep left their posts behind
+    wakeup.drain ();
+    sleeping.store (0, std::memory_order_relaxed);
+    numWorkers = 1;
+}
+
+void WorkerPool::runTasks (int32_t count, TaskFn fn, void* context)
+{
+    if (count <= 0)
+        return;
+    if (numWorkers <= 1)
+    {
+        for (int32_t task = 0; task < count; task++)
+            fn (context, task, 0);
+        return;
+    }
+
+    taskFn = fn;
+    taskContext = context;
+    fpMode = getFpMode ();
+    finished.store (0, std::memory_order_relaxed);
+    if (!schedulingPublished)
+    {
+        // Once per start (): the audio thread does not change its own class
+        callerScheduling.store (getThreadScheduling (), std::memory_order_relaxed);
+        schedulingPublished = true;
+    }
+
+    // One contiguous share per worker
+    for (int32_t w = numWorkers - 1; w >= 0; w--)
+    {
+        const uint32_t begin = (uint32_t)((int64_t)count * w / numWorkers);
+        const uint32_t end = (uint32_t)((int64_t)count * (w + 1) / numWorkers);
+        ranges[w].range.store (pack (begin, end), std::memory_order_release);
+    }
+    generation.fetch_add (1, std::memory_order_seq_cst);
+    if (const int32_t asleep = sleeping.exchange (0, std::memory_order_seq_cst))
+        wakeup.post (asleep);
+
+    work (0);
+
+    // Join: every task is claimed by now; wait for the ones still running
+    for (int32_t spin = 0; finished.load (std::memory_order_acquire) < count; spin++)
+    {
+        if (spin < kJoinSpinCount)
+            cpuPause ();
+        else
+        {
+            WINESYNTH_RT_BLOCKING ("std::this_thread::yield");
+            std::this_thread::yield ();
+        }
+    }
+}
+
+void WorkerPool::work (int32_t self)
+{
+    bool first = true;
+    int32_t task;
+    while (pop (self, task) || steal (self, task))
+    {
+        // The claim synchronized with run (), so the job fields are current.
+        // Helpers take over the caller's rounding and denormal flushing, so
+        // a task gives the same bits on any thread.
+        if (first && self != 0)
+            setFpMode (fpMode);
+        first = false;
+
+        taskFn (taskContext, task, self);
+        finished.fetch_add (1, std::memory_order_release);
+    }
+}
+
+bool WorkerPool::pop (int32_t self, int32_t& task)
+{
+    std::atomic<uint64_t>& range = ranges[self].range;
+    uint64_t r = range.load (std::memory_order_acquire);
+    for (;;)
+    {
+        const uint32_t next = (uint32_t)r;
+        const uint32_t end = (uint32_t)(r >> 32);
+        if (next >= end)
+            return false;
+        if (range.compare_exchange_weak (r, pack (next + 1, end), std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+        {
+            task = (int32_t)next;
+            return true;
+        }
+    }
+}
+
+bool WorkerPool::steal (int32_t self, int32_t& task)
+{
+    for (int32_t i = 1; i < numWorkers; i++)
+    {
+        std::atomic<uint64_t>& range = ranges[(self + i) % numWorkers].range;
+        uint64_t r = range.load (std::memory_order_acquire);
+        for (;;)
+        {
+            const uint32_t next = (uint32_t)r;
+            const uint32_t end = (uint32_t)(r >> 32);
+            if (next >= end)
+                break;
+            if (range.compare_exchange_weak (r, pack (next, end - 1), std::memory_order_acq_rel,
+                                             std::memory_order_acquire))
+            {
+                task = (int32_t)(end - 1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void WorkerPool::helperMain (int32_t self)
+{
+    WINESYNTH_RT_SCOPE;
+    uint32_t seen = generation.load (std::memory_order_acquire);
+    int64_t applied = kUnknownScheduling;
+    bool eligible = true;
+    while (!stopping.load (std::memory_order_acquire))
+    {
+        const int64_t wanted = callerScheduling.load (std::memory_order_relaxed);
+        if (wanted != applied && wanted != kUnknownScheduling)
+        {
+            eligible = setThreadScheduling (wanted) || !isRealtimeScheduling (wanted);
+            applied = wanted;
+        }
+        if (eligible)
+            work (self);
+
+        int32_t spin = 0;
+        while (spin < kSpinCount && generation.load (std::memory_order_acquire) == seen
+               && !stopping.load (std::memory_order_relaxed))
+        {
+            cpuPause ();
+            spin++;
+        }
+        if (spin == kSpinCount)
+        {
+            // A run () that starts before this increment is visible finds
+            // the ranges taken care of by the others; this helper then
+            // sleeps until the next run () counts it and posts
+            sleeping.fetch_add (1, std::memory_order_seq_cst);
+            wakeup.wait ();
+        }
+        seen = generation.load (std::memory_order_acquire);
+    }
+}
+
+} // namespace WineSynth
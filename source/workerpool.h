@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace WineSynth {
+
+//------------------------------------------------------------------------
+// WorkerPool — helper threads for one processor's voice rendering
+//
+// run (numTasks, fn) calls fn (task, worker) once for every task index and
+// returns when all have finished. The calling thread is worker 0 and works
+// along; helpers are workers 1 .. getNumWorkers () - 1. Tasks are split
+// into one contiguous range per worker. A worker takes tasks from the front
+// of its own range and, once that is empty, steals from the back of the
+// others'. Claims are single CAS operations on a packed (next, end) pair,
+// so neither side ever locks, and a helper that is asleep or descheduled
+// only means the others (in the end the caller) take over its range. The
+// join spins on a counter of finished tasks.
+//
+// A task already claimed cannot be taken back, so the join would wait on
+// a helper the caller itself keeps off the CPU. The first run () after
+// start () publishes the caller's scheduling class and priority, and the
+// helpers adopt it before they take tasks. A helper the system refuses a
+// realtime class stops taking tasks; its range is then rendered by the
+// others.
+//
+// Between runs helpers spin for a short while (sub-blocks follow each other
+// closely within a host block), then sleep on a semaphore that run () posts
+// only when someone is actually asleep.
+//
+// start () / stop () create and join the threads: not realtime safe, called
+// from setActive. run () is realtime safe and must only be called by one
+// thread at a time.
+//------------------------------------------------------------------------
+class WorkerPool
+{
+public:
+    static constexpr int32_t kMaxWorkers = 16;
+
+    WorkerPool () = default;
+    ~WorkerPool () { stop (); }
+
+    WorkerPool (const WorkerPool&) = delete;
+    WorkerPool& operator= (const WorkerPool&) = delete;
+
+    // numWorkers includes the calling thread; 1 or less runs everything inline
+    void start (int32_t numWorkers);
+    void stop ();
+
+    int32_t getNumWorkers () const { return numWorkers; }
+
+    template <typename Fn>
+    void run (int32_t numTasks, Fn& fn)
+    {
+        runTasks (numTasks, [] (void* context, int32_t task, int32_t worker) {
+            (*static_cast<Fn*> (context)) (task, worker);
+        }, &fn);
+    }
+
+private:
+    using TaskFn = void (*) (void* context, int32_t task, int32_t worker);
+
+    // Remaining tasks of one worker: next in the low, end in the high half
+    struct alignas (64) TaskRange
+    {
+        std::atomic<uint64_t> range {0};
+    };
+
+    static uint64_t pack (uint32_t next, uint32_t end) { return (uint64_t)end << 32 | next; }
+
+    void runTasks (int32_t numTasks, TaskFn fn, void* context);
+    void work (int32_t self);
+    bool pop (int32_t self, int32_t& task);
+    bool steal (int32_t self, int32_t& task);
+    void helperMain (int32_t self);
+
+    static constexpr int64_t kUnknownScheduling = -1;
+
+    class Semaphore
+    {
+    public:
+        Semaphore ();
+        ~Semaphore ();
+        void post (int32_t count);
+        void wait ();
+        void drain ();              // drops counts nobody waited for
+
+    private:
+        void* handle = nullptr;
+    };
+
+    int32_t numWorkers = 1;
+    std::thread helpers[kMaxWorkers];
+    Semaphore wakeup;
+
+    // Current job, written by run () before the ranges are published
+    TaskFn taskFn = nullptr;
+    void* taskContext = nullptr;
+    uint32_t fpMode = 0;        // caller's MXCSR, taken over by the helpers
+    bool schedulingPublished = false;
+
+    TaskRange ranges[kMaxWorkers];
+    alignas (64) std::atomic<int32_t> finished {0};
+    alignas (64) std::atomic<uint32_t> generation {0};
+    std::atomic<int32_t> sleeping {0};
+    std::atomic<int64_t> callerScheduling {kUnknownScheduling};   // see getThreadScheduling ()
+    std::atomic<bool> stopping {false};
+};
+
+} // namespace WineSynth
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "params.h"
+#include "processor.h"
+
+#include "base/source/fstreamer.h"
+#include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "public.sdk/source/common/memorystream.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace WineSynth {
+namespace Testing {
+
+//------------------------------------------------------------------------
+// Minimal host-side lists handed to Processor::process (): one block's
+// events and parameter points. Not reference counted; they live on the
+// OfflineHost.
+//------------------------------------------------------------------------
+class EventList : public Steinberg::Vst::IEventList
+{
+public:
+    std::vector<Steinberg::Vst::Event> events;
+
+    Steinberg::int32 PLUGIN_API getEventCount () SMTG_OVERRIDE { return (Steinberg::int32)events.size (); }
+
+    Steinberg::tresult PLUGIN_API getEvent (Steinberg::int32 index, Steinberg::Vst::Event& e) SMTG_OVERRIDE
+    {
+        if (index < 0 || index >= getEventCount ())
+            return Steinberg::kInvalidArgument;
+        e = events[index];
+        return Steinberg::kResultOk;
+    }
+
+    Steinberg::tresult PLUGIN_API addEvent (Steinberg::Vst::Event&) SMTG_OVERRIDE { return Steinberg::kResultFalse; }
+
+    Steinberg::tresult PLUGIN_API queryInterface (const Steinberg::TUID, void** obj) SMTG_OVERRIDE
+    {
+        *obj = nullptr;
+        return Steinberg::kNoInterface;
+    }
+    Steinberg::uint32 PLUGIN_API addRef () SMTG_OVERRIDE { return 1; }
+    Steinberg::uint32 PLUGIN_API release () SMTG_OVERRIDE { return 1; }
+};
+
+class ParamValueQueue : public Steinberg::Vst::IParamValueQueue
+{
+public:
+    Steinberg::Vst::ParamID id = 0;
+    std::vector<std::pair<Steinberg::int32, Steinberg::Vst::ParamValue>> points;   // (sample offset, value), in order
+
+    Steinberg::Vst::ParamID PLUGIN_API getParameterId () SMTG_OVERRIDE { return id; }
+    Steinberg::int32 PLUGIN_API getPointCount () SMTG_OVERRIDE { return (Steinberg::int32)points.size (); }
+
+    Steinberg::tresult PLUGIN_API getPoint (Steinberg::int32 index, Steinberg::int32& sampleOffset,
+                                            Steinberg::Vst::ParamValue& v) SMTG_OVERRIDE
+    {
+        if (index < 0 || index >= getPointCount ())
+            return Steinberg::kInvalidArgument;
+        sampleOffset = points[index].first;
+        v = points[index].second;
+        return Steinberg::kResultTrue;
+    }
+
+    Steinberg::tresult PLUGIN_API addPoint (Steinberg::int32, Steinberg::Vst::ParamValue, Steinberg::int32&) SMTG_OVERRIDE
+    {
+        return Steinberg::kResultFalse;
+    }
+
+    Steinberg::tresult PLUGIN_API queryInterface (const Steinberg::TUID, void** obj) SMTG_OVERRIDE
+    {
+        *obj = nullptr;
+        return Steinberg::kNoInterface;
+    }
+    Steinberg::uint32 PLUGIN_API addRef () SMTG_OVERRIDE { return 1; }
+    Steinberg::uint32 PLUGIN_API release () SMTG_OVERRIDE { return 1; }
+};
+
+class ParameterChanges : public Steinberg::Vst::IParameterChanges
+{
+public:
+    std::vector<ParamValueQueue> queues;
+
+    Steinberg::int32 PLUGIN_API getParameterCount () SMTG_OVERRIDE { return (Steinberg::int32)queues.size (); }
+
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API getParameterData (Steinberg::int32 index) SMTG_OVERRIDE
+    {
+        return (index >= 0 && index < getParameterCount ()) ? &queues[index] : nullptr;
+    }
+
+    Steinberg::Vst::IParamValueQueue* PLUGIN_API addParameterData (const Steinberg::Vst::ParamID&,
+                                                                   Steinberg::int32& index) SMTG_OVERRIDE
+    {
+        index = -1;
+        return nullptr;
+    }
+
+    Steinberg::tresult PLUGIN_API queryInterface (const Steinberg::TUID, void** obj) SMTG_OVERRIDE
+    {
+        *obj = nullptr;
+        return Steinberg::kNoInterface;
+    }
+    Steinberg::uint32 PLUGIN_API addRef () SMTG_OVERRIDE { return 1; }
+    Steinberg::uint32 PLUGIN_API release () SMTG_OVERRIDE { return 1; }
+};
+
+//------------------------------------------------------------------------
+// OfflineHost — drives one Processor through its lifecycle and
+// Processor::process () in fixed blocks, the way a host would, for the
+// regression tests and the benchmarks.
+//
+// setParam () values go out with the next block at offset 0. Automation
+// points (automate ()) and notes are scheduled by absolute frame and land
+// at their offset in whichever block holds it, several per block if need
+// be. setSampleRate () goes through setActive (false) and
+// setupProcessing () again, like a host switching rates between renders.
+// setInitialParam () values reach the processor through setState ()
+// before it is activated, the way a host restores a project; settings
+// that only take effect in setActive () (Render Threads) need that.
+//------------------------------------------------------------------------
+class OfflineHost
+{
+public:
+    OfflineHost (double sampleRate, Steinberg::int32 blockSize,
+                 Steinberg::int32 processMode = Steinberg::Vst::kOffline)
+        : blockSize (blockSize), blockL (blockSize), blockR (blockSize), processMode (processMode)
+    {
+        processor = Steinberg::owned (new Processor ());
+        processor->initialize (nullptr);
+        setup (sampleRate);
+    }
+
+    ~OfflineHost ()
+    {
+        if (active)
+            processor->setActive (false);
+        processor->terminate ();
+    }
+
+    OfflineHost (const OfflineHost&) = delete;
+    OfflineHost& operator= (const OfflineHost&) = delete;
+
+    Processor& getProcessor () { return *processor; }
+    Steinberg::int64 getFrame () const { return frame; }
+
+    void setParam (Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue normalized)
+    {
+        automate (frame, id, normalized);
+    }
+
+    void automate (Steinberg::int64 atFrame, Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue normalized)
+    {
+        const ParamPoint point {atFrame, id, normalized};
+        auto later = std::upper_bound (pendingPoints.begin (), pendingPoints.end (), point,
+                                       [] (const auto& a, const auto& b) { return a.frame < b.frame; });
+        pendingPoints.insert (later, point);
+    }
+
+    // Takes effect with the next render ()
+    void setSampleRate (double sampleRate)
+    {
+        if (active)
+        {
+            processor->setActive (false);
+            active = false;
+        }
+        setup (sampleRate);
+    }
+
+    // Only before the first render ()
+    void setInitialParam (Steinberg::Vst::ParamID id, Steinberg::Vst::ParamValue normalized)
+    {
+        initialParams.push_back ({id, normalized});
+    }
+
+    void noteOn (Steinberg::int64 atFrame, Steinberg::int16 pitch, float velocity = 1.f)
+    {
+        Steinberg::Vst::Event e {};
+        e.type = Steinberg::Vst::Event::kNoteOnEvent;
+        e.noteOn.pitch = pitch;
+        e.noteOn.velocity = velocity;
+        e.noteOn.noteId = -1;
+        schedule (atFrame, e);
+    }
+
+    void noteOff (Steinberg::int64 atFrame, Steinberg::int16 pitch)
+    {
+        Steinberg::Vst::Event e {};
+        e.type = Steinberg::Vst::Event::kNoteOffEvent;
+        e.noteOff.pitch = pitch;
+        e.noteOff.noteId = -1;
+        schedule (atFrame, e);
+    }
+
+    // Renders numFrames more frames and appends them to left / right
+    // (either may be null when the output is not needed)
+    void render (Steinberg::int64 numFrames, std::vector<float>* left, std::vector<float>* right)
+    {
+        if (!active)
+        {
+            if (!initialParams.empty ())
+                loadInitialState ();
+            initialParams.clear ();
+            processor->setActive (true);
+            active = true;
+        }
+
+        float* channels[2] = {blockL.data (), blockR.data ()};
+
+        for (Steinberg::int64 done = 0; done < numFrames;)
+        {
+            const Steinberg::int32 n = (Steinberg::int32)std::min<Steinberg::int64> (blockSize, numFrames - done);
+
+            blockEvents.events.clear ();
+            while (!pending.empty () && pending.front ().sampleOffset < frame + n)
+            {
+                Steinberg::Vst::Event e = pending.front ();
+                e.sampleOffset = (Steinberg::int32)std::max<Steinberg::int64> (0, e.sampleOffset - frame);
+                blockEvents.events.push_back (e);
+                pending.erase (pending.begin ());
+            }
+            changes.queues.clear ();
+            while (!pendingPoints.empty () && pendingPoints.front ().frame < frame + n)
+            {
+                const ParamPoint& p = pendingPoints.front ();
+                addPoint (p.id, (Steinberg::int32)std::max<Steinberg::int64> (0, p.frame - frame), p.normalized);
+                pendingPoints.erase (pendingPoints.begin ());
+            }
+
+            Steinberg::Vst::AudioBusBuffers output {};
+            output.numChannels = 2;
+            output.channelBuffers32 = channels;
+
+            Steinberg::Vst::ProcessData data {};
+            data.processMode = processMode;
+            data.symbolicSampleSize = Steinberg::Vst::kSample32;
+            data.numSamples = n;
+            data.numOutputs = 1;
+            data.outputs = &output;
+            data.inputEvents = &blockEvents;
+            data.inputParameterChanges = &changes;
+            processor->process (data);
+
+            if (left)
+                left->insert (left->end (), blockL.begin (), blockL.begin () + n);
+            if (right)
+                right->insert (right->end (), blockR.begin (), blockR.begin () + n);
+            frame += n;
+            done += n;
+        }
+    }
+
+private:
+    struct ParamPoint
+    {
+        Steinberg::int64 frame;
+        Steinberg::Vst::ParamID id;
+        Steinberg::Vst::ParamValue normalized;
+    };
+
+    void setup (double sampleRate)
+    {
+        Steinberg::Vst::ProcessSetup setup {};
+        setup.processMode = processMode;
+        setup.symbolicSampleSize = Steinberg::Vst::kSample32;
+        setup.maxSamplesPerBlock = blockSize;
+        setup.sampleRate = sampleRate;
+        processor->setupProcessing (setup);
+    }
+
+    // A later point at the same offset replaces the earlier one
+    void addPoint (Steinberg::Vst::ParamID id, Steinberg::int32 offset, Steinberg::Vst::ParamValue normalized)
+    {
+        auto q = std::find_if (changes.queues.begin (), changes.queues.end (),
+                               [id] (const ParamValueQueue& queue) { return queue.id == id; });
+        if (q == changes.queues.end ())
+        {
+            changes.queues.emplace_back ();
+            q = changes.queues.end () - 1;
+            q->id = id;
+        }
+        if (!q->points.empty () && q->points.back ().first == offset)
+            q->points.back ().second = normalized;
+        else
+            q->points.push_back ({offset, normalized});
+    }
+
+    void loadInitialState ()
+    {
+        Steinberg::MemoryStream stream;
+        Steinberg::IBStreamer streamer (&stream, Steinberg::kLittleEndian);
+        writeParamState (streamer, [this] (Steinberg::Vst::ParamID id) {
+            double value = kParamTable[id].defaultNormalized;
+            for (const auto& p : initialParams)
+                if (p.first == id)
+                    value = p.second;
+            return value;
+        });
+        stream.seek (0, Steinberg::IBStream::kIBSeekSet, nullptr);
+        processor->setState (&stream);
+    }
+
+    // Pending events keep their absolute frame in sampleOffset until sent
+    void schedule (Steinberg::int64 atFrame, Steinberg::Vst::Event e)
+    {
+        e.sampleOffset = (Steinberg::int32)atFrame;
+        auto later = std::upper_bound (pending.begin (), pending.end (), e,
+                                       [] (const auto& a, const auto& b) { return a.sampleOffset < b.sampleOffset; });
+        pending.insert (later, e);
+    }
+
+    Steinberg::IPtr<Processor> processor;
+    Steinberg::int32 blockSize;
+    std::vector<float> blockL, blockR;      // output of the current block
+    Steinberg::int32 processMode;
+    Steinberg::int64 frame = 0;
+    bool active = false;
+
+    std::vector<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>> initialParams;
+    std::vector<Steinberg::Vst::Event> pending;
+    std::vector<ParamPoint> pendingPoints;
+    EventList blockEvents;
+    ParameterChanges changes;
+};
+
+} // namespace Testing
+} // namespace WineSynth
@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------
+// Render regression tests
+//
+// Each scenario renders a short note through Processor::process () in
+// offline mode (the realtime path is steered by the CPU governor, so its
+// output depends on the machine), with its automation points at given
+// frames and optionally a sample rate switch on the same processor, and
+// compares it with a reference render
+// in tests/reference/<name>.f32: raw little-endian float32, stereo
+// interleaved. A scenario passes when no sample differs by more than its
+// tolerance and a longer render of the same patch stays inside its
+// wall-clock budget.
+//
+//   winesynth_render_tests <reference dir> [scenario ...]
+//   winesynth_render_tests <reference dir> --update [scenario ...]
+//
+// --update rewrites the references; do that only for an intended change
+// of the sound and say so in the commit. WINESYNTH_TEST_BUDGET_SCALE
+// multiplies every budget (debug or sanitizer builds).
+//------------------------------------------------------------------------
+
+#include "offlinehost.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr int32 kBlockSize = 128;
+constexpr int64 kReferenceFrames = 4096;
+constexpr int64 kNoteOffFrame = 2048;
+constexpr int16 kPitch = 60;
+constexpr int64 kRateSwitchFrame = 1024;
+constexpr double kBudgetSeconds = 2.0;     // audio rendered for the time budget
+
+struct ParamSetting
+{
+    ParamID id;
+    ParamValue normalized;
+};
+
+struct ParamPoint
+{
+    int64 frame;
+    ParamID id;
+    ParamValue normalized;
+};
+
+struct Scenario
+{
+    const char* name;
+    double sampleRate;
+    std::vector<ParamSetting> params;
+    float tolerance;            // largest allowed sample difference
+    double budget;              // wall-clock time per second of audio
+    std::vector<ParamPoint> automation = {};
+    double switchRate = 0.0;    // > 0: setupProcessing () again at kRateSwitchFrame, then a new note
+};
+
+// Saw through the filter at ~630 Hz, to make the resonance audible
+const std::vector<ParamSetting> kFilteredSaw = {{kWaveformId, 1.0 / 3.0}, {kCutoffId, 0.5}};
+
+// Points every step frames from first to last, value going from a to b.
+// Steps that do not divide the host block or the offline sub-block put
+// several points at odd offsets into one block.
+std::vector<ParamPoint> ramp (ParamID id, int64 first, int64 last, int64 step, double a, double b)
+{
+    std::vector<ParamPoint> points;
+    for (int64 f = first; f <= last; f += step)
+        points.push_back ({f, id, a + (b - a) * (double)(f - first) / (double)(last - first)});
+    return points;
+}
+
+std::vector<Scenario> makeScenarios ()
+{
+    auto with = [] (std::vector<ParamSetting> base, std::initializer_list<ParamSetting> more) {
+        base.insert (base.end (), more);
+        return base;
+    };
+
+    return {
+        {"wave_sine",      48000.0, {{kWaveformId, 0.0}},        1e-4f, 0.25},
+        {"wave_saw",       48000.0, {{kWaveformId, 1.0 / 3.0}},  1e-4f, 0.25},
+        {"wave_square",    48000.0, {{kWaveformId, 2.0 / 3.0}},  1e-4f, 0.25},
+        {"wave_triangle",  48000.0, {{kWaveformId, 1.0}},        1e-4f, 0.25},
+        {"osc_additive",   48000.0, {{kOscModeId, 1.0}},         2e-4f, 0.5},
+        {"resonance_min",  48000.0, with (kFilteredSaw, {{kResonanceId, 0.0}}), 1e-4f, 0.25},
+        {"resonance_max",  48000.0, with (kFilteredSaw, {{kResonanceId, 1.0}}), 1e-4f, 0.25},
+        // Shortest attack and release: the envelope edges are steepest
+        {"envelope_fast",  48000.0, {{kWaveformId, 1.0 / 3.0}, {kAttackId, 0.0}, {kReleaseId, 0.0}}, 1e-4f, 0.25},
+        // Note off at ~43 ms into a ~250 ms attack: release from mid-ramp
+        {"release_in_attack", 48000.0, {{kWaveformId, 1.0 / 3.0}, {kAttackId, 0.5}, {kReleaseId, 0.0}}, 1e-4f, 0.25},
+        {"bypass",         48000.0, {{kWaveformId, 1.0 / 3.0}, {kBypassId, 1.0}}, 0.f, 0.25},
+        {"rate_44k",       44100.0, {{kWaveformId, 1.0 / 3.0}},  1e-4f, 0.25},
+        {"rate_96k",       96000.0, {{kWaveformId, 1.0 / 3.0}},  1e-4f, 0.25},
+        // Sample-accurate automation: a resonant cutoff sweep with a point
+        // every 37 frames, and gain steps at offsets inside the blocks
+        {"cutoff_sweep",   48000.0, with (kFilteredSaw, {{kResonanceId, 0.7}}), 1e-4f, 0.25,
+         ramp (kCutoffId, 0, 2035, 37, 0.2, 0.9)},
+        {"gain_steps",     48000.0, {{kWaveformId, 1.0 / 3.0}},  1e-4f, 0.25,
+         {{300, kGainId, 0.2}, {700, kGainId, 0.8}, {701, kGainId, 0.4}, {1250, kGainId, 1.0}, {1613, kGainId, 0.1}}},
+        // Sustain moved while held: glides instead of stepping
+        {"sustain_moves",  48000.0, {{kWaveformId, 1.0 / 3.0}, {kDecayId, 0.1}, {kSustainId, 1.0}}, 1e-4f, 0.25,
+         {{900, kSustainId, 0.2}, {1500, kSustainId, 0.9}}},
+        // Same processor switched from 44.1 to 96 kHz between two notes
+        {"rate_switch",    44100.0, {{kWaveformId, 1.0 / 3.0}},  1e-4f, 0.25, {}, 96000.0},
+    };
+}
+
+// Interleaved stereo
+std::vector<float> renderScenario (const Scenario& s, int64 numFrames, int64 noteOffFrame)
+{
+    OfflineHost host (s.sampleRate, kBlockSize);
+    for (const auto& p : s.params)
+        host.setParam (p.id, p.normalized);
+    for (const auto& p : s.automation)
+        host.automate (p.frame, p.id, p.normalized);
+    host.noteOn (0, kPitch);
+    if (noteOffFrame < numFrames)
+        host.noteOff (noteOffFrame, kPitch);
+
+    std::vector<float> left, right;
+    if (s.switchRate > 0.0)
+    {
+        host.render (kRateSwitchFrame, &left, &right);
+        host.setSampleRate (s.switchRate);
+        host.noteOn (kRateSwitchFrame, kPitch + 7);
+        if (noteOffFrame < numFrames)
+            host.noteOff (noteOffFrame, kPitch + 7);
+        host.render (numFrames - kRateSwitchFrame, &left, &right);
+    }
+    else
+    {
+        host.render (numFrames, &left, &right);
+    }
+
+    std::vector<float> interleaved (2 * left.size ());
+    for (size_t i = 0; i < left.size (); i++)
+    {
+        interleaved[2 * i] = left[i];
+        interleaved[2 * i + 1] = right[i];
+    }
+    return interleaved;
+}
+
+bool readReference (const std::string& path, std::vector<float>& samples)
+{
+    FILE* f = fopen (path.c_str (), "rb");
+    if (!f)
+        return false;
+    samples.assign (2 * kReferenceFrames, 0.f);
+    const size_t read = fread (samples.data (), sizeof (float), samples.size (), f);
+    fclose (f);
+    return read == samples.size ();
+}
+
+bool writeReference (const std::string& path, const std::vector<float>& samples)
+{
+    FILE* f = fopen (path.c_str (), "wb");
+    if (!f)
+        return false;
+    const size_t written = fwrite (samples.data (), sizeof (float), samples.size (), f);
+    fclose (f);
+    return written == samples.size ();
+}
+
+bool runScenario (const Scenario& s, const std::string& referenceDir, bool update, double budgetScale)
+{
+    const std::string path = referenceDir + "/" + s.name + ".f32";
+    const std::vector<float> rendered = renderScenario (s, kReferenceFrames, kNoteOffFrame);
+
+    if (update)
+    {
+        if (!writeReference (path, rendered))
+        {
+            printf ("FAIL %-18s cannot write %s\n", s.name, path.c_str ());
+            return false;
+        }
+        printf ("     %-18s reference written\n", s.name);
+        return true;
+    }
+
+    std::vector<float> reference;
+    if (!readReference (path, reference))
+    {
+        printf ("FAIL %-18s missing or short reference %s (run with --update)\n", s.name, path.c_str ());
+        return false;
+    }
+
+    float maxDiff = 0.f;
+    size_t worst = 0;
+    for (size_t i = 0; i < rendered.size (); i++)
+    {
+        const float d = std::fabs (rendered[i] - reference[i]);
+        if (!(d <= maxDiff))    // also catches NaN
+        {
+            maxDiff = std::isnan (d) ? INFINITY : d;
+            worst = i;
+        }
+    }
+
+    // Time budget: a held note, long enough to measure
+    const int64 budgetFrames = (int64)(kBudgetSeconds * s.sampleRate);
+    const auto start = std::chrono::steady_clock::now ();
+    renderScenario (s, budgetFrames, budgetFrames);
+    const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    const double budget = s.budget * kBudgetSeconds * budgetScale;
+
+    const bool soundOk = maxDiff <= s.tolerance;
+    const bool timeOk = seconds <= budget;
+    printf ("%s %-18s max diff %.3g (frame %zu, tolerance %.3g), %.1f ms for %.0f s (budget %.1f ms)\n",
+            soundOk && timeOk ? "ok  " : "FAIL", s.name, maxDiff, worst / 2, s.tolerance, seconds * 1e3,
+            kBudgetSeconds, budget * 1e3);
+    return soundOk && timeOk;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s <reference dir> [--update] [scenario ...]\n", argv[0]);
+        return 2;
+    }
+
+    const std::string referenceDir = argv[1];
+    bool update = false;
+    std::vector<std::string> selected;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp (argv[i], "--update") == 0)
+            update = true;
+        else
+            selected.push_back (argv[i]);
+    }
+
+    double budgetScale = 1.0;
+    if (const char* scale = getenv ("WINESYNTH_TEST_BUDGET_SCALE"))
+        budgetScale = std::max (atof (scale), 0.0);
+
+    int failures = 0;
+    int run = 0;
+    for (const Scenario& s : makeScenarios ())
+    {
+        if (!selected.empty () && std::find (selected.begin (), selected.end (), s.name) == selected.end ())
+            continue;
+        run++;
+        if (!runScenario (s, referenceDir, update, budgetScale))
+            failures++;
+    }
+
+    if (run == 0)
+    {
+        fprintf (stderr, "no scenario matched\n");
+        return 2;
+    }
+    printf ("%d of %d scenarios failed\n", failures, run);
+    return failures ? 1 : 0;
+}
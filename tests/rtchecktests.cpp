@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------
+// Realtime-safety test
+//
+// Built against a copy of the processor compiled with
+// WINESYNTH_RT_CHECKS=1 and linked into this executable, so the checked
+// operator new / delete, malloc / free and pthread_mutex_lock replace the
+// library ones for everything on the audio thread, libstdc++ included.
+// Each scenario plays a dense patch through Processor::process (): notes
+// past the polyphony limit, every effect, render threads, and parameters
+// moved on every block. A violation aborts, which fails the test.
+//
+//   winesynth_rtcheck_tests               run all scenarios
+//   winesynth_rtcheck_tests --self-test   allocate inside a checked scope
+//                                         and pass only if the checker aborts
+//------------------------------------------------------------------------
+
+#include "offlinehost.h"
+#include "rtcheck.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#if !WINESYNTH_RT_CHECKS
+#error "rtchecktests.cpp needs the processor built with WINESYNTH_RT_CHECKS=1"
+#endif
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+using namespace WineSynth;
+using namespace WineSynth::Testing;
+
+namespace {
+
+constexpr int32 kBlockSize = 256;
+constexpr int kNumBlocks = 600;     // ~3 s at 48 kHz
+
+struct Scenario
+{
+    const char* name;
+    int32 processMode;
+    bool additive;
+};
+
+void setDensePatch (OfflineHost& host, bool additive)
+{
+    host.setParam (kOscModeId, additive ? 1.0 : 0.0);
+    host.setParam (kPolyphonyId, 15.0 / 63.0);      // 16 voices
+    host.setParam (kStealModeId, 0.0);
+    host.setParam (kUnisonVoicesId, 1.0);
+    host.setParam (kUnisonDetuneId, 0.5);
+    host.setParam (kOsc2LevelId, 0.7);
+    host.setParam (kFmDepthId, 0.3);
+    host.setParam (kDriveId, 0.5);
+    host.setParam (kChorusMixId, 0.5);
+    host.setParam (kDelayMixId, 0.4);
+    host.setParam (kDelayFeedbackId, 0.6);
+    host.setParam (kReverbMixId, 0.3);
+    host.setParam (kPartialsId, 1.0);
+    host.setInitialParam (kRenderThreadsId, 3.0 / 15.0);   // 4 threads
+    host.setParam (kAttackId, 0.05);
+    host.setParam (kReleaseId, 0.3);
+}
+
+void runScenario (const Scenario& s)
+{
+    OfflineHost host (48000.0, kBlockSize, s.processMode);
+    setDensePatch (host, s.additive);
+
+    for (int block = 0; block < kNumBlocks; block++)
+    {
+        const int64 frame = host.getFrame ();
+
+        // A new note every few blocks, released later; more notes than
+        // voices, so stealing and fades run as well
+        if (block % 3 == 0)
+        {
+            const int16 pitch = (int16)(36 + (block * 7) % 48);
+            host.noteOn (frame + (block * 37) % kBlockSize, pitch, 0.5f + 0.5f * (block % 5) / 4.f);
+            host.noteOff (frame + 40 * kBlockSize, pitch);
+        }
+
+        const double phase = (double)block / kNumBlocks;
+        host.setParam (kCutoffId, 0.2 + 0.7 * phase);
+        host.setParam (kResonanceId, phase);
+        host.setParam (kPitchBendId, 0.5 + 0.4 * (phase - 0.5));
+        if (block % 50 == 0)
+        {
+            host.setParam (kDelayTimeId, (block / 50 % 4) / 3.0);
+            host.setParam (kWaveformId, (block / 50 % 4) / 3.0);
+            host.setParam (kUnisonVoicesId, (block / 50 % 2) ? 1.0 : 0.4);
+        }
+        if (block == kNumBlocks / 2)
+            host.setParam (kBypassId, 1.0);
+        if (block == kNumBlocks / 2 + 20)
+            host.setParam (kBypassId, 0.0);
+
+        host.render (kBlockSize, nullptr, nullptr);
+    }
+    printf ("ok   %s\n", s.name);
+}
+
+// Proves the checker is active in this build: the violation's abort ()
+// is the passing outcome
+void checkerFired (int)
+{
+    fputs ("ok   self-test (violation reported)\n", stdout);
+    fflush (stdout);
+    _Exit (0);
+}
+
+int selfTest ()
+{
+    signal (SIGABRT, checkerFired);
+    WINESYNTH_RT_SCOPE;
+    std::unique_ptr<int> p (new int (1));
+    printf ("FAIL allocation inside a checked scope went unnoticed (%d)\n", *p);
+    return 1;
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+    if (argc > 1 && strcmp (argv[1], "--self-test") == 0)
+        return selfTest ();
+
+    const Scenario scenarios[] = {
+        {"realtime_classic", kRealtime, false},
+        {"realtime_additive", kRealtime, true},
+        {"offline_classic", kOffline, false},
+    };
+    for (const Scenario& s : scenarios)
+        runScenario (s);
+    return 0;
+}